@@ -0,0 +1,121 @@
+/*
+ * @brief This module implements the datatype Arena.
+ *
+ * Each allocation is preceded by a pointer to its block, so `arena_free()`
+ * finds the block without a lookup. Allocations larger than a block get a
+ * block of their own, which is retired at once.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include "arena.h"
+#include "safe_functions.h"
+
+#define ARENA_ALIGNMENT 8
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Creates a block.
+ *
+ * @param size The number of bytes the block can hand out.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the newly created block.
+*/
+static struct arena_block* create_block(size_t size, void* in_use_data) {
+    struct arena_block* block = safe_malloc(sizeof(struct arena_block) + size,
+                                            in_use_data);
+
+    atomic_init(&block->refs, 0);
+    block->allocations = 0;
+    block->used = 0;
+    block->size = size;
+
+    return block;
+}
+
+/*
+ * @brief Retires a block, it is freed once its allocations are freed.
+ *
+ * @param block A pointer to the block, may be NULL.
+*/
+static void retire_block(struct arena_block* block) {
+    if (block == NULL) {
+        return;
+    }
+
+    if (atomic_fetch_add_explicit(&block->refs, block->allocations,
+            memory_order_acq_rel) + block->allocations == 0) {
+        free(block);
+    }
+}
+
+/*
+ * @brief Hands out memory from a block.
+ *
+ * @param block A pointer to the block.
+ * @param size The number of bytes, including the block pointer.
+ * @return Returns a pointer to the memory after the block pointer.
+*/
+static void* take_from_block(struct arena_block* block, size_t size) {
+    struct arena_block** header = (struct arena_block**) &block->data[block->used];
+
+    *header = block;
+    block->used += size;
+    block->allocations++;
+
+    return header + 1;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Arena* arena_create(void* in_use_data) {
+    Arena* arena = safe_malloc(sizeof(Arena), in_use_data);
+
+    arena->block = create_block(ARENA_BLOCK_SIZE, in_use_data);
+
+    return arena;
+}
+
+
+void arena_destroy(Arena* arena) {
+    retire_block(arena->block);
+    free(arena);
+}
+
+
+void* arena_alloc(Arena* arena, size_t size, void* in_use_data) {
+    size = sizeof(struct arena_block*) +
+            (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+
+    if (size > ARENA_BLOCK_SIZE) {
+        struct arena_block* block = create_block(size, in_use_data);
+        void* ptr = take_from_block(block, size);
+
+        retire_block(block);
+
+        return ptr;
+    }
+
+    if (arena->block->used + size > arena->block->size) {
+        retire_block(arena->block);
+        arena->block = create_block(ARENA_BLOCK_SIZE, in_use_data);
+    }
+
+    return take_from_block(arena->block, size);
+}
+
+
+void arena_free(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    struct arena_block* block = ((struct arena_block**) ptr)[-1];
+
+    if (atomic_fetch_sub_explicit(&block->refs, 1, memory_order_acq_rel) == 1) {
+        free(block);
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * @defgroup module_arena Arena
+ *
+ * @file arena.h
+ * @brief This module implements the datatype Arena.
+ *
+ * An arena is a bump allocator owned by one thread. Memory is handed out
+ * from large blocks, so an allocation is a pointer increment instead of a
+ * call to `malloc`. An allocation may be freed by any thread. Each block
+ * counts its live allocations and is returned to the system when the last
+ * of them is freed and the owner has moved on to a new block.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdlib.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+/**
+ * @brief A block of memory handed out by an arena.
+ *
+ * `refs` is the number of live allocations after the block is retired by
+ * its owner. While the block is in use it is zero or negative, the owner
+ * counts the allocations in `allocations` and adds them when the block is
+ * retired.
+*/
+struct arena_block {
+    atomic_long refs;
+    long allocations;
+    size_t used;
+    size_t size;
+    alignas(16) char data[];
+};
+
+/**
+ * @brief The type for the arena.
+*/
+typedef struct {
+    struct arena_block* block;
+} Arena;
+
+/**
+ * @brief Create and return an empty arena.
+ *
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the newly created arena.
+ *
+ * @note It is the caller's responsible to deallocate the arena after use
+ * by calling the function `arena_destroy()`.
+ * @see arena_destroy()
+*/
+Arena* arena_create(void* in_use_data);
+
+/**
+ * @brief Destroy the arena.
+ *
+ * @param arena A pointer to the arena.
+ *
+ * @note Memory still allocated from the arena stays valid until it is
+ * freed with `arena_free()`.
+*/
+void arena_destroy(Arena* arena);
+
+/**
+ * @brief Allocates memory from the arena.
+ *
+ * May only be called by the owner of the arena.
+ *
+ * @param arena A pointer to the arena.
+ * @param size The number of bytes to allocate.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns a pointer to the memory, aligned to 8 bytes.
+ *
+ * @note The memory must be freed using the `arena_free` function.
+ * @see arena_free()
+*/
+void* arena_alloc(Arena* arena, size_t size, void* in_use_data);
+
+/**
+ * @brief Frees memory allocated from an arena.
+ *
+ * May be called by any thread.
+ *
+ * @param ptr A pointer returned by `arena_alloc()`, may be NULL.
+*/
+void arena_free(void* ptr);
+
+#endif /* ARENA_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,797 @@
+/*
+ * @brief A benchmark driver for mdu.
+ *
+ * The driver generates synthetic directory trees of a few shapes and runs
+ * mdu on each of them with every combination of the given engines and
+ * thread counts. The wall time and the peak RSS of every run are measured,
+ * the directory latency is read from the stats that mdu prints with
+ * `--stats=json`. One row of results is printed as CSV or JSON for each
+ * combination.
+ *
+ * The trees are generated once under the root directory and reused by
+ * later runs, a tree is only complete when its info file exists. With
+ * `--drop-caches`, the page cache is dropped before each cold run, which
+ * requires root. With `--baseline=PATH` every run of mdu is followed by a
+ * run of the baseline binary, and each row also holds the throughput of
+ * the baseline and the change from it in percent.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#define USAGE "mdu_bench [--mdu=PATH] [--baseline=PATH] [--root=DIR] " \
+                "[--scale=N] [--runs=N] " \
+                "[--shapes=flat,deep,balanced,hardlinks] " \
+                "[--engines=sync,batch,uring] [--jobs=N,...] " \
+                "[--drop-caches] [--format=csv|json] [--generate-only]\n"
+
+#define MAX_LIST 16
+#define BALANCED_FANOUT 8
+#define BALANCED_DEPTH 4
+#define HARDLINK_DIRS 20
+
+/*
+ * @brief The number of entry's in a generated tree, the root not included.
+*/
+struct tree_size {
+    long files;
+    long directories;
+};
+
+/*
+ * @brief A shape of tree and the function generating it in `dir_fd`.
+*/
+struct shape {
+    const char* name;
+    void (*generate)(int dir_fd, long scale, struct tree_size* size);
+};
+
+/*
+ * @brief The options of the driver.
+*/
+struct bench_options {
+    const char* mdu;
+    const char* baseline;
+    const char* root;
+    long scale;
+    int runs;
+    bool drop_caches;
+    bool json;
+    bool generate_only;
+
+    const char* shapes[MAX_LIST];
+    int shape_num;
+    const char* engines[MAX_LIST];
+    int engine_num;
+    const char* jobs[MAX_LIST];
+    int job_num;
+};
+
+/*
+ * @brief The measurements of one run.
+*/
+struct bench_run {
+    double seconds;
+    double latency_p50;
+    double latency_p99;
+    long peak_rss;
+};
+
+/*
+ * @brief The measurements of the runs of one combination.
+*/
+struct bench_result {
+    double seconds[64];
+    double latency_p50[64];
+    double latency_p99[64];
+    int runs;
+    long peak_rss;
+};
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Prints `what` and the error of `errno` to stderr and exits.
+ *
+ * @param what String describing what failed.
+*/
+static void fail(const char* what) {
+    fprintf(stderr, "mdu_bench: %s: %s\n", what, strerror(errno));
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * @brief Creates a directory in `dir_fd` and opens it.
+ *
+ * @param dir_fd File descriptor of the parent directory.
+ * @param name String of the directory name.
+ * @return Returns the file descriptor of the new directory.
+*/
+static int make_directory(int dir_fd, const char* name) {
+    if (mkdirat(dir_fd, name, 0755) == -1 && errno != EEXIST) {
+        fail(name);
+    }
+
+    int fd = openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (fd == -1) {
+        fail(name);
+    }
+
+    return fd;
+}
+
+/*
+ * @brief Creates `count` files named `f0`, `f1`, ... in `dir_fd`.
+ *
+ * Every eighth file gets one block of data, so the usages are not all zero.
+ *
+ * @param dir_fd File descriptor of the directory.
+ * @param count The number of files.
+ * @param size The size of the tree, updated with the new files.
+*/
+static void make_files(int dir_fd, long count, struct tree_size* size) {
+    char name[32];
+
+    for (long i = 0 ; i < count ; i++) {
+        snprintf(name, sizeof(name), "f%ld", i);
+        int fd = openat(dir_fd, name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                        0644);
+
+        if (fd == -1) {
+            fail(name);
+        }
+
+        if (i % 8 == 0 && write(fd, "x", 1) != 1) {
+            fail(name);
+        }
+
+        close(fd);
+    }
+
+    size->files += count;
+}
+
+/*
+ * @brief Generates one directory holding `1000 * scale` files.
+*/
+static void generate_flat(int dir_fd, long scale, struct tree_size* size) {
+    make_files(dir_fd, 1000 * scale, size);
+}
+
+/*
+ * @brief Generates a chain of `20 * scale` directory's with four files each.
+*/
+static void generate_deep(int dir_fd, long scale, struct tree_size* size) {
+    int fd = dup(dir_fd);
+
+    for (long depth = 0 ; depth < 20 * scale ; depth++) {
+        int child = make_directory(fd, "d");
+
+        make_files(fd, 4, size);
+        size->directories++;
+        close(fd);
+        fd = child;
+    }
+
+    close(fd);
+}
+
+/*
+ * @brief Generates a level of the balanced tree in `dir_fd`.
+ *
+ * @param dir_fd File descriptor of the directory.
+ * @param depth The number of levels left below the directory.
+ * @param files The number of files in each directory.
+ * @param size The size of the tree.
+*/
+static void generate_level(int dir_fd, int depth, long files,
+                            struct tree_size* size) {
+    char name[32];
+
+    make_files(dir_fd, files, size);
+
+    if (depth == 0) {
+        return;
+    }
+
+    for (int i = 0 ; i < BALANCED_FANOUT ; i++) {
+        snprintf(name, sizeof(name), "d%d", i);
+        int fd = make_directory(dir_fd, name);
+
+        size->directories++;
+        generate_level(fd, depth - 1, files, size);
+        close(fd);
+    }
+}
+
+/*
+ * @brief Generates a tree with a fanout of eight, four levels deep and
+ * `scale / 5` files in each directory.
+*/
+static void generate_balanced(int dir_fd, long scale, struct tree_size* size) {
+    long files = scale / 5 > 0 ? scale / 5 : 1;
+
+    generate_level(dir_fd, BALANCED_DEPTH, files, size);
+}
+
+/*
+ * @brief Generates `10 * scale` files with a hard link to each of them in
+ * twenty other directory's.
+*/
+static void generate_hardlinks(int dir_fd, long scale, struct tree_size* size) {
+    char name[32];
+    long count = 10 * scale;
+    int source = make_directory(dir_fd, "source");
+
+    size->directories++;
+    make_files(source, count, size);
+
+    for (int i = 0 ; i < HARDLINK_DIRS ; i++) {
+        snprintf(name, sizeof(name), "links%d", i);
+        int fd = make_directory(dir_fd, name);
+
+        size->directories++;
+
+        for (long j = 0 ; j < count ; j++) {
+            snprintf(name, sizeof(name), "f%ld", j);
+
+            if (linkat(source, name, fd, name, 0) == -1 && errno != EEXIST) {
+                fail(name);
+            }
+        }
+
+        size->files += count;
+        close(fd);
+    }
+
+    close(source);
+}
+
+static const struct shape shapes[] = {
+    {"flat", generate_flat},
+    {"deep", generate_deep},
+    {"balanced", generate_balanced},
+    {"hardlinks", generate_hardlinks}
+};
+
+/*
+ * @brief Returns the shape named `name`, or exits if there is none.
+ *
+ * @param name String of the shape name.
+ * @return Returns the shape.
+*/
+static const struct shape* find_shape(const char* name) {
+    for (size_t i = 0 ; i < sizeof(shapes) / sizeof(shapes[0]) ; i++) {
+        if (strcmp(shapes[i].name, name) == 0) {
+            return &shapes[i];
+        }
+    }
+
+    fprintf(stderr, "mdu_bench: unknown shape '%s'\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * @brief Generates the tree of a shape unless it is already generated.
+ *
+ * The size of the tree is kept in the file `<shape>.info` of the root.
+ *
+ * @param options Pointer to the options.
+ * @param shape The shape to generate.
+ * @param path Set to the path of the tree, at least PATH_MAX bytes.
+ * @param size Set to the size of the tree.
+*/
+static void prepare_tree(const struct bench_options* options,
+                            const struct shape* shape, char* path,
+                            struct tree_size* size) {
+    char info_path[4096];
+    FILE* info;
+
+    snprintf(path, 4096, "%s/%s-%ld", options->root, shape->name,
+                options->scale);
+    snprintf(info_path, sizeof(info_path), "%s.info", path);
+
+    if ((info = fopen(info_path, "r")) != NULL) {
+        int fields = fscanf(info, "%ld %ld", &size->files, &size->directories);
+
+        fclose(info);
+
+        if (fields == 2) {
+            return;
+        }
+    }
+
+    fprintf(stderr, "mdu_bench: generating %s\n", path);
+
+    int root = make_directory(AT_FDCWD, options->root);
+    int fd = make_directory(root, strrchr(path, '/') + 1);
+
+    size->files = 0;
+    size->directories = 0;
+    shape->generate(fd, options->scale, size);
+
+    close(fd);
+    close(root);
+
+    if ((info = fopen(info_path, "w")) == NULL) {
+        fail(info_path);
+    }
+
+    fprintf(info, "%ld %ld\n", size->files, size->directories);
+    fclose(info);
+}
+
+/*
+ * @brief Drops the page cache, the dentry's and the inodes of the kernel.
+ *
+ * @return Returns true on success; else false.
+*/
+static bool drop_caches(void) {
+    sync();
+
+    int fd = open("/proc/sys/vm/drop_caches", O_WRONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    bool dropped = write(fd, "3", 1) == 1;
+    close(fd);
+
+    return dropped;
+}
+
+/*
+ * @brief Returns the current time in seconds.
+*/
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/*
+ * @brief Reads the directory latency from the stats printed by mdu.
+ *
+ * @param fd The read end of the pipe connected to stderr of mdu.
+ * @param run The run, its latency is set.
+*/
+static void read_stats(int fd, struct bench_run* run) {
+    static char output[1 << 16];
+    size_t length = 0;
+    ssize_t count;
+
+    while ((count = read(fd, &output[length], sizeof(output) - 1 - length)) > 0) {
+        length += count;
+
+        if (length == sizeof(output) - 1) {
+            length = 0;
+        }
+    }
+
+    output[length] = '\0';
+    run->latency_p50 = 0;
+    run->latency_p99 = 0;
+
+    const char* p50 = strstr(output, "\"latency_p50_us\": ");
+    const char* p99 = strstr(output, "\"latency_p99_us\": ");
+
+    if (p50 != NULL && p99 != NULL) {
+        sscanf(strchr(p50, ':') + 1, "%lf", &run->latency_p50);
+        sscanf(strchr(p99, ':') + 1, "%lf", &run->latency_p99);
+    }
+}
+
+/*
+ * @brief Runs mdu once on a tree.
+ *
+ * The output of mdu is discarded.
+ *
+ * @param mdu String of the path of the mdu binary.
+ * @param engine String of the engine name.
+ * @param jobs String of the `-j` argument.
+ * @param path The path of the tree.
+ * @param run Set to the measurements of the run.
+*/
+static void run_mdu(const char* mdu, const char* engine, const char* jobs,
+                    const char* path, struct bench_run* run) {
+    char engine_arg[64];
+    snprintf(engine_arg, sizeof(engine_arg), "--engine=%s", engine);
+
+    char* argv[] = {
+        (char*) mdu, "-j", (char*) jobs, engine_arg, "--stats=json",
+        (char*) path, NULL
+    };
+
+    int stats_pipe[2];
+
+    if (pipe(stats_pipe) == -1) {
+        fail("pipe");
+    }
+
+    double start = now();
+    pid_t pid = fork();
+
+    if (pid == -1) {
+        fail("fork");
+    }
+
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+
+        if (null != -1) {
+            dup2(null, STDOUT_FILENO);
+        }
+
+        dup2(stats_pipe[1], STDERR_FILENO);
+        close(stats_pipe[0]);
+        close(stats_pipe[1]);
+
+        execv(mdu, argv);
+        fail(mdu);
+    }
+
+    close(stats_pipe[1]);
+    read_stats(stats_pipe[0], run);
+    close(stats_pipe[0]);
+
+    int status;
+    struct rusage usage;
+
+    if (wait4(pid, &status, 0, &usage) == -1) {
+        fail("wait4");
+    }
+
+    run->seconds = now() - start;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "mdu_bench: %s failed on %s\n", mdu, path);
+        exit(EXIT_FAILURE);
+    }
+
+    run->peak_rss = usage.ru_maxrss;
+}
+
+/*
+ * @brief Compares two measurements, used by `qsort`.
+*/
+static int compare_seconds(const void* a, const void* b) {
+    double x = *(const double*) a;
+    double y = *(const double*) b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * @brief Returns the `percent` percentile of sorted measurements, using the
+ * nearest rank.
+*/
+static double percentile(const double* values, int count, int percent) {
+    int rank = (count * percent + 99) / 100;
+
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+/*
+ * @brief Prints one row of results.
+ *
+ * With the sync engine every entry is stat'ed, the batched engines only
+ * stat the entry's that are not directory's.
+ *
+ * @param options Pointer to the options.
+ * @param shape String of the shape name.
+ * @param engine String of the engine name.
+ * @param jobs String of the `-j` argument.
+ * @param cold If the page cache was dropped before each run.
+ * @param size The size of the tree.
+ * @param result The sorted measurements of the runs.
+ * @param baseline The sorted measurements of the baseline or NULL.
+*/
+static void print_result(const struct bench_options* options, const char* shape,
+                            const char* engine, const char* jobs, bool cold,
+                            const struct tree_size* size,
+                            const struct bench_result* result,
+                            const struct bench_result* baseline) {
+    long entries = size->files + size->directories;
+    long stats = strcmp(engine, "sync") == 0 ? entries : size->files;
+    int runs = result->runs;
+    double median = percentile(result->seconds, runs, 50);
+    double latency_p50 = percentile(result->latency_p50, runs, 50);
+    double latency_p99 = percentile(result->latency_p99, runs, 50);
+    double baseline_median = baseline != NULL ?
+                                percentile(baseline->seconds, runs, 50) : 0;
+
+    if (options->json) {
+        printf("{\"shape\": \"%s\", \"engine\": \"%s\", \"jobs\": %s, "
+                "\"cache\": \"%s\", \"runs\": %d, \"entries\": %ld, "
+                "\"seconds\": %.6f, \"entries_per_sec\": %.0f, "
+                "\"stats_per_sec\": %.0f, \"dir_p50_us\": %.1f, "
+                "\"dir_p99_us\": %.1f, \"run_p99_ms\": %.3f, "
+                "\"peak_rss_kb\": %ld",
+                shape, engine, jobs, cold ? "cold" : "warm", runs, entries,
+                median, entries / median, stats / median, latency_p50,
+                latency_p99, percentile(result->seconds, runs, 99) * 1000,
+                result->peak_rss);
+
+        if (baseline != NULL) {
+            printf(", \"baseline_entries_per_sec\": %.0f, \"delta_pct\": %.1f",
+                    entries / baseline_median,
+                    (baseline_median / median - 1) * 100);
+        }
+
+        printf("}\n");
+        return;
+    }
+
+    printf("%s,%s,%s,%s,%d,%ld,%.6f,%.0f,%.0f,%.1f,%.1f,%.3f,%ld", shape,
+            engine, jobs, cold ? "cold" : "warm", runs, entries, median,
+            entries / median, stats / median, latency_p50, latency_p99,
+            percentile(result->seconds, runs, 99) * 1000, result->peak_rss);
+
+    if (baseline != NULL) {
+        printf(",%.0f,%.1f", entries / baseline_median,
+                (baseline_median / median - 1) * 100);
+    }
+
+    printf("\n");
+}
+
+/*
+ * @brief Adds the measurements of a run to the result of a combination.
+ *
+ * @param result The result.
+ * @param index The index of the run.
+ * @param run The measurements of the run.
+*/
+static void add_run(struct bench_result* result, int index,
+                    const struct bench_run* run) {
+    result->seconds[index] = run->seconds;
+    result->latency_p50[index] = run->latency_p50;
+    result->latency_p99[index] = run->latency_p99;
+
+    if (run->peak_rss > result->peak_rss) {
+        result->peak_rss = run->peak_rss;
+    }
+}
+
+/*
+ * @brief Sorts the measurements of the result of a combination.
+ *
+ * @param result The result.
+*/
+static void sort_result(struct bench_result* result) {
+    qsort(result->seconds, result->runs, sizeof(double), compare_seconds);
+    qsort(result->latency_p50, result->runs, sizeof(double), compare_seconds);
+    qsort(result->latency_p99, result->runs, sizeof(double), compare_seconds);
+}
+
+/*
+ * @brief Runs and prints one combination of tree, engine and thread count.
+ *
+ * A warm combination is run once before it is measured. The directory
+ * latency reported is the median over the runs of the percentiles printed
+ * by mdu. The runs of the baseline alternate with the runs of mdu, so a
+ * drift of the machine affects both alike.
+*/
+static void run_combination(const struct bench_options* options,
+                            const char* shape, const char* path,
+                            const struct tree_size* size, const char* engine,
+                            const char* jobs, bool cold) {
+    struct bench_result result = {.runs = options->runs, .peak_rss = 0};
+    struct bench_result baseline = {.runs = options->runs, .peak_rss = 0};
+    struct bench_run run;
+
+    if (!cold) {
+        run_mdu(options->mdu, engine, jobs, path, &run);
+    }
+
+    if (!cold && options->baseline != NULL) {
+        run_mdu(options->baseline, engine, jobs, path, &run);
+    }
+
+    for (int i = 0 ; i < options->runs ; i++) {
+        if (cold && !drop_caches()) {
+            fail("cannot drop caches");
+        }
+
+        run_mdu(options->mdu, engine, jobs, path, &run);
+        add_run(&result, i, &run);
+
+        if (options->baseline == NULL) {
+            continue;
+        }
+
+        if (cold && !drop_caches()) {
+            fail("cannot drop caches");
+        }
+
+        run_mdu(options->baseline, engine, jobs, path, &run);
+        add_run(&baseline, i, &run);
+    }
+
+    sort_result(&result);
+    sort_result(&baseline);
+    print_result(options, shape, engine, jobs, cold, size, &result,
+                    options->baseline != NULL ? &baseline : NULL);
+    fflush(stdout);
+}
+
+/*
+ * @brief Splits a comma separated list in place.
+ *
+ * @param arg The list, it is modified.
+ * @param values Set to the values of the list.
+ * @return Returns the number of values.
+*/
+static int split_list(char* arg, const char** values) {
+    int count = 0;
+
+    for (char* value = strtok(arg, ",") ; value != NULL ;
+            value = strtok(NULL, ",")) {
+        if (count == MAX_LIST) {
+            fprintf(stderr, "mdu_bench: at most %d values in a list\n", MAX_LIST);
+            exit(EXIT_FAILURE);
+        }
+
+        values[count++] = value;
+    }
+
+    return count;
+}
+
+/*
+ * @brief Returns the positive number given by `arg`, or exits.
+*/
+static long get_number(const char* arg, long max) {
+    char* end;
+    long number = strtol(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || number < 1 || number > max) {
+        fprintf(stderr, "mdu_bench: invalid number '%s'\n", arg);
+        fprintf(stderr, USAGE);
+        exit(EXIT_FAILURE);
+    }
+
+    return number;
+}
+
+/*
+ * @brief Parses the command line options of the driver.
+*/
+static void parse_bench_options(int argc, char* argv[],
+                                struct bench_options* options) {
+    static const struct option long_options[] = {
+        {"mdu", required_argument, NULL, 'm'},
+        {"baseline", required_argument, NULL, 'b'},
+        {"root", required_argument, NULL, 'r'},
+        {"scale", required_argument, NULL, 's'},
+        {"runs", required_argument, NULL, 'n'},
+        {"shapes", required_argument, NULL, 'S'},
+        {"engines", required_argument, NULL, 'e'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"drop-caches", no_argument, NULL, 'C'},
+        {"format", required_argument, NULL, 'f'},
+        {"generate-only", no_argument, NULL, 'G'},
+        {NULL, 0, NULL, 0}
+    };
+    static char default_shapes[] = "flat,deep,balanced,hardlinks";
+    static char default_engines[] = "sync,batch,uring";
+    static char default_jobs[] = "1,2,4,8";
+    int opt;
+
+    options->mdu = "./mdu";
+    options->baseline = NULL;
+    options->root = "/tmp/mdu-bench";
+    options->scale = 100;
+    options->runs = 5;
+    options->drop_caches = false;
+    options->json = false;
+    options->generate_only = false;
+    options->shape_num = split_list(default_shapes, options->shapes);
+    options->engine_num = split_list(default_engines, options->engines);
+    options->job_num = split_list(default_jobs, options->jobs);
+
+    while ((opt = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                options->mdu = optarg;
+                break;
+            case 'b':
+                options->baseline = optarg;
+                break;
+            case 'r':
+                options->root = optarg;
+                break;
+            case 's':
+                options->scale = get_number(optarg, 1000000);
+                break;
+            case 'n':
+                options->runs = get_number(optarg, 64);
+                break;
+            case 'S':
+                options->shape_num = split_list(optarg, options->shapes);
+                break;
+            case 'e':
+                options->engine_num = split_list(optarg, options->engines);
+                break;
+            case 'j':
+                options->job_num = split_list(optarg, options->jobs);
+                break;
+            case 'C':
+                options->drop_caches = true;
+                break;
+            case 'f':
+                options->json = strcmp(optarg, "json") == 0;
+                break;
+            case 'G':
+                options->generate_only = true;
+                break;
+            default:
+                fprintf(stderr, USAGE);
+                exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+int main(int argc, char* argv[]) {
+    struct bench_options options;
+    parse_bench_options(argc, argv, &options);
+
+    if (options.drop_caches && !drop_caches()) {
+        fprintf(stderr, "mdu_bench: cannot drop caches, skipping cold runs\n");
+        options.drop_caches = false;
+    }
+
+    if (!options.generate_only && !options.json) {
+        printf("shape,engine,jobs,cache,runs,entries,seconds,entries_per_sec,"
+                "stats_per_sec,dir_p50_us,dir_p99_us,run_p99_ms,peak_rss_kb%s\n",
+                options.baseline != NULL ?
+                ",baseline_entries_per_sec,delta_pct" : "");
+    }
+
+    for (int i = 0 ; i < options.shape_num ; i++) {
+        const struct shape* shape = find_shape(options.shapes[i]);
+        char path[4096];
+        struct tree_size size;
+
+        prepare_tree(&options, shape, path, &size);
+
+        if (options.generate_only) {
+            continue;
+        }
+
+        for (int j = 0 ; j < options.engine_num ; j++) {
+            for (int k = 0 ; k < options.job_num ; k++) {
+                run_combination(&options, shape->name, path, &size,
+                                options.engines[j], options.jobs[k], false);
+
+                if (options.drop_caches) {
+                    run_combination(&options, shape->name, path, &size,
+                                    options.engines[j], options.jobs[k], true);
+                }
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
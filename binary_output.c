@@ -0,0 +1,284 @@
+/*
+ * @brief This module implements the datatype BinaryWriter.
+ *
+ * A chunk is written with one `pwritev` call straight from the columns of
+ * the buffer, so it is never copied. The chunks of each worker are listed
+ * in its buffer and merged into the index when the writer is finished.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "binary_output.h"
+#include "safe_functions.h"
+
+#define BINARY_COLUMNS 5
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Writes all bytes of a vector of buffers at an offset of a file.
+ *
+ * @param fd The file descriptor of the file.
+ * @param iov The buffers, they are changed if the write is split.
+ * @param iov_count The number of buffers.
+ * @param offset The offset in the file.
+ * @return Returns true on success; else false and `errno` is set.
+*/
+static bool write_vector_at(int fd, struct iovec* iov, int iov_count, 
+                            off_t offset) {
+    while (iov_count > 0) {
+        ssize_t written = pwritev(fd, iov, iov_count, offset);
+
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        offset += written;
+
+        while (iov_count > 0 && (size_t) written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+
+        if (iov_count > 0) {
+            iov->iov_base = (char*) iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * @brief Marks that a write of the file failed.
+ *
+ * @param writer A pointer to the writer.
+*/
+static void set_error(BinaryWriter* writer) {
+    int expected = 0;
+
+    atomic_compare_exchange_strong(&writer->error, &expected, errno);
+}
+
+/*
+ * @brief Writes the buffer of a worker as a chunk and empties it.
+ *
+ * @param writer A pointer to the writer.
+ * @param buffer Pointer to the buffer.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+static void flush_buffer(BinaryWriter* writer, struct binary_buffer* buffer, 
+                            void* in_use_data) {
+    static const char padding[8] = {0};
+    struct binary_chunk_header header = {
+        .count = buffer->count,
+        .string_bytes = buffer->string_bytes
+    };
+    struct iovec iov[BINARY_COLUMNS + 4];
+    size_t size = 0;
+    int n = 0;
+
+    memcpy(header.magic, BINARY_CHUNK_MAGIC, sizeof(header.magic));
+
+    iov[n++] = (struct iovec) { &header, sizeof(header) };
+
+    for (int c = 0 ; c < BINARY_COLUMNS ; c++) {
+        iov[n++] = (struct iovec) { &buffer->columns[c * BINARY_CHUNK_ENTRIES], 
+                                    buffer->count * sizeof(uint64_t) };
+    }
+
+    iov[n++] = (struct iovec) { buffer->name_offsets, 
+                                buffer->count * sizeof(uint32_t) };
+    iov[n++] = (struct iovec) { buffer->strings, buffer->string_bytes };
+
+    for (int i = 0 ; i < n ; i++) {
+        size += iov[i].iov_len;
+    }
+
+    iov[n++] = (struct iovec) { (void*) padding, (8 - size % 8) % 8 };
+    size += iov[n - 1].iov_len;
+
+    uint64_t offset = atomic_fetch_add_explicit(&writer->offset, size, 
+                                                memory_order_relaxed);
+
+    if (!write_vector_at(writer->fd, iov, n, offset)) {
+        set_error(writer);
+    }
+
+    if (buffer->chunk_count == buffer->chunk_capacity) {
+        buffer->chunk_capacity = buffer->chunk_capacity > 0 ? 
+                                    buffer->chunk_capacity * 2 : 16;
+        buffer->chunks = safe_realloc(buffer->chunks, 
+                            buffer->chunk_capacity * sizeof(struct binary_chunk_index), 
+                            in_use_data);
+    }
+
+    buffer->chunks[buffer->chunk_count++] = (struct binary_chunk_index) {
+        .offset = offset,
+        .count = buffer->count
+    };
+
+    buffer->count = 0;
+    buffer->string_bytes = 0;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+BinaryWriter* binary_writer_create(const char* path, uint32_t report,
+                                    int buffer_num, void* in_use_data) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd == -1) {
+        return NULL;
+    }
+
+    BinaryWriter* writer = safe_malloc(sizeof(BinaryWriter), in_use_data);
+    size_t length = strlen(path) + 1;
+
+    writer->fd = fd;
+    writer->path = safe_malloc(length, in_use_data);
+    memcpy(writer->path, path, length);
+    writer->report = report;
+
+    atomic_init(&writer->next_id, 0);
+    atomic_init(&writer->offset, 0);
+    atomic_init(&writer->error, 0);
+
+    writer->buffers = safe_calloc(buffer_num, sizeof(struct binary_buffer), 
+                                    in_use_data);
+    writer->buffer_num = buffer_num;
+
+    for (int i = 0 ; i < buffer_num ; i++) {
+        struct binary_buffer* buffer = &writer->buffers[i];
+
+        buffer->columns = safe_malloc(BINARY_COLUMNS * BINARY_CHUNK_ENTRIES * 
+                                        sizeof(uint64_t), in_use_data);
+        buffer->name_offsets = safe_malloc(BINARY_CHUNK_ENTRIES * 
+                                            sizeof(uint32_t), in_use_data);
+        buffer->strings = safe_malloc(BINARY_STRING_BYTES, in_use_data);
+    }
+
+    return writer;
+}
+
+
+void binary_writer_destroy(BinaryWriter* writer) {
+    if (writer == NULL) {
+        return;
+    }
+
+    for (int i = 0 ; i < writer->buffer_num ; i++) {
+        free(writer->buffers[i].columns);
+        free(writer->buffers[i].name_offsets);
+        free(writer->buffers[i].strings);
+        free(writer->buffers[i].chunks);
+    }
+
+    close(writer->fd);
+    free(writer->buffers);
+    free(writer->path);
+    free(writer);
+}
+
+
+uint64_t binary_writer_next_id(BinaryWriter* writer) {
+    return atomic_fetch_add_explicit(&writer->next_id, 1, memory_order_relaxed);
+}
+
+
+void binary_writer_add(BinaryWriter* writer, int buffer,
+                        const struct binary_entry* entry, const char* name,
+                        void* in_use_data) {
+    struct binary_buffer* b = &writer->buffers[buffer];
+    size_t length = strlen(name) + 1;
+
+    if (length > BINARY_STRING_BYTES) {
+        name = "";
+        length = 1;
+    }
+
+    if (b->count == BINARY_CHUNK_ENTRIES || 
+            b->string_bytes + length > BINARY_STRING_BYTES) {
+        flush_buffer(writer, b, in_use_data);
+    }
+
+    uint32_t i = b->count++;
+    const uint64_t values[BINARY_COLUMNS] = {
+        entry->id, entry->parent, entry->blocks, entry->bytes, entry->inodes
+    };
+
+    for (int c = 0 ; c < BINARY_COLUMNS ; c++) {
+        b->columns[c * BINARY_CHUNK_ENTRIES + i] = values[c];
+    }
+
+    b->name_offsets[i] = b->string_bytes;
+    memcpy(&b->strings[b->string_bytes], name, length);
+    b->string_bytes += length;
+}
+
+
+bool binary_writer_finish(BinaryWriter* writer, void* in_use_data) {
+    size_t chunk_count = 0;
+    uint64_t entry_count = 0;
+
+    for (int i = 0 ; i < writer->buffer_num ; i++) {
+        if (writer->buffers[i].count > 0) {
+            flush_buffer(writer, &writer->buffers[i], in_use_data);
+        }
+        chunk_count += writer->buffers[i].chunk_count;
+    }
+
+    struct binary_chunk_index* index = safe_malloc(
+                (chunk_count + 1) * sizeof(struct binary_chunk_index), in_use_data);
+    size_t used = 0;
+
+    for (int i = 0 ; i < writer->buffer_num ; i++) {
+        for (size_t j = 0 ; j < writer->buffers[i].chunk_count ; j++) {
+            index[used] = writer->buffers[i].chunks[j];
+            entry_count += index[used].count;
+            used++;
+        }
+    }
+
+    struct binary_footer footer = {
+        .version = BINARY_VERSION,
+        .report = writer->report,
+        .entry_count = entry_count,
+        .chunk_count = chunk_count,
+        .index_offset = atomic_load(&writer->offset)
+    };
+    memcpy(footer.magic, BINARY_FOOTER_MAGIC, sizeof(footer.magic));
+
+    struct iovec iov[2] = {
+        { index, chunk_count * sizeof(struct binary_chunk_index) },
+        { &footer, sizeof(footer) }
+    };
+
+    if (!write_vector_at(writer->fd, iov, 2, footer.index_offset)) {
+        set_error(writer);
+    }
+
+    free(index);
+
+    int error = atomic_load(&writer->error);
+
+    if (error != 0) {
+        errno = error;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,187 @@
+/**
+ * @defgroup module_binary_output BinaryWriter
+ *
+ * @file binary_output.h
+ * @brief This module implements the datatype BinaryWriter.
+ *
+ * The binary writer streams the totals of the directory's to a columnar
+ * file that can be mapped into memory by other tools. Each worker fills a
+ * buffer of its own with up to `BINARY_CHUNK_ENTRIES` directory's. A full
+ * buffer is written as one chunk at an offset reserved with an atomic add,
+ * so the workers never wait for each other. The file ends with an index of
+ * the chunks and a footer.
+ *
+ * A chunk starts with a `struct binary_chunk_header`, followed by the
+ * columns `id`, `parent`, `blocks`, `bytes` and `inodes` of `count` 64-bit
+ * values each, the column `name_offset` of `count` 32-bit values and the
+ * `string_bytes` bytes of null terminated names. A chunk is padded to a
+ * multiple of 8 bytes. The name of a directory is its own name, except for
+ * the roots which have the path given as an argument, and the parent of a
+ * root is `BINARY_NO_PARENT`. The full path is found by following the
+ * parents, which may be in any chunk.
+ *
+ * After the last chunk follows an index of `chunk_count`
+ * `struct binary_chunk_index` and then the `struct binary_footer`, which
+ * is the last bytes of the file.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef BINARY_OUTPUT_H
+#define BINARY_OUTPUT_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define BINARY_CHUNK_MAGIC "MDUCHUNK"
+#define BINARY_FOOTER_MAGIC "MDUBINRY"
+#define BINARY_VERSION 1
+#define BINARY_CHUNK_ENTRIES 4096
+#define BINARY_STRING_BYTES (64 * 1024)
+#define BINARY_NO_PARENT UINT64_MAX
+
+/**
+ * @brief The header of a chunk.
+*/
+struct binary_chunk_header {
+    char magic[8];
+    uint32_t count;
+    uint32_t string_bytes;
+};
+
+/**
+ * @brief An entry in the index of the chunks.
+*/
+struct binary_chunk_index {
+    uint64_t offset;
+    uint64_t count;
+};
+
+/**
+ * @brief The footer of the file.
+ *
+ * `report` is the value the user asked to be reported, see `Report`.
+*/
+struct binary_footer {
+    uint32_t version;
+    uint32_t report;
+    uint64_t entry_count;
+    uint64_t chunk_count;
+    uint64_t index_offset;
+    char magic[8];
+};
+
+/**
+ * @brief A directory to write.
+*/
+struct binary_entry {
+    uint64_t id;
+    uint64_t parent;
+    uint64_t blocks;
+    uint64_t bytes;
+    uint64_t inodes;
+};
+
+/**
+ * @brief The buffer of one worker.
+*/
+struct binary_buffer {
+    uint32_t count;
+    uint32_t string_bytes;
+    uint64_t* columns;
+    uint32_t* name_offsets;
+    char* strings;
+
+    struct binary_chunk_index* chunks;
+    size_t chunk_count;
+    size_t chunk_capacity;
+};
+
+/**
+ * @brief The type for the binary writer.
+*/
+typedef struct {
+    int fd;
+    char* path;
+    uint32_t report;
+
+    atomic_uint_fast64_t next_id;
+    atomic_uint_fast64_t offset;
+    atomic_int error;
+
+    struct binary_buffer* buffers;
+    int buffer_num;
+} BinaryWriter;
+
+/**
+ * @brief Creates the file at `path` and returns a writer for it.
+ *
+ * @param path String of the path of the file.
+ * @param report The value the user asked to be reported.
+ * @param buffer_num The number of workers that add directory's.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the writer; else NULL if the file could not be created, 
+ * `errno` is then set.
+ *
+ * @note It is the caller's responsible to deallocate the writer after use
+ * by calling the function `binary_writer_destroy()`.
+ * @see binary_writer_destroy()
+*/
+BinaryWriter* binary_writer_create(const char* path, uint32_t report,
+                                    int buffer_num, void* in_use_data);
+
+/**
+ * @brief Destroy the writer and close the file.
+ *
+ * @param writer A pointer to the writer, may be NULL.
+*/
+void binary_writer_destroy(BinaryWriter* writer);
+
+/**
+ * @brief Returns a new id for a directory.
+ *
+ * May be called by any thread.
+ *
+ * @param writer A pointer to the writer.
+ * @return Returns the id.
+*/
+uint64_t binary_writer_next_id(BinaryWriter* writer);
+
+/**
+ * @brief Adds a directory to the buffer of a worker.
+ *
+ * The buffer is written as a chunk when it is full.
+ *
+ * @param writer A pointer to the writer.
+ * @param buffer The index of the worker's buffer.
+ * @param entry Pointer to the directory's values.
+ * @param name String of the directory's name.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+void binary_writer_add(BinaryWriter* writer, int buffer,
+                        const struct binary_entry* entry, const char* name,
+                        void* in_use_data);
+
+/**
+ * @brief Writes the remaining buffers, the index and the footer.
+ *
+ * @param writer A pointer to the writer.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns true if the whole file was written; else false and 
+ * `errno` is set.
+*/
+bool binary_writer_finish(BinaryWriter* writer, void* in_use_data);
+
+#endif /* BINARY_OUTPUT_H */
+
+/**
+ * }
+*/
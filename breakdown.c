@@ -0,0 +1,164 @@
+/*
+ * @brief This module implements the datatype Breakdown.
+ *
+ * The heap is ordered with the smallest kept directory at the root, so a
+ * new directory only has to be compared with the root to know if it is
+ * among the largest.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include "breakdown.h"
+#include "safe_functions.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Swaps two entry's of the heap.
+ *
+ * @param a Pointer to the first entry.
+ * @param b Pointer to the second entry.
+*/
+static void swap_entries(struct breakdown_entry* a, struct breakdown_entry* b) {
+    struct breakdown_entry tmp = *a;
+
+    *a = *b;
+    *b = tmp;
+}
+
+/*
+ * @brief Moves an entry up the heap until its parent is smaller.
+ *
+ * @param heap The heap.
+ * @param i The index of the entry.
+*/
+static void sift_up(struct breakdown_entry* heap, long i) {
+    while (i > 0 && heap[(i - 1) / 2].value > heap[i].value) {
+        swap_entries(&heap[(i - 1) / 2], &heap[i]);
+        i = (i - 1) / 2;
+    }
+}
+
+/*
+ * @brief Moves an entry down the heap until its children are larger.
+ *
+ * @param heap The heap.
+ * @param count The number of entry's in the heap.
+ * @param i The index of the entry.
+*/
+static void sift_down(struct breakdown_entry* heap, long count, long i) {
+    for (;;) {
+        long smallest = i;
+        long left = 2 * i + 1;
+        long right = 2 * i + 2;
+
+        if (left < count && heap[left].value < heap[smallest].value) {
+            smallest = left;
+        }
+
+        if (right < count && heap[right].value < heap[smallest].value) {
+            smallest = right;
+        }
+
+        if (smallest == i) {
+            return;
+        }
+
+        swap_entries(&heap[smallest], &heap[i]);
+        i = smallest;
+    }
+}
+
+/*
+ * @brief Compares two entry's to sort them largest first.
+ *
+ * @param a Pointer to the first entry.
+ * @param b Pointer to the second entry.
+ * @return Returns a negative number if `a` is larger, zero if they are 
+ * equal; else a positive number.
+*/
+static int compare_entries(const void* a, const void* b) {
+    uint64_t value_a = ((const struct breakdown_entry*) a)->value;
+    uint64_t value_b = ((const struct breakdown_entry*) b)->value;
+
+    return (value_a < value_b) - (value_a > value_b);
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Breakdown* breakdown_create(long top, void* in_use_data) {
+    Breakdown* breakdown = safe_malloc(sizeof(Breakdown), in_use_data);
+
+    breakdown->top = top;
+    breakdown->count = 0;
+    breakdown->heap = NULL;
+    pthread_mutex_init(&breakdown->mutex, NULL);
+
+    if (top > 0) {
+        breakdown->heap = safe_calloc(top, sizeof(struct breakdown_entry), 
+                                        in_use_data);
+    }
+
+    return breakdown;
+}
+
+
+void breakdown_destroy(Breakdown* breakdown) {
+    if (breakdown == NULL) {
+        return;
+    }
+
+    for (long i = 0 ; i < breakdown->count ; i++) {
+        free(breakdown->heap[i].path);
+    }
+
+    pthread_mutex_destroy(&breakdown->mutex);
+    free(breakdown->heap);
+    free(breakdown);
+}
+
+
+void breakdown_add(Breakdown* breakdown, uint64_t value, char* path) {
+    if (breakdown->top == 0) {
+        printf("%" PRIu64 "\t%s\n", value, path);
+        free(path);
+        return;
+    }
+
+    pthread_mutex_lock(&breakdown->mutex);
+
+    if (breakdown->count < breakdown->top) {
+        breakdown->heap[breakdown->count].value = value;
+        breakdown->heap[breakdown->count].path = path;
+        sift_up(breakdown->heap, breakdown->count);
+        breakdown->count++;
+        path = NULL;
+
+    } else if (value > breakdown->heap[0].value) {
+        free(breakdown->heap[0].path);
+        breakdown->heap[0].value = value;
+        breakdown->heap[0].path = path;
+        sift_down(breakdown->heap, breakdown->count, 0);
+        path = NULL;
+    }
+
+    pthread_mutex_unlock(&breakdown->mutex);
+
+    free(path);
+}
+
+
+void breakdown_print(Breakdown* breakdown) {
+    if (breakdown->count == 0) {
+        return;
+    }
+
+    qsort(breakdown->heap, breakdown->count, sizeof(struct breakdown_entry), 
+            compare_entries);
+
+    for (long i = 0 ; i < breakdown->count ; i++) {
+        printf("%" PRIu64 "\t%s\n", breakdown->heap[i].value, 
+                breakdown->heap[i].path);
+    }
+}
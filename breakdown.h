@@ -0,0 +1,94 @@
+/**
+ * @defgroup module_breakdown Breakdown
+ *
+ * @file breakdown.h
+ * @brief This module implements the datatype Breakdown.
+ *
+ * A breakdown receives the totals of the directory's as their sub trees are
+ * completed. By default each directory is printed as soon as it is added,
+ * so the results stream out during the traversal. If only the largest
+ * directory's are asked for, they are kept in a min-heap of fixed size and
+ * printed, largest first, when the traversal is done.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef BREAKDOWN_H
+#define BREAKDOWN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+/**
+ * @brief A directory kept by the breakdown.
+*/
+struct breakdown_entry {
+    uint64_t value;
+    char* path;
+};
+
+/**
+ * @brief The type for the breakdown.
+ *
+ * If `top` is zero the directory's are printed at once; else the `count`
+ * largest directory's are kept in `heap`.
+*/
+typedef struct {
+    long top;
+    long count;
+    struct breakdown_entry* heap;
+    pthread_mutex_t mutex;
+} Breakdown;
+
+/**
+ * @brief Create and return an empty breakdown.
+ *
+ * @param top The number of directory's to keep, or zero to print every
+ * directory at once.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the newly created breakdown.
+ *
+ * @note It is the caller's responsible to deallocate the breakdown after use
+ * by calling the function `breakdown_destroy()`.
+ * @see breakdown_destroy()
+*/
+Breakdown* breakdown_create(long top, void* in_use_data);
+
+/**
+ * @brief Destroy the breakdown.
+ *
+ * @param breakdown A pointer to the breakdown, may be NULL.
+*/
+void breakdown_destroy(Breakdown* breakdown);
+
+/**
+ * @brief Adds the total of a completed directory.
+ *
+ * May be called by any thread.
+ *
+ * @param breakdown A pointer to the breakdown.
+ * @param value The reported value of the directory.
+ * @param path String of the directory's path in dynamically allocated
+ * memory, the breakdown takes ownership of it.
+*/
+void breakdown_add(Breakdown* breakdown, uint64_t value, char* path);
+
+/**
+ * @brief Prints the kept directory's, largest first.
+ *
+ * @param breakdown A pointer to the breakdown.
+*/
+void breakdown_print(Breakdown* breakdown);
+
+#endif /* BREAKDOWN_H */
+
+/**
+ * }
+*/
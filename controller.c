@@ -0,0 +1,228 @@
+/*
+ * @brief This module implements the datatype Controller.
+ *
+ * A parked worker sets its `parked` word before it checks the limit again, 
+ * and `controller_set_limit()` stores the limit before it clears the words, 
+ * so a worker never sleeps through the wake that raised its limit.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "controller.h"
+#include "safe_functions.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Returns the next limit of the controller.
+ *
+ * A change of the rate within `CONTROLLER_TOLERANCE` counts as noise. Fewer 
+ * workers are tried when the rate holds, and more workers are not tried 
+ * while some of them are idle, since they would only wait for work.
+ *
+ * @param controller Pointer to the controller.
+ * @param rate The entry's counted per second since the last sample.
+ * @return Returns the limit.
+*/
+static int next_limit(Controller* controller, double rate) {
+    ThreadContext* thread_context = controller->thread_context;
+    bool better = rate > controller->last_rate * (1 + CONTROLLER_TOLERANCE);
+    bool worse = rate < controller->last_rate * (1 - CONTROLLER_TOLERANCE);
+    int idle = atomic_load_explicit(&thread_context->idle_threads, 
+                                    memory_order_relaxed);
+
+    if (controller->growing && better) {
+        controller->step *= 2;
+
+    } else if (controller->growing) {
+        controller->growing = false;
+        controller->step = 1;
+        controller->direction = -1;
+
+    } else if (worse) {
+        controller->direction = -controller->direction;
+
+    } else if (!better) {
+        controller->direction = -1;
+    }
+
+    if (controller->direction > 0 && idle > 0) {
+        return controller->limit;
+    }
+
+    int limit = controller->limit + controller->direction * controller->step;
+
+    if (limit < 1) {
+        limit = 1;
+
+    } else if (limit > thread_context->worker_num) {
+        limit = thread_context->worker_num;
+    }
+
+    return limit;
+}
+
+/*
+ * @brief Samples the rate of the workers and moves the limit.
+ *
+ * @param controller Pointer to the controller.
+*/
+static void sample(Controller* controller) {
+    StatsTotals totals;
+    uint64_t now = stats_now();
+
+    collect_stats(controller->thread_context, &totals);
+
+    double interval = (now - controller->last_time) / 1e9;
+    double rate = interval > 0 ? 
+                    (totals.entries - controller->last_entries) / interval : 0;
+
+    controller->limit = next_limit(controller, rate);
+    controller_set_limit(controller->thread_context, controller->limit);
+
+    controller->last_entries = totals.entries;
+    controller->last_time = now;
+    controller->last_rate = rate;
+}
+
+/*
+ * @brief The main function of the controller thread.
+ *
+ * @param arg Pointer to the controller.
+ * @return Returns NULL.
+*/
+static void* controller_handler(void* arg) {
+    Controller* controller = arg;
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    pthread_mutex_lock(&controller->mutex);
+
+    while (!controller->stop) {
+        deadline.tv_sec += controller->interval / 1000;
+        deadline.tv_nsec += (controller->interval % 1000) * 1000000;
+
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        while (!controller->stop && pthread_cond_timedwait(&controller->cond, 
+                    &controller->mutex, &deadline) == 0) {
+        }
+
+        if (!controller->stop) {
+            sample(controller);
+        }
+    }
+
+    pthread_mutex_unlock(&controller->mutex);
+
+    return NULL;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Controller* controller_start(ThreadContext* thread_context, long interval) {
+    Controller* controller = safe_malloc(sizeof(Controller), thread_context);
+    pthread_condattr_t attr;
+
+    controller->thread_context = thread_context;
+    controller->interval = interval;
+    controller->limit = CONTROLLER_START_THREADS < thread_context->worker_num ? 
+                        CONTROLLER_START_THREADS : thread_context->worker_num;
+    controller->step = controller->limit;
+    controller->direction = 1;
+    controller->growing = true;
+    controller->last_entries = 0;
+    controller->last_time = stats_now();
+    controller->last_rate = 0;
+    controller->stop = false;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&controller->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&controller->mutex, NULL);
+    controller_set_limit(thread_context, controller->limit);
+
+    if (pthread_create(&controller->thread, NULL, controller_handler, 
+                        controller) != 0) {
+        report_message(thread_context, 
+                        "mdu: cannot start the controller thread\n");
+        controller_set_limit(thread_context, thread_context->worker_num);
+        pthread_cond_destroy(&controller->cond);
+        pthread_mutex_destroy(&controller->mutex);
+        free(controller);
+
+        return NULL;
+    }
+
+    return controller;
+}
+
+
+void controller_stop(Controller* controller) {
+    if (controller == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&controller->mutex);
+    controller->stop = true;
+    pthread_cond_signal(&controller->cond);
+    pthread_mutex_unlock(&controller->mutex);
+
+    pthread_join(controller->thread, NULL);
+    pthread_cond_destroy(&controller->cond);
+    pthread_mutex_destroy(&controller->mutex);
+    free(controller);
+}
+
+
+void controller_set_limit(ThreadContext* thread_context, int limit) {
+    atomic_store(&thread_context->thread_limit, limit);
+
+    for (int i = 0 ; i < thread_context->worker_num ; i++) {
+        Worker* worker = thread_context->workers[i];
+
+        if (worker->id < limit && atomic_exchange(&worker->parked, 0) == 1) {
+            syscall(SYS_futex, &worker->parked, FUTEX_WAKE_PRIVATE, 1, 
+                    NULL, NULL, 0);
+        }
+    }
+}
+
+
+bool controller_should_park(const Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+
+    return worker->id >= atomic_load(&thread_context->thread_limit) && 
+            atomic_load(&thread_context->pending_jobs) > 0;
+}
+
+
+void controller_park(Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+
+    atomic_fetch_add(&thread_context->parked_threads, 1);
+
+    while (controller_should_park(worker)) {
+        atomic_store(&worker->parked, 1);
+
+        if (!controller_should_park(worker)) {
+            atomic_store(&worker->parked, 0);
+            break;
+        }
+
+        syscall(SYS_futex, &worker->parked, FUTEX_WAIT_PRIVATE, 1, 
+                NULL, NULL, 0);
+    }
+
+    atomic_fetch_sub(&thread_context->parked_threads, 1);
+}
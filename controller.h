@@ -0,0 +1,112 @@
+/**
+ * @defgroup module_controller Controller
+ *
+ * @file controller.h
+ * @brief This module implements the datatype Controller.
+ *
+ * With `-j auto` every worker is created up front, but only the first 
+ * `thread_limit` of them look for work. The controller is a thread of its 
+ * own that samples the entry's counted by the workers at a fixed interval 
+ * and climbs towards the limit with the highest rate: it doubles the limit 
+ * while the rate improves, then moves it by one, towards fewer workers 
+ * when the rate holds and back when it drops. The workers above the limit 
+ * are parked, each on a futex of its own, so they are woken one by one 
+ * instead of through `cond_work`.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "thread_context.h"
+
+#define CONTROLLER_INTERVAL 100
+#define CONTROLLER_START_THREADS 2
+#define CONTROLLER_TOLERANCE 0.05
+
+/**
+ * @brief The type for the controller.
+ *
+ * `limit` is the current number of workers and `step` the change of the 
+ * next move, in `direction`. `growing` is set until the rate first stops 
+ * improving. `last_entries`, `last_time` and `last_rate` are the entry's 
+ * counted, the time and the rate at the last sample.
+*/
+typedef struct {
+    ThreadContext* thread_context;
+    long interval;
+
+    int limit;
+    int step;
+    int direction;
+    bool growing;
+
+    uint64_t last_entries;
+    uint64_t last_time;
+    double last_rate;
+
+    bool stop;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} Controller;
+
+/**
+ * @brief Starts a controller thread and limits the workers to 
+ * `CONTROLLER_START_THREADS`.
+ *
+ * @param thread_context A pointer to the thread context, the workers must
+ * be created.
+ * @param interval The time between two samples, in milliseconds.
+ * @return Returns the controller; else NULL if the thread cannot be 
+ * created, the workers are then not limited.
+ *
+ * @note The controller is stopped and deallocated by `controller_stop()`.
+*/
+Controller* controller_start(ThreadContext* thread_context, long interval);
+
+/**
+ * @brief Stops and deallocates a controller.
+ *
+ * @param controller Pointer to the controller, may be NULL.
+*/
+void controller_stop(Controller* controller);
+
+/**
+ * @brief Sets the number of workers that look for work, and wakes the 
+ * parked workers below it.
+ *
+ * @param thread_context A pointer to the thread context.
+ * @param limit The number of workers.
+*/
+void controller_set_limit(ThreadContext* thread_context, int limit);
+
+/**
+ * @brief Checks if a worker is above the limit while there is work 
+ * pending.
+ *
+ * @param worker A pointer to the worker.
+ * @return Returns true if the worker should park; else false.
+*/
+bool controller_should_park(const Worker* worker);
+
+/**
+ * @brief Parks the worker until it is below the limit or all work is done.
+ *
+ * @param worker A pointer to the worker, it must not hold any jobs.
+*/
+void controller_park(Worker* worker);
+
+#endif /* CONTROLLER_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,167 @@
+/*
+ * @brief This module implements a work-stealing deque.
+ *
+ * The implementation follows "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" (Lê et al., PPoPP 2013). Arrays replaced by a resize are
+ * kept on a retired list until the deque is destroyed, since a thief may
+ * still be reading from them.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include "deque.h"
+#include "safe_functions.h"
+
+#define DEQUE_INITIAL_SIZE 64
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Creates a circular array.
+ *
+ * @param size The number of values the array can hold, a power of two.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the newly created array.
+*/
+static struct deque_array* create_array(long size, void* in_use_data) {
+    struct deque_array* array = safe_malloc(sizeof(struct deque_array) +
+                                    size * sizeof(_Atomic(void*)), in_use_data);
+    array->retired = NULL;
+    array->size = size;
+
+    return array;
+}
+
+/*
+ * @brief Doubles the size of the array of the deque.
+ *
+ * The values between `top` and `bottom` are copied into the new array, the
+ * old array is retired.
+ *
+ * @param d Pointer to the deque.
+ * @param array The current array of the deque.
+ * @param top The current top of the deque.
+ * @param bottom The current bottom of the deque.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the new array.
+*/
+static struct deque_array* grow_array(Deque* d, struct deque_array* array,
+                                        long top, long bottom, void* in_use_data) {
+    struct deque_array* new_array = create_array(array->size * 2, in_use_data);
+
+    for (long i = top ; i < bottom ; i++) {
+        void* value = atomic_load_explicit(&array->buffer[i & (array->size - 1)],
+                                            memory_order_relaxed);
+        atomic_store_explicit(&new_array->buffer[i & (new_array->size - 1)],
+                                value, memory_order_relaxed);
+    }
+
+    new_array->retired = array;
+    atomic_store_explicit(&d->array, new_array, memory_order_release);
+
+    return new_array;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Deque* deque_create(void* in_use_data) {
+    Deque* d = safe_malloc(sizeof(Deque), in_use_data);
+
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    atomic_init(&d->array, create_array(DEQUE_INITIAL_SIZE, in_use_data));
+
+    return d;
+}
+
+
+void deque_destroy(Deque* d) {
+    struct deque_array* array = atomic_load(&d->array);
+
+    while (array != NULL) {
+        struct deque_array* retired = array->retired;
+        free(array);
+        array = retired;
+    }
+
+    free(d);
+}
+
+
+void deque_push(Deque* d, void* value, void* in_use_data) {
+    long bottom = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    struct deque_array* array = atomic_load_explicit(&d->array,
+                                                        memory_order_relaxed);
+
+    if (bottom - top > array->size - 1) {
+        array = grow_array(d, array, top, bottom, in_use_data);
+    }
+
+    atomic_store_explicit(&array->buffer[bottom & (array->size - 1)], value,
+                            memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, bottom + 1, memory_order_relaxed);
+}
+
+
+void* deque_take(Deque* d) {
+    long bottom = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    struct deque_array* array = atomic_load_explicit(&d->array,
+                                                        memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    void* value = NULL;
+
+    if (top <= bottom) {
+        value = atomic_load_explicit(&array->buffer[bottom & (array->size - 1)],
+                                        memory_order_relaxed);
+
+        if (top == bottom) {
+            if (!atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                    memory_order_seq_cst, memory_order_relaxed)) {
+                value = NULL;
+            }
+            atomic_store_explicit(&d->bottom, bottom + 1, memory_order_relaxed);
+        }
+
+    } else {
+        atomic_store_explicit(&d->bottom, bottom + 1, memory_order_relaxed);
+    }
+
+    return value;
+}
+
+
+void* deque_steal(Deque* d) {
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (top < bottom) {
+        struct deque_array* array = atomic_load_explicit(&d->array,
+                                                            memory_order_acquire);
+        void* value = atomic_load_explicit(&array->buffer[top & (array->size - 1)],
+                                            memory_order_relaxed);
+
+        if (atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                memory_order_seq_cst, memory_order_relaxed)) {
+            return value;
+        }
+    }
+
+    return NULL;
+}
+
+
+long deque_size(Deque* d) {
+    long bottom = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    return bottom > top ? bottom - top : 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * @defgroup module_deque Deque
+ *
+ * @file deque.h
+ * @brief This module implements a work-stealing deque.
+ *
+ * The deque is a Chase-Lev work-stealing deque. It has one owner thread that
+ * pushes and takes values at the bottom (LIFO), while any other thread may
+ * steal values from the top (FIFO). Neither the owner nor the thieves take a
+ * lock, the deque grows when it runs full.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+/**
+ * @brief The circular array holding the values of a deque.
+*/
+struct deque_array {
+    struct deque_array* retired;
+    long size;
+    _Atomic(void*) buffer[];
+};
+
+/**
+ * @brief The type for the deque.
+*/
+typedef struct {
+    atomic_long top;
+    atomic_long bottom;
+    _Atomic(struct deque_array*) array;
+} Deque;
+
+/**
+ * @brief Create and return an empty deque.
+ *
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the newly created deque.
+ *
+ * @note It is the caller's responsible to deallocate the deque after use
+ * by calling the function `deque_destroy()`.
+ * @see deque_destroy()
+*/
+Deque* deque_create(void* in_use_data);
+
+/**
+ * @brief Destroy the deque.
+ *
+ * @param d A pointer to the deque.
+ *
+ * @note The values still in the deque are not deallocated.
+*/
+void deque_destroy(Deque* d);
+
+/**
+ * @brief Push a value to the bottom of the deque.
+ *
+ * May only be called by the owner of the deque.
+ *
+ * @param d Pointer to the deque.
+ * @param value The value to push.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+void deque_push(Deque* d, void* value, void* in_use_data);
+
+/**
+ * @brief Take the last pushed value from the bottom of the deque.
+ *
+ * May only be called by the owner of the deque.
+ *
+ * @param d Pointer to the deque.
+ * @return Returns the value; else NULL if the deque is empty.
+*/
+void* deque_take(Deque* d);
+
+/**
+ * @brief Steal the oldest value from the top of the deque.
+ *
+ * May be called by any thread.
+ *
+ * @param d Pointer to the deque.
+ * @return Returns the value; else NULL if the deque is empty or if another
+ * thread won the race for the value.
+*/
+void* deque_steal(Deque* d);
+
+/**
+ * @brief Returns the approximate number of values in the deque.
+ *
+ * @param d Pointer to the deque.
+ * @return Returns the number of values in the deque.
+*/
+long deque_size(Deque* d);
+
+#endif /* DEQUE_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,357 @@
+/*
+ * @brief This module implements the datatype DeviceTable.
+ *
+ * Each worker samples the latency of every `DEVICE_ADJUST_INTERVAL`th job
+ * it finishes, and the limit is adjusted by at most one with each sample.
+ * The baseline drifts up slowly, so a few fast jobs early on do not hold
+ * the limit down for the rest of the traversal.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/sysmacros.h>
+
+#include "device.h"
+#include "job.h"
+#include "safe_functions.h"
+
+#define DEVICE_ADJUST_INTERVAL 16
+#define DEVICE_SLOW_FACTOR 2
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Parses the list of budgets into the table.
+ *
+ * @param table Pointer to the table.
+ * @param spec The list of budgets.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns true if the list is valid; else false.
+*/
+static bool parse_budgets(DeviceTable* table, const char* spec, 
+                            void* in_use_data) {
+    char* copy = safe_malloc(strlen(spec) + 1, in_use_data);
+    char* save;
+    bool valid = true;
+
+    strcpy(copy, spec);
+
+    for (char* item = strtok_r(copy, ",", &save) ; item != NULL && valid ; 
+            item = strtok_r(NULL, ",", &save)) {
+        char* separator = strchr(item, '=');
+        char* end;
+
+        if (separator == NULL || separator == item || 
+                separator - item >= DEVICE_NAME_SIZE) {
+            valid = false;
+            break;
+        }
+
+        *separator = '\0';
+        long jobs = strtol(separator + 1, &end, 10);
+
+        if (end == separator + 1 || *end != '\0' || jobs < 0 || jobs > 4096) {
+            valid = false;
+            break;
+        }
+
+        if (strcmp(item, "default") == 0) {
+            table->default_jobs = jobs;
+            continue;
+        }
+
+        table->budgets = safe_realloc(table->budgets, 
+                            (table->budget_num + 1) * sizeof(struct device_budget), 
+                            in_use_data);
+        strcpy(table->budgets[table->budget_num].name, item);
+        table->budgets[table->budget_num].jobs = jobs;
+        table->budget_num++;
+    }
+
+    free(copy);
+
+    return valid;
+}
+
+/*
+ * @brief Reads the device number and the filesystem type of every mount.
+ *
+ * If the mounts cannot be read, the devices are only known by number.
+ *
+ * @param table Pointer to the table.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+static void read_mounts(DeviceTable* table, void* in_use_data) {
+    FILE* file = fopen("/proc/self/mountinfo", "r");
+    char* line = NULL;
+    size_t size = 0;
+    unsigned int major, minor;
+
+    if (file == NULL) {
+        return;
+    }
+
+    while (getline(&line, &size, file) != -1) {
+        char* fields = strstr(line, " - ");
+        char type[DEVICE_NAME_SIZE];
+
+        if (sscanf(line, "%*d %*d %u:%u", &major, &minor) != 2 || 
+                fields == NULL || sscanf(fields, " - %31s", type) != 1) {
+            continue;
+        }
+
+        table->mounts = safe_realloc(table->mounts, 
+                            (table->mount_num + 1) * sizeof(struct device_mount), 
+                            in_use_data);
+        table->mounts[table->mount_num].dev = makedev(major, minor);
+        strcpy(table->mounts[table->mount_num].type, type);
+        table->mount_num++;
+    }
+
+    free(line);
+    fclose(file);
+}
+
+/*
+ * @brief Returns the budget of a device.
+ *
+ * A budget naming the device number wins over one naming the filesystem 
+ * type, which wins over the default.
+ *
+ * @param table Pointer to the table.
+ * @param dev The device number.
+ * @return Returns the budget, zero if there is no limit.
+*/
+static int find_budget(const DeviceTable* table, dev_t dev) {
+    char number[DEVICE_NAME_SIZE];
+    const char* type = NULL;
+
+    snprintf(number, sizeof(number), "%u:%u", major(dev), minor(dev));
+
+    for (int i = 0 ; i < table->mount_num ; i++) {
+        if (table->mounts[i].dev == dev) {
+            type = table->mounts[i].type;
+        }
+    }
+
+    for (int i = 0 ; i < table->budget_num ; i++) {
+        if (strcmp(table->budgets[i].name, number) == 0) {
+            return table->budgets[i].jobs;
+        }
+    }
+
+    for (int i = 0 ; i < table->budget_num && type != NULL ; i++) {
+        const char* name = table->budgets[i].name;
+
+        if (strncmp(type, name, strlen(name)) == 0) {
+            return table->budgets[i].jobs;
+        }
+    }
+
+    return table->default_jobs;
+}
+
+/*
+ * @brief Returns the device `dev` if it is in the table.
+ *
+ * @param table Pointer to the table.
+ * @param dev The device number.
+ * @return Returns the device; else NULL.
+*/
+static Device* find_device(DeviceTable* table, dev_t dev) {
+    int count = atomic_load_explicit(&table->count, memory_order_acquire);
+
+    for (int i = 0 ; i < count ; i++) {
+        if (table->devices[i]->dev == dev) {
+            return table->devices[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * @brief Updates the latency and the limit of a device with a finished job.
+ *
+ * @param device Pointer to the device.
+ * @param latency The time per entry of the job in nanoseconds.
+*/
+static void update_limit(Device* device, uint64_t latency) {
+    uint64_t average = atomic_load_explicit(&device->latency, 
+                                            memory_order_relaxed);
+    average = average == 0 ? latency : average - average / 8 + latency / 8;
+    atomic_store_explicit(&device->latency, average, memory_order_relaxed);
+
+    uint64_t baseline = atomic_load_explicit(&device->baseline, 
+                                                memory_order_relaxed);
+    baseline = average < baseline ? average : baseline + baseline / 256 + 1;
+    atomic_store_explicit(&device->baseline, baseline, memory_order_relaxed);
+
+    pthread_mutex_lock(&device->mutex);
+    int limit = atomic_load_explicit(&device->limit, memory_order_relaxed);
+
+    if (average > DEVICE_SLOW_FACTOR * baseline && limit > 1) {
+        atomic_store_explicit(&device->limit, limit - 1, memory_order_relaxed);
+
+    } else if (average < baseline + baseline / 2 && limit < device->budget) {
+        atomic_store_explicit(&device->limit, limit + 1, memory_order_relaxed);
+    }
+
+    pthread_mutex_unlock(&device->mutex);
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+DeviceTable* device_table_create(const char* spec, void* in_use_data) {
+    DeviceTable* table = safe_malloc(sizeof(DeviceTable), in_use_data);
+
+    atomic_init(&table->count, 0);
+    pthread_mutex_init(&table->mutex, NULL);
+    table->budgets = NULL;
+    table->budget_num = 0;
+    table->default_jobs = DEVICE_DEFAULT_JOBS;
+    table->mounts = NULL;
+    table->mount_num = 0;
+
+    if (!parse_budgets(table, spec, in_use_data)) {
+        device_table_destroy(table);
+
+        return NULL;
+    }
+
+    read_mounts(table, in_use_data);
+
+    return table;
+}
+
+
+void device_table_destroy(DeviceTable* table) {
+    if (table == NULL) {
+        return;
+    }
+
+    int count = atomic_load(&table->count);
+
+    for (int i = 0 ; i < count ; i++) {
+        pthread_mutex_destroy(&table->devices[i]->mutex);
+        free(table->devices[i]);
+    }
+
+    pthread_mutex_destroy(&table->mutex);
+    free(table->budgets);
+    free(table->mounts);
+    free(table);
+}
+
+
+Device* device_table_get(DeviceTable* table, dev_t dev, void* in_use_data) {
+    Device* device = find_device(table, dev);
+
+    if (device != NULL) {
+        return device;
+    }
+
+    /* Allocated ahead, so a failed allocation never leaves the mutex held. */
+    Device* added = safe_malloc(sizeof(Device), in_use_data);
+
+    pthread_mutex_lock(&table->mutex);
+    device = find_device(table, dev);
+    int count = atomic_load_explicit(&table->count, memory_order_relaxed);
+
+    if (device == NULL && count < DEVICE_TABLE_SIZE) {
+        device = added;
+        added = NULL;
+
+        device->dev = dev;
+        device->budget = find_budget(table, dev);
+        atomic_init(&device->limit, device->budget);
+        atomic_init(&device->active, 0);
+        atomic_init(&device->latency, 0);
+        atomic_init(&device->baseline, UINT64_MAX);
+        pthread_mutex_init(&device->mutex, NULL);
+        device->deferred = NULL;
+
+        table->devices[count] = device;
+        atomic_store_explicit(&table->count, count + 1, memory_order_release);
+    }
+
+    pthread_mutex_unlock(&table->mutex);
+    free(added);
+
+    return device;
+}
+
+
+bool device_admit(Device* device) {
+    if (device == NULL || device->budget == 0) {
+        return true;
+    }
+
+    int active = atomic_load_explicit(&device->active, memory_order_relaxed);
+
+    while (active < atomic_load_explicit(&device->limit, memory_order_relaxed)) {
+        if (atomic_compare_exchange_weak_explicit(&device->active, &active, 
+                active + 1, memory_order_acquire, memory_order_relaxed)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool device_defer(Device* device, struct job* job) {
+    bool deferred = true;
+
+    pthread_mutex_lock(&device->mutex);
+
+    if (atomic_load(&device->active) < atomic_load(&device->limit)) {
+        atomic_fetch_add(&device->active, 1);
+        deferred = false;
+
+    } else {
+        job->next = device->deferred;
+        device->deferred = job;
+    }
+
+    pthread_mutex_unlock(&device->mutex);
+
+    return deferred;
+}
+
+
+struct job* device_release(Device* device, uint64_t latency) {
+    static _Thread_local unsigned int samples;
+    struct job* job = NULL;
+
+    if (device == NULL || device->budget == 0) {
+        return NULL;
+    }
+
+    if (latency > 0 && ++samples % DEVICE_ADJUST_INTERVAL == 0) {
+        update_limit(device, latency);
+    }
+
+    pthread_mutex_lock(&device->mutex);
+
+    if (device->deferred != NULL && 
+            atomic_load(&device->active) <= atomic_load(&device->limit)) {
+        job = device->deferred;
+        device->deferred = job->next;
+        job->next = NULL;
+
+    } else {
+        atomic_fetch_sub(&device->active, 1);
+    }
+
+    pthread_mutex_unlock(&device->mutex);
+
+    return job;
+}
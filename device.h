@@ -0,0 +1,169 @@
+/**
+ * @defgroup module_device DeviceTable
+ *
+ * @file device.h
+ * @brief This module implements the datatype DeviceTable.
+ *
+ * A device table limits the number of workers traversing directory's on
+ * the same device (`st_dev`) at once. The budget of a device is picked by
+ * its filesystem type or its device number from a list such as
+ * `nfs=8,default=32`. Within its budget, the limit of a device follows the
+ * measured latency per entry: it is lowered when the latency climbs well
+ * above the best seen, and raised again when it falls back.
+ *
+ * A worker that takes a job for a device at its limit defers the job to the
+ * device. The next worker to finish a job on the device runs the deferred
+ * job instead of releasing its slot, so the workers never wait for a slot.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#define DEVICE_TABLE_SIZE 256
+#define DEVICE_NAME_SIZE 32
+#define DEVICE_DEFAULT_JOBS 0
+
+struct job;
+
+/**
+ * @brief A device of the table.
+ *
+ * `budget` is the most workers allowed on the device, zero if there is no 
+ * limit. `limit` is the current limit and `active` the number of workers 
+ * traversing a job of the device. `latency` is a moving average of the 
+ * time per entry in nanoseconds and `baseline` the lowest average seen. 
+ * `deferred` links the jobs waiting for a slot, it is guarded by `mutex`.
+*/
+typedef struct device {
+    dev_t dev;
+    int budget;
+
+    atomic_int limit;
+    atomic_int active;
+    _Atomic uint64_t latency;
+    _Atomic uint64_t baseline;
+
+    pthread_mutex_t mutex;
+    struct job* deferred;
+} Device;
+
+/**
+ * @brief A budget given on the command line.
+ *
+ * `name` is a filesystem type, which also matches the types it is a 
+ * prefix of, or a device number `major:minor`.
+*/
+struct device_budget {
+    char name[DEVICE_NAME_SIZE];
+    int jobs;
+};
+
+/**
+ * @brief A mount read from `/proc/self/mountinfo`.
+*/
+struct device_mount {
+    dev_t dev;
+    char type[DEVICE_NAME_SIZE];
+};
+
+/**
+ * @brief The type for the device table.
+ *
+ * The first `count` entry's of `devices` are set, they are only added 
+ * under `mutex` and never removed.
+*/
+typedef struct {
+    Device* devices[DEVICE_TABLE_SIZE];
+    atomic_int count;
+    pthread_mutex_t mutex;
+
+    struct device_budget* budgets;
+    int budget_num;
+    int default_jobs;
+
+    struct device_mount* mounts;
+    int mount_num;
+} DeviceTable;
+
+/**
+ * @brief Creates a device table from a list of budgets.
+ *
+ * @param spec The list of budgets, `name=jobs` separated by commas. The 
+ * name `default` sets the budget of the devices not named.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the table; else NULL if the list is invalid.
+ *
+ * @note It is the caller's responsible to deallocate the table after use
+ * by calling the function `device_table_destroy()`.
+*/
+DeviceTable* device_table_create(const char* spec, void* in_use_data);
+
+/**
+ * @brief Destroy the device table.
+ *
+ * @param table A pointer to the table, may be NULL.
+*/
+void device_table_destroy(DeviceTable* table);
+
+/**
+ * @brief Returns the device with the device number `dev`, it is added to 
+ * the table if it is not there.
+ *
+ * @param table A pointer to the table.
+ * @param dev The device number.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the device; else NULL if the table is full.
+*/
+Device* device_table_get(DeviceTable* table, dev_t dev, void* in_use_data);
+
+/**
+ * @brief Takes a slot of the device for a job.
+ *
+ * @param device A pointer to the device, may be NULL.
+ * @return Returns true if the job may run; else false.
+*/
+bool device_admit(Device* device);
+
+/**
+ * @brief Defers a job that was not admitted.
+ *
+ * If a slot was released in the meantime, the job is not deferred.
+ *
+ * @param device A pointer to the device.
+ * @param job A pointer to the job.
+ * @return Returns true if the job is deferred; else false and the job 
+ * holds a slot and may run.
+*/
+bool device_defer(Device* device, struct job* job);
+
+/**
+ * @brief Releases the slot of a finished job.
+ *
+ * The latency of the job updates the limit of the device. If a job is 
+ * deferred, the slot is handed over to it instead.
+ *
+ * @param device A pointer to the device, may be NULL.
+ * @param latency The time per entry of the finished job in nanoseconds.
+ * @return Returns the deferred job that now holds the slot; else NULL.
+*/
+struct job* device_release(Device* device, uint64_t latency);
+
+#endif /* DEVICE_H */
+
+/**
+ * }
+*/
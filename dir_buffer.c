@@ -0,0 +1,71 @@
+/*
+ * @brief This module implements the datatype DirBuffer.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "dir_buffer.h"
+#include "safe_functions.h"
+
+/*
+ * @brief The record written by `getdents64`.
+*/
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+DirBuffer* dir_buffer_create(size_t size, void* in_use_data) {
+    DirBuffer* buffer = safe_malloc(sizeof(DirBuffer), in_use_data);
+
+    buffer->data = safe_malloc(size, in_use_data);
+    buffer->size = size;
+    buffer->length = 0;
+    buffer->offset = 0;
+
+    return buffer;
+}
+
+
+void dir_buffer_destroy(DirBuffer* buffer) {
+    if (buffer != NULL) {
+        free(buffer->data);
+        free(buffer);
+    }
+}
+
+
+long dir_buffer_fill(DirBuffer* buffer, int dir_fd) {
+    long length = syscall(SYS_getdents64, dir_fd, buffer->data, buffer->size);
+
+    buffer->length = length > 0 ? length : 0;
+    buffer->offset = 0;
+
+    return length;
+}
+
+
+bool dir_buffer_next(DirBuffer* buffer, const char** name, unsigned char* type) {
+    if (buffer->offset >= buffer->length) {
+        return false;
+    }
+
+    struct linux_dirent64* entry = 
+            (struct linux_dirent64*) (buffer->data + buffer->offset);
+
+    *name = entry->d_name;
+    *type = entry->d_type;
+    buffer->offset += entry->d_reclen;
+
+    return true;
+}
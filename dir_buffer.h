@@ -0,0 +1,84 @@
+/**
+ * @defgroup module_dir_buffer DirBuffer
+ *
+ * @file dir_buffer.h
+ * @brief This module implements the datatype DirBuffer.
+ *
+ * A dir buffer reads the entry's of a directory with `getdents64` into a
+ * large buffer that is reused for every directory. The entry's are handed
+ * out in place, a name is valid until the buffer is filled again.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef DIR_BUFFER_H
+#define DIR_BUFFER_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define DIR_BUFFER_DEFAULT_SIZE (1024 * 1024)
+#define DIR_BUFFER_MIN_SIZE 4096
+
+/**
+ * @struct DirBuffer
+ *
+ * @brief Type for a getdents buffer.
+*/
+typedef struct {
+    char* data;
+    size_t size;
+    long length;
+    long offset;
+} DirBuffer;
+
+/**
+ * @brief Creates a dir buffer of `size` bytes.
+ *
+ * @param size The size of the buffer.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return A pointer to the newly created buffer.
+ *
+ * @note The returned buffer must be freed using the `dir_buffer_destroy`
+ *       function when it is no longer needed to prevent memory leaks.
+ * @see dir_buffer_destroy()
+*/
+DirBuffer* dir_buffer_create(size_t size, void* in_use_data);
+
+/**
+ * @brief Deallocates the buffer.
+ *
+ * @param buffer Pointer to the buffer, may be NULL.
+*/
+void dir_buffer_destroy(DirBuffer* buffer);
+
+/**
+ * @brief Fills the buffer with the next entry's of the directory `dir_fd`.
+ *
+ * @param buffer Pointer to the buffer.
+ * @param dir_fd File descriptor of the directory.
+ * @return Returns the number of bytes read; 0 at the end of the directory;
+ * else -1 with `errno` set.
+*/
+long dir_buffer_fill(DirBuffer* buffer, int dir_fd);
+
+/**
+ * @brief Returns the next entry in the buffer.
+ *
+ * @param buffer Pointer to the buffer.
+ * @param name Set to the name of the entry.
+ * @param type Set to the `d_type` of the entry.
+ * @return Returns true if there was an entry; else false if the buffer must
+ * be filled again.
+*/
+bool dir_buffer_next(DirBuffer* buffer, const char** name, unsigned char* type);
+
+#endif /* DIR_BUFFER_H */
+
+/**
+ * }
+*/
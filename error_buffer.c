@@ -0,0 +1,127 @@
+/*
+ * @brief This module implements the datatype ErrorBuffer.
+ *
+ * The buffer does not use the safe functions, since running out of memory
+ * while reporting an error should not end the program.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "error_buffer.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Writes bytes to stderr.
+ *
+ * @param data Pointer to the bytes.
+ * @param length The number of bytes.
+*/
+static void write_to_stderr(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(STDERR_FILENO, data, length);
+
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        data += written;
+        length -= written;
+    }
+}
+
+/*
+ * @brief Makes room for `length` more bytes in the buffer.
+ *
+ * @param buffer Pointer to the buffer.
+ * @param length The number of bytes.
+ * @return Returns true if there is room; else false.
+*/
+static bool reserve(ErrorBuffer* buffer, size_t length) {
+    if (buffer->length + length <= buffer->capacity) {
+        return true;
+    }
+
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity : 256;
+
+    while (capacity < buffer->length + length) {
+        capacity *= 2;
+    }
+
+    char* data = realloc(buffer->data, capacity);
+
+    if (data == NULL) {
+        return false;
+    }
+
+    buffer->data = data;
+    buffer->capacity = capacity;
+
+    return true;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+void error_buffer_init(ErrorBuffer* buffer) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    buffer->count = 0;
+}
+
+
+void error_buffer_destroy(ErrorBuffer* buffer) {
+    error_buffer_flush(buffer);
+    free(buffer->data);
+    error_buffer_init(buffer);
+}
+
+
+void error_buffer_add(ErrorBuffer* buffer, const char* format, va_list args) {
+    va_list copy;
+    char message[512];
+
+    va_copy(copy, args);
+    int length = vsnprintf(message, sizeof(message), format, copy);
+    va_end(copy);
+
+    buffer->count++;
+
+    if (length < 0) {
+        return;
+    }
+
+    if (!reserve(buffer, length + 1)) {
+        write_to_stderr(message, strlen(message));
+        return;
+    }
+
+    if ((size_t) length < sizeof(message)) {
+        memcpy(&buffer->data[buffer->length], message, length);
+
+    } else {
+        vsnprintf(&buffer->data[buffer->length], length + 1, format, args);
+    }
+
+    buffer->length += length;
+
+    if (buffer->length >= ERROR_BUFFER_FLUSH_SIZE) {
+        error_buffer_flush(buffer);
+    }
+}
+
+
+void error_buffer_flush(ErrorBuffer* buffer) {
+    write_to_stderr(buffer->data, buffer->length);
+    buffer->length = 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * @defgroup module_error_buffer ErrorBuffer
+ *
+ * @file error_buffer.h
+ * @brief This module implements the datatype ErrorBuffer.
+ *
+ * An error buffer collects the error messages of one thread, so the threads
+ * never take a lock to report an error. The buffer is only touched when an
+ * error occurs. It is written to stderr with a single `write` when it grows
+ * large and when it is flushed at the end of the program.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef ERROR_BUFFER_H
+#define ERROR_BUFFER_H
+
+#include <stdlib.h>
+#include <stdarg.h>
+
+#define ERROR_BUFFER_FLUSH_SIZE (64 * 1024)
+
+/**
+ * @brief The type for the error buffer.
+ *
+ * `count` is the number of errors added to the buffer, including the ones
+ * already flushed.
+*/
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    long count;
+} ErrorBuffer;
+
+/**
+ * @brief Initializes an empty error buffer.
+ *
+ * @param buffer Pointer to the buffer.
+*/
+void error_buffer_init(ErrorBuffer* buffer);
+
+/**
+ * @brief Flushes and deallocates the messages of the error buffer.
+ *
+ * @param buffer Pointer to the buffer.
+*/
+void error_buffer_destroy(ErrorBuffer* buffer);
+
+/**
+ * @brief Adds a message to the error buffer.
+ *
+ * If the memory for the message cannot be allocated, the message is written
+ * to stderr at once.
+ *
+ * @param buffer Pointer to the buffer.
+ * @param format The printf format of the message.
+ * @param args The arguments of the format.
+*/
+void error_buffer_add(ErrorBuffer* buffer, const char* format, va_list args);
+
+/**
+ * @brief Writes the messages of the error buffer to stderr and empties it.
+ *
+ * @param buffer Pointer to the buffer.
+*/
+void error_buffer_flush(ErrorBuffer* buffer);
+
+#endif /* ERROR_BUFFER_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,364 @@
+/*
+ * @brief This module implements the datatype Exclude.
+ *
+ * The levels above an entry are taken from the chain of parent jobs. A
+ * root job is named by the path of its argument, so the levels of that
+ * path are split off from its end when a pattern reaches above the root.
+ * The hash table doubles when it is half full.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fnmatch.h>
+
+#include "exclude.h"
+#include "job.h"
+#include "safe_functions.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Returns the hash of a name (FNV-1a).
+ *
+ * @param name String of the name.
+ * @return Returns the hash.
+*/
+static uint64_t hash_name(const char* name) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (const unsigned char* c = (const unsigned char*) name ; *c != '\0' ; c++) {
+        hash = (hash ^ *c) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * @brief Finds the slot of a name in the hash table.
+ *
+ * @param slots The hash table.
+ * @param capacity The capacity of the table, a power of two.
+ * @param name String of the name.
+ * @param hash The hash of the name.
+ * @return Returns the slot holding the name; else the empty slot where it
+ * belongs.
+*/
+static struct exclude_slot* find_slot(struct exclude_slot* slots,
+                                        size_t capacity, const char* name,
+                                        uint64_t hash) {
+    size_t mask = capacity - 1;
+    size_t i = hash & mask;
+
+    while (slots[i].name != NULL &&
+            (slots[i].hash != hash || strcmp(slots[i].name, name) != 0)) {
+        i = (i + 1) & mask;
+    }
+
+    return &slots[i];
+}
+
+/*
+ * @brief Doubles the capacity of the hash table of the exclude.
+ *
+ * @param exclude A pointer to the exclude.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+static void grow_slots(Exclude* exclude, void* in_use_data) {
+    size_t capacity = exclude->capacity * 2;
+    struct exclude_slot* slots = safe_calloc(capacity,
+                                    sizeof(struct exclude_slot), in_use_data);
+
+    for (size_t i = 0 ; i < exclude->capacity ; i++) {
+        struct exclude_slot* slot = &exclude->slots[i];
+
+        if (slot->name != NULL) {
+            *find_slot(slots, capacity, slot->name, slot->hash) = *slot;
+        }
+    }
+
+    free(exclude->slots);
+    exclude->slots = slots;
+    exclude->capacity = capacity;
+}
+
+/*
+ * @brief Checks if a level of a pattern holds no wildcard.
+ *
+ * @param component String of the level.
+ * @return Returns true if the level is a literal name; else false.
+*/
+static bool is_literal(const char* component) {
+    return strpbrk(component, "*?[\\") == NULL;
+}
+
+/*
+ * @brief Checks if a name matches a level of a pattern.
+ *
+ * @param pattern The pattern.
+ * @param level The index of the level in the pattern.
+ * @param name String of the name.
+ * @return Returns true if the name matches; else false.
+*/
+static bool match_component(const struct exclude_pattern* pattern, int level,
+                            const char* name) {
+    if (pattern->literal[level]) {
+        return strcmp(pattern->components[level], name) == 0;
+    }
+
+    return fnmatch(pattern->components[level], name, 0) == 0;
+}
+
+/*
+ * @brief Checks if the levels above an entry match the rest of a pattern.
+ *
+ * The last level of the pattern is already matched by the entry. A chunk
+ * is skipped, it is named by its directory.
+ *
+ * @param pattern The pattern.
+ * @param job The job of the directory holding the entry.
+ * @return Returns true if the pattern matches; else false.
+*/
+static bool match_ancestors(const struct exclude_pattern* pattern,
+                            const Job* job) {
+    const char* path = NULL;
+    size_t end = 0;
+
+    for (int level = 1 ; level < pattern->component_num ; level++) {
+        char buffer[NAME_MAX + 1];
+        const char* name = buffer;
+
+        while (job_is_chunk(job)) {
+            job = job->parent_job;
+        }
+
+        if (path == NULL && job->parent_job != NULL) {
+            name = job->name;
+            job = job->parent_job;
+
+        } else {
+            if (path == NULL) {
+                path = job->name;
+                end = strlen(path);
+            }
+
+            while (end > 0 && path[end - 1] == '/') {
+                end--;
+            }
+
+            size_t start = end;
+
+            while (start > 0 && path[start - 1] != '/') {
+                start--;
+            }
+
+            if (start == end || end - start > NAME_MAX) {
+                return false;
+            }
+
+            memcpy(buffer, path + start, end - start);
+            buffer[end - start] = '\0';
+            end = start;
+        }
+
+        if (!match_component(pattern, level, name)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * @brief Checks if any pattern of a list matches an entry.
+ *
+ * @param pattern The first pattern of the list.
+ * @param name String of the entry's name.
+ * @param job The job of the directory holding the entry.
+ * @return Returns true if a pattern matches; else false.
+*/
+static bool match_list(const struct exclude_pattern* pattern, const char* name,
+                        const Job* job) {
+    for ( ; pattern != NULL ; pattern = pattern->next) {
+        if (match_component(pattern, 0, name) && match_ancestors(pattern, job)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * @brief Destroys a list of patterns.
+ *
+ * @param pattern The first pattern of the list.
+*/
+static void destroy_patterns(struct exclude_pattern* pattern) {
+    while (pattern != NULL) {
+        struct exclude_pattern* next = pattern->next;
+
+        for (int i = 0 ; i < pattern->component_num ; i++) {
+            free(pattern->components[i]);
+        }
+
+        free(pattern->components);
+        free(pattern->literal);
+        free(pattern);
+        pattern = next;
+    }
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Exclude* exclude_create(void* in_use_data) {
+    Exclude* exclude = safe_malloc(sizeof(Exclude), in_use_data);
+
+    exclude->capacity = EXCLUDE_INITIAL_CAPACITY;
+    exclude->slots = safe_calloc(exclude->capacity, sizeof(struct exclude_slot),
+                                    in_use_data);
+    exclude->count = 0;
+    exclude->globs = NULL;
+    exclude->key = 0;
+
+    return exclude;
+}
+
+
+void exclude_destroy(Exclude* exclude) {
+    if (exclude == NULL) {
+        return;
+    }
+
+    for (size_t i = 0 ; i < exclude->capacity ; i++) {
+        free(exclude->slots[i].name);
+        destroy_patterns(exclude->slots[i].patterns);
+    }
+
+    destroy_patterns(exclude->globs);
+    free(exclude->slots);
+    free(exclude);
+}
+
+
+void exclude_add(Exclude* exclude, const char* pattern, void* in_use_data) {
+    size_t length = strlen(pattern);
+    int component_num = 0;
+
+    for (size_t i = 0 ; i < length ; i++) {
+        if (pattern[i] != '/' && (i == 0 || pattern[i - 1] == '/')) {
+            component_num++;
+        }
+    }
+
+    if (component_num == 0) {
+        return;
+    }
+
+    exclude->key = (exclude->key ^ hash_name(pattern)) * 0x100000001b3ULL;
+
+    struct exclude_pattern* added = safe_malloc(sizeof(struct exclude_pattern),
+                                                in_use_data);
+    added->components = safe_malloc(component_num * sizeof(char*), in_use_data);
+    added->literal = safe_malloc(component_num * sizeof(bool), in_use_data);
+    added->component_num = component_num;
+
+    size_t end = length;
+
+    for (int level = 0 ; level < component_num ; level++) {
+        while (pattern[end - 1] == '/') {
+            end--;
+        }
+
+        size_t start = end;
+
+        while (start > 0 && pattern[start - 1] != '/') {
+            start--;
+        }
+
+        char* component = safe_malloc(end - start + 1, in_use_data);
+        memcpy(component, pattern + start, end - start);
+        component[end - start] = '\0';
+
+        added->components[level] = component;
+        added->literal[level] = is_literal(component);
+        end = start;
+    }
+
+    if (!added->literal[0]) {
+        added->next = exclude->globs;
+        exclude->globs = added;
+
+        return;
+    }
+
+    if ((exclude->count + 1) * 2 > exclude->capacity) {
+        grow_slots(exclude, in_use_data);
+    }
+
+    uint64_t hash = hash_name(added->components[0]);
+    struct exclude_slot* slot = find_slot(exclude->slots, exclude->capacity,
+                                            added->components[0], hash);
+
+    if (slot->name == NULL) {
+        slot->name = safe_malloc(strlen(added->components[0]) + 1, in_use_data);
+        strcpy(slot->name, added->components[0]);
+        slot->hash = hash;
+        slot->patterns = NULL;
+        exclude->count++;
+    }
+
+    added->next = slot->patterns;
+    slot->patterns = added;
+}
+
+
+bool exclude_add_file(Exclude* exclude, const char* path, void* in_use_data) {
+    FILE* file = fopen(path, "r");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    char* line = NULL;
+    size_t size = 0;
+    ssize_t length;
+
+    while ((length = getline(&line, &size, file)) != -1) {
+        while (length > 0 && (line[length - 1] == '\n' ||
+                                line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+
+        exclude_add(exclude, line, in_use_data);
+    }
+
+    bool failed = ferror(file);
+    int error = errno;
+
+    free(line);
+    fclose(file);
+    errno = error;
+
+    return !failed;
+}
+
+
+bool exclude_match(const Exclude* exclude, const char* name,
+                    const struct job* directory) {
+    if (exclude->count > 0) {
+        const struct exclude_slot* slot = find_slot(exclude->slots,
+                                                    exclude->capacity, name,
+                                                    hash_name(name));
+
+        if (slot->name != NULL && match_list(slot->patterns, name, directory)) {
+            return true;
+        }
+    }
+
+    return match_list(exclude->globs, name, directory);
+}
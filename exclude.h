@@ -0,0 +1,141 @@
+/**
+ * @defgroup module_exclude Exclude
+ *
+ * @file exclude.h
+ * @brief This module implements the datatype Exclude.
+ *
+ * An exclude holds the patterns of `--exclude` and `--exclude-from`. An
+ * entry whose name matches a pattern is skipped before it is stat'ed, so
+ * an excluded directory is never opened and nothing below it is counted.
+ *
+ * A pattern without a `/` is matched against the name of the entry, a
+ * pattern such as `.git/objects` against the last levels of its path, each 
+ * level of the pattern against one level of the path, so a wildcard never 
+ * matches a `/`. Most patterns are literal names, they are kept in a hash 
+ * table keyed by their last level, so an entry is looked up once however 
+ * many there are. Only the patterns whose last level holds a wildcard are 
+ * matched one by one with `fnmatch`.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef EXCLUDE_H
+#define EXCLUDE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#define EXCLUDE_INITIAL_CAPACITY 16
+
+struct job;
+
+/**
+ * @brief A pattern of the exclude.
+ *
+ * `components` holds the levels of the pattern from the last to the first,
+ * `literal` tells for each of them if it holds no wildcard. `next` links
+ * the patterns with the same slot or the patterns with a wildcard in their
+ * last level.
+*/
+struct exclude_pattern {
+    struct exclude_pattern* next;
+    char** components;
+    bool* literal;
+    int component_num;
+};
+
+/**
+ * @brief A slot of the hash table, `name` is NULL if it is empty.
+*/
+struct exclude_slot {
+    char* name;
+    uint64_t hash;
+    struct exclude_pattern* patterns;
+};
+
+/**
+ * @struct Exclude
+ *
+ * @brief Type for the exclude.
+ *
+ * `slots` is the hash table of the patterns with a literal last level, it
+ * holds `count` names of `capacity`. `globs` links the other patterns.
+ * `key` is a hash of every pattern added, in order, so a scan cache of
+ * other patterns is not used. The exclude is not changed once the workers are started, so it is read
+ * without a lock.
+*/
+typedef struct {
+    struct exclude_slot* slots;
+    size_t capacity;
+    size_t count;
+    struct exclude_pattern* globs;
+    uint64_t key;
+} Exclude;
+
+/**
+ * @brief Creates an empty exclude.
+ *
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the newly created exclude.
+ *
+ * @note It is the caller's responsible to deallocate the exclude after use
+ * by calling the function `exclude_destroy()`.
+ * @see exclude_destroy()
+*/
+Exclude* exclude_create(void* in_use_data);
+
+/**
+ * @brief Destroys the exclude.
+ *
+ * @param exclude A pointer to the exclude or NULL.
+*/
+void exclude_destroy(Exclude* exclude);
+
+/**
+ * @brief Adds a pattern to the exclude.
+ *
+ * Empty levels are ignored, so leading and trailing slashes make no
+ * difference.
+ *
+ * @param exclude A pointer to the exclude.
+ * @param pattern The pattern, it is copied.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+void exclude_add(Exclude* exclude, const char* pattern, void* in_use_data);
+
+/**
+ * @brief Adds the patterns of a file to the exclude, one for each line.
+ *
+ * Empty lines are ignored.
+ *
+ * @param exclude A pointer to the exclude.
+ * @param path The path of the file.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns true if the file was read; else false and `errno` is set.
+*/
+bool exclude_add_file(Exclude* exclude, const char* path, void* in_use_data);
+
+/**
+ * @brief Checks if an entry matches a pattern of the exclude.
+ *
+ * @param exclude A pointer to the exclude.
+ * @param name String of the entry's name.
+ * @param directory The job of the directory holding the entry, its
+ * parent jobs give the levels above the entry.
+ * @return Returns true if the entry is excluded; else false.
+*/
+bool exclude_match(const Exclude* exclude, const char* name,
+                    const struct job* directory);
+
+#endif /* EXCLUDE_H */
+
+/**
+ * }
+*/
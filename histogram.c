@@ -0,0 +1,203 @@
+/*
+ * @brief This module implements the datatype Histogram.
+ *
+ * The bounds of the size buckets are powers of two, so they are printed
+ * exactly with the suffix `K`, `M`, `G`, `T`, `P` or `E`.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <inttypes.h>
+
+#include "histogram.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Returns the lower bound of the values of a bucket.
+ *
+ * @param bucket The index of the bucket.
+ * @return Returns the lower bound.
+*/
+static uint64_t bucket_min(int bucket) {
+    return bucket > 0 ? (uint64_t) 1 << (bucket - 1) : 0;
+}
+
+/*
+ * @brief Formats a power of two, or zero, as a size.
+ *
+ * @param buffer The buffer to format into.
+ * @param size The size of the buffer.
+ * @param value The value to format.
+*/
+static void format_size(char* buffer, size_t size, uint64_t value) {
+    static const char suffixes[] = "KMGTPE";
+    int suffix = -1;
+
+    while (value >= 1024 && value % 1024 == 0) {
+        value /= 1024;
+        suffix++;
+    }
+
+    if (suffix < 0) {
+        snprintf(buffer, size, "%" PRIu64, value);
+
+    } else {
+        snprintf(buffer, size, "%" PRIu64 "%c", value, suffixes[suffix]);
+    }
+}
+
+/*
+ * @brief Returns the range of the non-empty buckets.
+ *
+ * @param buckets The buckets.
+ * @param bucket_num The number of buckets.
+ * @param first Pointer to the index of the first non-empty bucket.
+ * @return Returns the index after the last non-empty bucket, zero if all
+ * buckets are empty.
+*/
+static int used_buckets(const struct histogram_bucket* buckets, int bucket_num,
+                        int* first) {
+    int last = 0;
+
+    *first = bucket_num;
+
+    for (int i = 0 ; i < bucket_num ; i++) {
+        if (buckets[i].files > 0) {
+            if (*first == bucket_num) {
+                *first = i;
+            }
+
+            last = i + 1;
+        }
+    }
+
+    return last;
+}
+
+/*
+ * @brief Prints the buckets of one histogram as text.
+ *
+ * @param buckets The buckets.
+ * @param bucket_num The number of buckets.
+ * @param is_size If the buckets hold sizes; else ages in days.
+ * @param stream The stream to print to.
+*/
+static void print_buckets(const struct histogram_bucket* buckets,
+                            int bucket_num, bool is_size, FILE* stream) {
+    int first;
+    int last = used_buckets(buckets, bucket_num, &first);
+
+    for (int i = first ; i < last ; i++) {
+        char min[32];
+        char max[32];
+
+        if (is_size) {
+            format_size(min, sizeof(min), bucket_min(i));
+            format_size(max, sizeof(max), bucket_min(i + 1));
+
+        } else {
+            snprintf(min, sizeof(min), "%" PRIu64, bucket_min(i));
+            snprintf(max, sizeof(max), "%" PRIu64 " days", bucket_min(i + 1));
+        }
+
+        if (i == bucket_num - 1) {
+            snprintf(max, sizeof(max), "%s", is_size ? "" : "days");
+            fprintf(stream, "  >= %-5s %-9s", min, max);
+
+        } else {
+            fprintf(stream, "  %5s - %-9s", min, max);
+        }
+
+        fprintf(stream, " %12" PRIu64 " files %20" PRIu64 " bytes\n",
+                buckets[i].files, buckets[i].bytes);
+    }
+}
+
+/*
+ * @brief Prints a string as a JSON string.
+ *
+ * @param string The string.
+ * @param stream The stream to print to.
+*/
+static void print_json_string(const char* string, FILE* stream) {
+    fputc('"', stream);
+
+    for (const unsigned char* c = (const unsigned char*) string ; *c != '\0' ;
+            c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(stream, "\\%c", *c);
+
+        } else if (*c < 0x20) {
+            fprintf(stream, "\\u%04x", *c);
+
+        } else {
+            fputc(*c, stream);
+        }
+    }
+
+    fputc('"', stream);
+}
+
+/*
+ * @brief Prints the non-empty buckets of one histogram as a JSON array.
+ *
+ * @param buckets The buckets.
+ * @param bucket_num The number of buckets.
+ * @param stream The stream to print to.
+*/
+static void print_json_buckets(const struct histogram_bucket* buckets,
+                                int bucket_num, FILE* stream) {
+    bool first = true;
+
+    fputc('[', stream);
+
+    for (int i = 0 ; i < bucket_num ; i++) {
+        if (buckets[i].files == 0) {
+            continue;
+        }
+
+        fprintf(stream, "%s{\"min\": %" PRIu64 ", \"files\": %" PRIu64
+                ", \"bytes\": %" PRIu64 "}", first ? "" : ", ", bucket_min(i),
+                buckets[i].files, buckets[i].bytes);
+        first = false;
+    }
+
+    fputc(']', stream);
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+void histogram_merge(Histogram* total, const Histogram* histogram) {
+    for (int i = 0 ; i < HISTOGRAM_SIZE_BUCKETS ; i++) {
+        total->sizes[i].files += histogram->sizes[i].files;
+        total->sizes[i].bytes += histogram->sizes[i].bytes;
+    }
+
+    for (int i = 0 ; i < HISTOGRAM_AGE_BUCKETS ; i++) {
+        total->ages[i].files += histogram->ages[i].files;
+        total->ages[i].bytes += histogram->ages[i].bytes;
+    }
+}
+
+
+void histogram_print(const Histogram* histogram, const char* path,
+                        FILE* stream) {
+    fprintf(stream, "%s: file sizes in bytes\n", path);
+    print_buckets(histogram->sizes, HISTOGRAM_SIZE_BUCKETS, true, stream);
+    fprintf(stream, "%s: file ages\n", path);
+    print_buckets(histogram->ages, HISTOGRAM_AGE_BUCKETS, false, stream);
+}
+
+
+void histogram_print_json(const Histogram* histogram, const char* path,
+                            FILE* stream) {
+    fprintf(stream, "{\"path\": ");
+    print_json_string(path, stream);
+    fprintf(stream, ", \"sizes\": ");
+    print_json_buckets(histogram->sizes, HISTOGRAM_SIZE_BUCKETS, stream);
+    fprintf(stream, ", \"ages\": ");
+    print_json_buckets(histogram->ages, HISTOGRAM_AGE_BUCKETS, stream);
+    fprintf(stream, "}\n");
+}
@@ -0,0 +1,131 @@
+/**
+ * @defgroup module_histogram Histogram
+ *
+ * @file histogram.h
+ * @brief This module implements the datatype Histogram.
+ *
+ * A histogram counts the files of a directory tree in log2 buckets by their
+ * size and by the age of their mtime in days. Bucket 0 holds the files of
+ * size zero or younger than a day, bucket `i` the files from 2^(i - 1) up
+ * to 2^i. Each bucket holds the number of files and their apparent size.
+ *
+ * Each worker fills a histogram of its own for every argument, without
+ * locks, and the histograms are merged when the traversal is done.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define HISTOGRAM_SIZE_BUCKETS 64
+#define HISTOGRAM_AGE_BUCKETS 24
+#define HISTOGRAM_DAY 86400
+
+/**
+ * @brief A bucket of a histogram.
+*/
+struct histogram_bucket {
+    uint64_t files;
+    uint64_t bytes;
+};
+
+/**
+ * @struct Histogram
+ *
+ * @brief Type for the histograms of the sizes and ages of a directory tree.
+*/
+typedef struct {
+    struct histogram_bucket sizes[HISTOGRAM_SIZE_BUCKETS];
+    struct histogram_bucket ages[HISTOGRAM_AGE_BUCKETS];
+} Histogram;
+
+/**
+ * @brief Returns the log2 bucket of a value.
+ *
+ * @param value The value.
+ * @param bucket_num The number of buckets, the last bucket also holds the
+ * larger values.
+ * @return Returns the index of the bucket.
+*/
+static inline int histogram_bucket(uint64_t value, int bucket_num) {
+    int bucket = value > 0 ? 64 - __builtin_clzll(value) : 0;
+
+    return bucket < bucket_num ? bucket : bucket_num - 1;
+}
+
+/**
+ * @brief Adds a file to a histogram.
+ *
+ * It is called for every counted file, so it only touches the two buckets
+ * of the file.
+ *
+ * @param histogram Pointer to the histogram, owned by the calling worker.
+ * @param file_info The stat struct of the file.
+ * @param now The time the ages are counted from.
+*/
+static inline void histogram_add(Histogram* histogram,
+                                    const struct stat* file_info, time_t now) {
+    uint64_t bytes = file_info->st_size > 0 ? file_info->st_size : 0;
+    uint64_t days = file_info->st_mtime < now ?
+                    (now - file_info->st_mtime) / HISTOGRAM_DAY : 0;
+
+    struct histogram_bucket* size = &histogram->sizes[histogram_bucket(bytes,
+                                                    HISTOGRAM_SIZE_BUCKETS)];
+    struct histogram_bucket* age = &histogram->ages[histogram_bucket(days,
+                                                    HISTOGRAM_AGE_BUCKETS)];
+
+    size->files++;
+    size->bytes += bytes;
+    age->files++;
+    age->bytes += bytes;
+}
+
+/**
+ * @brief Adds the buckets of a histogram to another histogram.
+ *
+ * @param total Pointer to the histogram to add to.
+ * @param histogram Pointer to the histogram to add.
+*/
+void histogram_merge(Histogram* total, const Histogram* histogram);
+
+/**
+ * @brief Prints a histogram as text.
+ *
+ * Only the buckets from the first to the last non-empty bucket are
+ * printed.
+ *
+ * @param histogram Pointer to the histogram.
+ * @param path The path of the argument of the histogram.
+ * @param stream The stream to print to.
+*/
+void histogram_print(const Histogram* histogram, const char* path,
+                        FILE* stream);
+
+/**
+ * @brief Prints a histogram as a JSON line.
+ *
+ * Only the non-empty buckets are printed, each with the lower bound `min`
+ * of its values.
+ *
+ * @param histogram Pointer to the histogram.
+ * @param path The path of the argument of the histogram.
+ * @param stream The stream to print to.
+*/
+void histogram_print_json(const Histogram* histogram, const char* path,
+                            FILE* stream);
+
+#endif /* HISTOGRAM_H */
+
+/**
+ * }
+*/
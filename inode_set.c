@@ -0,0 +1,182 @@
+/*
+ * @brief This module implements the datatype InodeSet.
+ *
+ * The top bits of the hash of a key select the shard and the low bits the
+ * first slot to probe. A shard doubles its table when it is 70 % full.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <string.h>
+
+#include "inode_set.h"
+#include "safe_functions.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Returns the hash of a key (splitmix64 finalizer).
+ *
+ * @param dev The device of the inode.
+ * @param ino The inode number.
+ * @return Returns the hash.
+*/
+static uint64_t hash_key(uint64_t dev, uint64_t ino) {
+    uint64_t hash = ino ^ (dev * 0x9e3779b97f4a7c15ULL);
+
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+
+    return hash ^ (hash >> 31);
+}
+
+/*
+ * @brief Checks if a slot in a shard is empty.
+ *
+ * @param key The key of the slot.
+ * @return Returns true if the slot is empty; else false.
+*/
+static bool is_empty(const struct inode_key* key) {
+    return key->dev == 0 && key->ino == 0;
+}
+
+/*
+ * @brief Finds the slot of a key in a shard.
+ *
+ * @param keys The table of the shard.
+ * @param capacity The capacity of the table, a power of two.
+ * @param hash The hash of the key.
+ * @param dev The device of the inode.
+ * @param ino The inode number.
+ * @return Returns the slot holding the key; else the empty slot where it
+ * belongs.
+*/
+static struct inode_key* find_slot(struct inode_key* keys, size_t capacity,
+                                    uint64_t hash, uint64_t dev, uint64_t ino) {
+    size_t mask = capacity - 1;
+    size_t i = hash & mask;
+
+    while (!is_empty(&keys[i]) && (keys[i].dev != dev || keys[i].ino != ino)) {
+        i = (i + 1) & mask;
+    }
+
+    return &keys[i];
+}
+
+/*
+ * @brief Doubles the capacity of a shard and moves its keys.
+ *
+ * The keys are allocated before the mutex of the shard is taken, so a 
+ * failed allocation never leaves it locked. Another thread may have grown 
+ * the shard in the meantime, the keys are then freed again.
+ *
+ * @param shard A pointer to the shard.
+ * @param full_capacity The capacity the shard had when it was full.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+static void grow_shard(struct inode_shard* shard, size_t full_capacity, 
+                        void* in_use_data) {
+    size_t capacity = full_capacity * 2;
+    struct inode_key* keys = safe_calloc(capacity, sizeof(struct inode_key),
+                                            in_use_data);
+
+    pthread_mutex_lock(&shard->mutex);
+
+    if (shard->capacity != full_capacity) {
+        pthread_mutex_unlock(&shard->mutex);
+        free(keys);
+
+        return;
+    }
+
+    for (size_t i = 0 ; i < shard->capacity ; i++) {
+        struct inode_key* key = &shard->keys[i];
+
+        if (!is_empty(key)) {
+            *find_slot(keys, capacity, hash_key(key->dev, key->ino), key->dev,
+                        key->ino) = *key;
+        }
+    }
+
+    free(shard->keys);
+    shard->keys = keys;
+    shard->capacity = capacity;
+
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+InodeSet* inode_set_create(void* in_use_data) {
+    InodeSet* set = safe_aligned_alloc(64, sizeof(InodeSet), in_use_data);
+
+    for (int i = 0 ; i < INODE_SET_SHARDS ; i++) {
+        struct inode_shard* shard = &set->shards[i];
+
+        pthread_mutex_init(&shard->mutex, NULL);
+        shard->keys = safe_calloc(INODE_SET_INITIAL_CAPACITY,
+                                    sizeof(struct inode_key), in_use_data);
+        shard->capacity = INODE_SET_INITIAL_CAPACITY;
+        shard->count = 0;
+    }
+
+    return set;
+}
+
+
+void inode_set_destroy(InodeSet* set) {
+    if (set == NULL) {
+        return;
+    }
+
+    for (int i = 0 ; i < INODE_SET_SHARDS ; i++) {
+        pthread_mutex_destroy(&set->shards[i].mutex);
+        free(set->shards[i].keys);
+    }
+
+    free(set);
+}
+
+
+bool inode_set_insert(InodeSet* set, dev_t dev, ino_t ino, void* in_use_data) {
+    uint64_t hash = hash_key(dev, ino);
+    struct inode_shard* shard = &set->shards[hash >> (64 - INODE_SET_SHARD_BITS)];
+    bool inserted = false;
+    size_t full_capacity = 0;
+
+    pthread_mutex_lock(&shard->mutex);
+
+    /* The threads racing to grow the shard may fill it past its limit. */
+    while (shard->count * 10 > shard->capacity * 9) {
+        full_capacity = shard->capacity;
+        pthread_mutex_unlock(&shard->mutex);
+        grow_shard(shard, full_capacity, in_use_data);
+        pthread_mutex_lock(&shard->mutex);
+    }
+
+    full_capacity = 0;
+
+    struct inode_key* slot = find_slot(shard->keys, shard->capacity, hash,
+                                        dev, ino);
+
+    if (is_empty(slot)) {
+        slot->dev = dev;
+        slot->ino = ino;
+        shard->count++;
+        inserted = true;
+
+        if (shard->count * 10 > shard->capacity * 7) {
+            full_capacity = shard->capacity;
+        }
+    }
+
+    pthread_mutex_unlock(&shard->mutex);
+
+    if (full_capacity > 0) {
+        grow_shard(shard, full_capacity, in_use_data);
+    }
+
+    return inserted;
+}
@@ -0,0 +1,94 @@
+/**
+ * @defgroup module_inode_set InodeSet
+ *
+ * @file inode_set.h
+ * @brief This module implements the datatype InodeSet.
+ *
+ * The inode set is a concurrent hash set of `(st_dev, st_ino)` pairs used
+ * to count hard linked files once. The set is split into shards, each an
+ * open addressing table with linear probing and a lock of its own, so
+ * workers inserting different inodes rarely wait for each other.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef INODE_SET_H
+#define INODE_SET_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#define INODE_SET_SHARD_BITS 6
+#define INODE_SET_SHARDS (1 << INODE_SET_SHARD_BITS)
+#define INODE_SET_INITIAL_CAPACITY 256
+
+/**
+ * @brief A key in the inode set, a key with both fields zero is empty.
+*/
+struct inode_key {
+    uint64_t dev;
+    uint64_t ino;
+};
+
+/**
+ * @brief A shard of the inode set.
+*/
+struct inode_shard {
+    alignas(64) pthread_mutex_t mutex;
+    struct inode_key* keys;
+    size_t capacity;
+    size_t count;
+};
+
+/**
+ * @brief The type for the inode set.
+*/
+typedef struct {
+    struct inode_shard shards[INODE_SET_SHARDS];
+} InodeSet;
+
+/**
+ * @brief Create and return an empty inode set.
+ *
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the newly created set.
+ *
+ * @note It is the caller's responsible to deallocate the set after use
+ * by calling the function `inode_set_destroy()`.
+ * @see inode_set_destroy()
+*/
+InodeSet* inode_set_create(void* in_use_data);
+
+/**
+ * @brief Destroy the inode set.
+ *
+ * @param set A pointer to the set, may be NULL.
+*/
+void inode_set_destroy(InodeSet* set);
+
+/**
+ * @brief Inserts an inode in the set.
+ *
+ * @param set A pointer to the set.
+ * @param dev The device of the inode.
+ * @param ino The inode number.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns true if the inode was inserted; else false if it was
+ * already in the set.
+*/
+bool inode_set_insert(InodeSet* set, dev_t dev, ino_t ino, void* in_use_data);
+
+#endif /* INODE_SET_H */
+
+/**
+ * }
+*/
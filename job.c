@@ -0,0 +1,398 @@
+/*
+ * @brief This module implements the datatype Job.
+ *
+ * A job is the unit of work handed between the worker threads, one job is
+ * one directory to traverse.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include "job.h"
+#include "arena.h"
+#include "safe_functions.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Takes a job from the pool of the worker, a new job is allocated 
+ * if the pool is empty.
+ *
+ * @param worker A pointer to the worker.
+ * @return Returns the job.
+*/
+static Job* take_from_pool(Worker* worker) {
+    Job* job = worker->free_jobs;
+
+    if (job == NULL) {
+        return safe_malloc(sizeof(Job), worker->thread_context);
+    }
+
+    worker->free_jobs = job->next;
+    worker->free_job_count--;
+
+    return job;
+}
+
+/*
+ * @brief Returns a job to the pool of the worker, the job is deallocated if 
+ * the pool is full.
+ *
+ * @param job Pointer to the job.
+ * @param worker A pointer to the worker.
+*/
+static void return_to_pool(Job* job, Worker* worker) {
+    if (worker->free_job_count >= JOB_POOL_SIZE) {
+        free(job);
+        return;
+    }
+
+    job->next = worker->free_jobs;
+    worker->free_jobs = job;
+    worker->free_job_count++;
+}
+
+/*
+ * @brief Reports the total of a complete job and adds it to its parent job.
+ *
+ * Chunks are not reported, neither are directory's deeper than the maximum 
+ * depth. The usage below the directory is appended to the scan cache.
+ *
+ * @param job Pointer to the job.
+ * @param worker A pointer to the worker completing the job.
+*/
+static void complete_job(Job* job, Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    Usage usage = {
+        .blocks = atomic_load_explicit(&job->subtree.blocks, memory_order_relaxed),
+        .bytes = atomic_load_explicit(&job->subtree.bytes, memory_order_relaxed),
+        .inodes = atomic_load_explicit(&job->subtree.inodes, memory_order_relaxed)
+    };
+    long max_depth = thread_context->options.max_depth;
+
+    if (thread_context->cache != NULL && job->has_record) {
+        job->record.blocks = usage.blocks - job->self.blocks;
+        job->record.bytes = usage.bytes - job->self.bytes;
+        job->record.inodes = usage.inodes - job->self.inodes;
+
+        scan_cache_append(thread_context->cache, worker->id, &job->record, 
+                            thread_context);
+    }
+
+    bool reported = reports_directories(thread_context) && !job_is_chunk(job) && 
+                    (max_depth < 0 || job->depth <= max_depth);
+
+    if (reported && thread_context->directory_callback != NULL) {
+        char* path = job_get_path(job, NULL, thread_context);
+
+        thread_context->directory_callback(path, &usage, job->depth, 
+                                            thread_context->callback_data);
+        free(path);
+
+    } else if (reported && thread_context->binary != NULL) {
+        struct binary_entry entry = {
+            .id = job->id,
+            .parent = job->parent_job != NULL ? job->parent_job->id : 
+                                                BINARY_NO_PARENT,
+            .blocks = usage.blocks,
+            .bytes = usage.bytes,
+            .inodes = usage.inodes
+        };
+
+        binary_writer_add(thread_context->binary, worker->id, &entry, job->name, 
+                            thread_context);
+
+    } else if (reported) {
+        breakdown_add(thread_context->breakdown, 
+                        usage_reported_value(&usage, &thread_context->options), 
+                        job_get_path(job, NULL, thread_context));
+    }
+
+    if (job->parent_job != NULL) {
+        job_add_usage(job->parent_job, &usage);
+    }
+}
+
+/*
+ * @brief Opens a directory relative to an open directory.
+ *
+ * Symbolic links are not followed.
+ *
+ * @param dir_fd File descriptor of the directory containing the directory,
+ * may be `AT_FDCWD`.
+ * @param name String of the directory name to be opened.
+ * @return On success it returns the DIR pointer of the opened directory;
+ * else NULL and `errno` is set.
+*/
+static DIR* open_directory_at(int dir_fd, const char* name) {
+    DIR* directory = NULL;
+    int fd = openat(dir_fd, name, 
+                    O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+    if (fd != -1 && (directory = fdopendir(fd)) == NULL) {
+        int error = errno;
+
+        close(fd);
+        errno = error;
+    }
+
+    return directory;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Job* job_create(char* name, Job* parent_job, DirHandle* parent, int root, 
+                    Worker* worker) {
+    Job* job = take_from_pool(worker);
+
+    job->next = NULL;
+    job->parent_job = parent_job;
+    atomic_init(&job->refs, 1);
+
+    job->name = name;
+    job->parent = parent;
+    job->root = root;
+    job->count_self = false;
+    job->depth = parent_job != NULL ? parent_job->depth + 1 : 0;
+    atomic_init(&job->subtree.blocks, 0);
+    atomic_init(&job->subtree.bytes, 0);
+    atomic_init(&job->subtree.inodes, 0);
+    job->self = (Usage) {0};
+    job->device = parent_job != NULL ? parent_job->device : NULL;
+    job->prefetch_ticket = 0;
+    job->id = 0;
+
+    if (worker->thread_context->binary != NULL && name != NULL) {
+        job->id = binary_writer_next_id(worker->thread_context->binary);
+    }
+    job->has_record = false;
+
+    job->names = NULL;
+    job->name_count = 0;
+    job->names_used = 0;
+
+    if (parent_job != NULL) {
+        atomic_fetch_add_explicit(&parent_job->refs, 1, memory_order_relaxed);
+    }
+
+    return job;
+}
+
+
+Job* job_create_chunk(Job* directory_job, DirHandle* directory, Worker* worker) {
+    Job* job = job_create(NULL, directory_job, directory, directory_job->root, 
+                            worker);
+
+    job->names = safe_malloc(JOB_CHUNK_BYTES, worker->thread_context);
+    job->depth = directory_job->depth;
+    job->id = directory_job->id;
+
+    return job;
+}
+
+
+bool job_is_chunk(const Job* job) {
+    return job->names != NULL;
+}
+
+
+bool job_add_name(Job* job, const char* name) {
+    int length = strlen(name) + 1;
+
+    if (job->name_count == JOB_CHUNK_ENTRIES || 
+            job->names_used + length > JOB_CHUNK_BYTES) {
+        return false;
+    }
+
+    memcpy(&job->names[job->names_used], name, length);
+    job->names_used += length;
+    job->name_count++;
+
+    return true;
+}
+
+
+void job_add_usage(Job* job, const Usage* usage) {
+    atomic_fetch_add_explicit(&job->subtree.blocks, usage->blocks, 
+                                memory_order_relaxed);
+    atomic_fetch_add_explicit(&job->subtree.bytes, usage->bytes, 
+                                memory_order_relaxed);
+    atomic_fetch_add_explicit(&job->subtree.inodes, usage->inodes, 
+                                memory_order_relaxed);
+}
+
+
+char* job_get_path(const Job* job, const char* name, void* in_use_data) {
+    size_t length = name != NULL ? strlen(name) + 1 : 0;
+
+    for (const Job* j = job ; j != NULL ; j = j->parent_job) {
+        if (j->name != NULL) {
+            length += strlen(j->name) + 1;
+        }
+    }
+
+    char* path = safe_malloc(length, in_use_data);
+    size_t end = length - 1;
+
+    path[end] = '\0';
+
+    if (name != NULL) {
+        end -= strlen(name);
+        memcpy(&path[end], name, strlen(name));
+    }
+
+    for (const Job* j = job ; j != NULL ; j = j->parent_job) {
+        if (j->name != NULL) {
+            size_t name_length = strlen(j->name);
+
+            /* Only the path of a root may end in a slash. */
+            if (path[end] != '\0' && j->name[name_length - 1] != '/') {
+                path[--end] = '/';
+            }
+
+            end -= name_length;
+            memcpy(&path[end], j->name, name_length);
+        }
+    }
+
+    if (end > 0) {
+        memmove(path, &path[end], length - end);
+    }
+
+    return path;
+}
+
+
+DIR* job_open_directory(Job* job, Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    DIR* directory;
+
+    if (job->parent != NULL) {
+        directory = open_directory_at(dirfd(job->parent->directory), job->name);
+
+        if (directory != NULL) {
+            dir_handle_release(job->parent, thread_context);
+            job->parent = NULL;
+        }
+
+    } else if (job->parent_job == NULL) {
+        directory = open_directory_at(AT_FDCWD, job->name);
+
+    } else {
+        char* path = job_get_path(job, NULL, thread_context);
+
+        directory = open_directory_at(AT_FDCWD, path);
+        free(path);
+    }
+
+    if (directory == NULL) {
+        int error = errno;
+        char* path = job_get_path(job, NULL, thread_context);
+
+        report_error(thread_context, &worker->errors, 
+                        "du: cannot read directory '%s': %s\n", path, 
+                        strerror(error));
+        free(path);
+    }
+
+    return directory;
+}
+
+
+bool job_stat_directory(Job* job, DIR* directory, struct stat* buff,
+                            Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    int result;
+
+    if (directory != NULL) {
+        result = fstat(dirfd(directory), buff);
+
+    } else if (job->parent != NULL) {
+        result = fstatat(dirfd(job->parent->directory), job->name, buff,
+                            AT_SYMLINK_NOFOLLOW);
+
+    } else {
+        char* path = job_get_path(job, NULL, thread_context);
+
+        result = fstatat(AT_FDCWD, path, buff, AT_SYMLINK_NOFOLLOW);
+        free(path);
+    }
+
+    if (result == -1) {
+        int error = errno;
+        char* path = job_get_path(job, NULL, thread_context);
+
+        report_error(thread_context, &worker->errors, 
+                        "du: cannot access '%s': %s\n", path, strerror(error));
+        free(path);
+
+        return false;
+    }
+
+    return true;
+}
+
+
+void job_release(Job* job, Worker* worker) {
+    while (job != NULL && atomic_fetch_sub_explicit(&job->refs, 1, 
+                            memory_order_acq_rel) == 1) {
+        Job* parent_job = job->parent_job;
+
+        if (worker->thread_context->track_subtrees) {
+            complete_job(job, worker);
+        }
+
+        if (job->parent != NULL) {
+            dir_handle_release(job->parent, worker->thread_context);
+        }
+
+        free(job->names);
+        arena_free(job->name);
+        return_to_pool(job, worker);
+
+        job = parent_job;
+    }
+}
+
+
+void job_pool_destroy(Worker* worker) {
+    while (worker->free_jobs != NULL) {
+        Job* job = worker->free_jobs;
+
+        worker->free_jobs = job->next;
+        free(job);
+    }
+
+    worker->free_job_count = 0;
+}
+
+
+DirHandle* dir_handle_create(DIR* directory, ThreadContext* thread_context) {
+    if (atomic_fetch_add(&thread_context->open_handles, 1) >=
+            thread_context->max_open_handles) {
+        atomic_fetch_sub(&thread_context->open_handles, 1);
+        return NULL;
+    }
+
+    DirHandle* handle = safe_malloc(sizeof(DirHandle), thread_context);
+
+    handle->directory = directory;
+    atomic_init(&handle->refs, 1);
+
+    return handle;
+}
+
+
+void dir_handle_retain(DirHandle* handle) {
+    atomic_fetch_add_explicit(&handle->refs, 1, memory_order_relaxed);
+}
+
+
+void dir_handle_release(DirHandle* handle, ThreadContext* thread_context) {
+    if (atomic_fetch_sub_explicit(&handle->refs, 1, memory_order_acq_rel) == 1) {
+        closedir(handle->directory);
+        free(handle);
+
+        atomic_fetch_sub(&thread_context->open_handles, 1);
+    }
+}
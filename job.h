@@ -0,0 +1,277 @@
+/**
+ * @defgroup module_job Job
+ *
+ * @file job.h
+ * @brief This module implements the datatype Job.
+ *
+ * A job is the unit of work handed between the worker threads, one job is
+ * one directory to traverse. A job is opened relative to the open directory
+ * of its parent with `openat`, so the kernel does not have to resolve the
+ * full path again. The parent directory is shared between its children
+ * through a reference counted DirHandle and is closed when the last child
+ * has opened its directory.
+ *
+ * A job may also be a chunk of the entry's of a huge directory, so the
+ * entry's can be stat'ed by several workers in parallel. A chunk holds the
+ * names of its entry's and a reference to the open directory they are in.
+ *
+ * Jobs are allocated from a pool of the worker creating them and returned 
+ * to the pool of the worker destroying them, their paths are allocated from 
+ * the arena of the worker.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef JOB_H
+#define JOB_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <dirent.h>
+
+#include "thread_context.h"
+
+#define JOB_CHUNK_ENTRIES 4096
+#define JOB_CHUNK_BYTES (64 * 1024)
+#define JOB_POOL_SIZE 1024
+
+/**
+ * @struct DirHandle
+ *
+ * @brief Type for a reference counted open directory.
+*/
+typedef struct dir_handle {
+    DIR* directory;
+    atomic_int refs;
+} DirHandle;
+
+/**
+ * @brief The usage of a sub tree, added to by several workers.
+*/
+struct job_usage {
+    _Atomic uint64_t blocks;
+    _Atomic uint64_t bytes;
+    _Atomic uint64_t inodes;
+};
+
+/**
+ * @struct Job
+ *
+ * @brief Type for a directory job.
+ *
+ * Contains the name of the directory within its parent, a reference to the 
+ * job of the parent directory and `root`, the index of the coordinator of 
+ * the directory tree the directory belongs to. A root job has no parent job and its name is the 
+ * path given as an argument. The full path is only rebuilt from the chain 
+ * of parent jobs when it is needed, so a job holding one reference to its 
+ * parent keeps the whole chain alive. If `parent` is NULL, the directory is 
+ * opened by its rebuilt path. If `count_self` is set, the size of the 
+ * directory itself has not been counted by its parent and is counted by 
+ * the job.
+ * 
+ * For a chunk, `name` is NULL, `parent_job` is the job of the directory, 
+ * `names` holds `name_count` null terminated names back to back and 
+ * `parent` is the directory they are in. `next` links the free jobs in the 
+ * pool of a worker.
+ * 
+ * When every directory is reported, `subtree` collects the usage of the 
+ * directory and of its completed sub directory's. A job is complete when its 
+ * last reference is released, which happens after all jobs below it are 
+ * complete. Its total is then reported and added to its parent job. `depth` 
+ * is the number of levels below the root, a chunk has the depth of its 
+ * directory. `id` identifies the directory in the binary output, a chunk has 
+ * the id of its directory. `self` is the usage of the directory itself if it is part of 
+ * `subtree`. If `has_record` is set, the job writes `record` to the scan 
+ * cache when it is complete. `device` is the device the directory is on if 
+ * the workers are limited per device; else NULL. `prefetch_ticket` is the 
+ * ticket of the directory at the prefetcher or zero, see `Prefetcher`.
+*/
+typedef struct job {
+    struct job* next;
+    struct job* parent_job;
+    atomic_int refs;
+
+    char* name;
+    DirHandle* parent;
+    bool count_self;
+    int root;
+    int depth;
+    uint64_t id;
+    struct job_usage subtree;
+    Usage self;
+    Device* device;
+    uint64_t prefetch_ticket;
+
+    bool has_record;
+    struct scan_cache_record record;
+
+    char* names;
+    int name_count;
+    int names_used;
+} Job;
+
+/**
+ * @brief Creates a new job with one reference.
+ *
+ * @param name String of the directory's name allocated from the arena of a 
+ * worker, the job takes ownership of it.
+ * @param parent_job The job of the parent directory or NULL for a root, the 
+ * job takes a reference of it.
+ * @param parent The open parent directory or NULL, the job takes over one
+ * reference of it.
+ * @param root The index of the coordinator for the directory.
+ * @param worker A pointer to the worker creating the job.
+ * @return A pointer to the newly created job.
+ *
+ * @note The returned job must be released using the `job_release` function
+ *       when it is no longer needed to prevent memory leaks.
+ * @see job_release()
+*/
+Job* job_create(char* name, Job* parent_job, DirHandle* parent, int root, 
+                    Worker* worker);
+
+/**
+ * @brief Creates a new chunk of the entry's in an open directory.
+ *
+ * @param directory_job The job of the directory, the chunk takes a 
+ * reference of it.
+ * @param directory The open directory, the chunk takes over one reference
+ * of it.
+ * @param worker A pointer to the worker creating the chunk.
+ * @return A pointer to the newly created chunk.
+ *
+ * @note The returned chunk must be released using the `job_release` 
+ *       function when it is no longer needed to prevent memory leaks.
+ * @see job_release()
+*/
+Job* job_create_chunk(Job* directory_job, DirHandle* directory, Worker* worker);
+
+/**
+ * @brief Checks if the job is a chunk.
+ *
+ * @param job Pointer to the job.
+ * @return Returns true if the job is a chunk; else false.
+*/
+bool job_is_chunk(const Job* job);
+
+/**
+ * @brief Adds a name to a chunk.
+ *
+ * @param job Pointer to the chunk.
+ * @param name String of the entry's name.
+ * @return Returns true if the name was added; else false if the chunk is full.
+*/
+bool job_add_name(Job* job, const char* name);
+
+/**
+ * @brief Adds usage to the sub tree of the job.
+ *
+ * May be called by any thread holding a reference to the job.
+ *
+ * @param job Pointer to the job.
+ * @param usage Pointer to the usage to add.
+*/
+void job_add_usage(Job* job, const Usage* usage);
+
+/**
+ * @brief Rebuilds the full path of the job from the chain of parent jobs.
+ *
+ * @param job Pointer to the job.
+ * @param name String of an entry's name to append to the path or NULL.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the path in dynamically allocated memory.
+ *
+ * @note The caller is responsible for deallocating the returned pointer.
+*/
+char* job_get_path(const Job* job, const char* name, void* in_use_data);
+
+/**
+ * @brief Opens the directory of the job.
+ *
+ * The directory is opened relative to its parent if the job has one, on
+ * success the reference to the parent is then released. On failure an error 
+ * with the rebuilt path is reported by the worker.
+ *
+ * @param job Pointer to the job.
+ * @param worker A pointer to the worker processing the job.
+ * @return On success it returns the DIR pointer of the opened
+ * directory; else NULL.
+*/
+DIR* job_open_directory(Job* job, Worker* worker);
+
+/**
+ * @brief Stats the directory of the job.
+ *
+ * The open directory is stat'ed if there is one; else the directory is
+ * stat'ed relative to its parent or by its rebuilt path. On failure an 
+ * error with the rebuilt path is reported by the worker.
+ *
+ * @param job Pointer to the job.
+ * @param directory The open directory of the job or NULL.
+ * @param buff The the struct to store the created stat struct in.
+ * @param worker A pointer to the worker processing the job.
+ * @return Returns true on success; else false.
+*/
+bool job_stat_directory(Job* job, DIR* directory, struct stat* buff,
+                            Worker* worker);
+
+/**
+ * @brief Releases one reference of the job.
+ *
+ * When the last reference is released the job is complete. If every 
+ * directory is reported, the total of the job is reported and added to its 
+ * parent job. The name of the job is then deallocated, the job is returned 
+ * to the pool of the worker and its parent job is released in turn.
+ *
+ * @param job Pointer to the job.
+ * @param worker A pointer to the worker releasing the job.
+*/
+void job_release(Job* job, Worker* worker);
+
+/**
+ * @brief Deallocates the jobs in the pool of a worker.
+ *
+ * @param worker A pointer to the worker.
+*/
+void job_pool_destroy(Worker* worker);
+
+/**
+ * @brief Wraps an open directory in a handle that can be shared.
+ *
+ * Returns NULL if too many directory's are already held open, the caller
+ * then keeps ownership of `directory`.
+ *
+ * @param directory The open directory.
+ * @param thread_context A pointer to the thread context struct.
+ * @return Returns the handle with one reference; else NULL.
+*/
+DirHandle* dir_handle_create(DIR* directory, ThreadContext* thread_context);
+
+/**
+ * @brief Takes one more reference of the handle.
+ *
+ * @param handle Pointer to the handle.
+*/
+void dir_handle_retain(DirHandle* handle);
+
+/**
+ * @brief Releases one reference of the handle.
+ *
+ * The directory is closed when the last reference is released.
+ *
+ * @param handle Pointer to the handle.
+ * @param thread_context A pointer to the thread context struct.
+*/
+void dir_handle_release(DirHandle* handle, ThreadContext* thread_context);
+
+#endif /* JOB_H */
+
+/**
+ * }
+*/
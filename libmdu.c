@@ -0,0 +1,775 @@
+/*
+ * @brief The library runs the scans of mdu within another program.
+ *
+ * Each scan has a thread context of its own with one worker for every
+ * thread of the pool and one for its caller, so a scan may use the whole
+ * pool. The pool shares its threads out by lowering the thread limit of
+ * the scans, and a worker above the limit of an embedded scan returns from
+ * `thread_handler()`, which frees its thread for another scan. The types
+ * of the public header are defined here, so an embedding program never
+ * sees the internal ones.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "libmdu.h"
+#include "options.h"
+#include "thread_context.h"
+#include "dir_buffer.h"
+#include "scan.h"
+
+#define ROOT_FILE -1
+#define ROOT_NONE -2
+
+/*
+ * @brief A scan running on the pool.
+ *
+ * `claimed` tells for each worker if a thread runs it, `running` is the
+ * number of threads of the pool running a worker of the scan.
+*/
+struct mdu_pool_scan {
+    ThreadContext* thread_context;
+    bool* claimed;
+    int running;
+    struct mdu_pool_scan* next;
+};
+
+/*
+ * @brief The pool of threads.
+ *
+ * `scans` links the `scan_num` running scans. A thread of the pool waits
+ * on `cond_scan` until a scan has a worker below its thread limit that no
+ * thread runs. A scan that is done waits on `cond_done` until no thread of
+ * the pool runs any of its workers. All fields are guarded by `mutex`.
+*/
+struct mdu_pool {
+    pthread_t* threads;
+    int thread_num;
+
+    struct mdu_pool_scan* scans;
+    int scan_num;
+    bool stop;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond_scan;
+    pthread_cond_t cond_done;
+};
+
+/*
+ * @brief The options of a scan.
+ *
+ * The strings the options point to are copies owned by them, they are
+ * freed by `mdu_options_destroy()`.
+*/
+struct mdu_options {
+    Options options;
+};
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief The state of a call to `mdu_scan()`.
+ *
+ * `roots` holds the index of the coordinator of each path, `ROOT_FILE` if
+ * the path is not a directory or `ROOT_NONE` if it cannot be stat'ed.
+ * `files` holds the stat struct of each path.
+*/
+struct scan_state {
+    MduPool* pool;
+    const char* const* paths;
+    int path_num;
+    const Options* options;
+    const MduCallbacks* callbacks;
+    MduUsage* totals;
+
+    ThreadContext* thread_context;
+    struct stat* files;
+    int* roots;
+    struct mdu_pool_scan scan;
+    MduStatus status;
+};
+
+/*
+ * @brief Hands the total of a directory to the directory callback.
+ *
+ * @param path String of the directory's path.
+ * @param usage The usage of the directory and everything below it.
+ * @param depth The number of levels below its path.
+ * @param data Pointer to the callbacks.
+*/
+static void forward_directory(const char* path, const Usage* usage, int depth,
+                                void* data) {
+    const MduCallbacks* callbacks = data;
+    MduUsage total = {
+        .blocks = usage->blocks,
+        .bytes = usage->bytes,
+        .inodes = usage->inodes
+    };
+
+    callbacks->directory(path, &total, depth, callbacks->data);
+}
+
+/*
+ * @brief Hands the message of an error to the error callback.
+ *
+ * @param message String of the message.
+ * @param data Pointer to the callbacks.
+*/
+static void forward_error(const char* message, void* data) {
+    const MduCallbacks* callbacks = data;
+
+    callbacks->error(message, callbacks->data);
+}
+
+/*
+ * @brief Copies a string.
+ *
+ * @param source The string or NULL.
+ * @param copy Set to the copy, or NULL if `source` is NULL.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_NOMEM`.
+*/
+static MduStatus copy_string(const char* source, const char** copy) {
+    char* string = NULL;
+
+    if (source != NULL) {
+        if ((string = malloc(strlen(source) + 1)) == NULL) {
+            return MDU_ERROR_NOMEM;
+        }
+
+        strcpy(string, source);
+    }
+
+    free((char*) *copy);
+    *copy = string;
+
+    return MDU_OK;
+}
+
+/*
+ * @brief Adds a copy of a string to a list of strings.
+ *
+ * @param list Pointer to the list or NULL.
+ * @param num Pointer to the number of strings of the list.
+ * @param source The string.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_NOMEM`.
+*/
+static MduStatus add_string(const char*** list, int* num, const char* source) {
+    const char** strings = realloc(*list, (*num + 1) * sizeof(char*));
+
+    if (strings == NULL) {
+        return MDU_ERROR_NOMEM;
+    }
+
+    *list = strings;
+    strings[*num] = NULL;
+
+    if (copy_string(source, &strings[*num]) != MDU_OK) {
+        return MDU_ERROR_NOMEM;
+    }
+
+    (*num)++;
+
+    return MDU_OK;
+}
+
+/*
+ * @brief Deallocates a list of strings.
+ *
+ * @param list The list or NULL.
+ * @param num The number of strings of the list.
+*/
+static void free_strings(const char** list, int num) {
+    for (int i = 0 ; i < num ; i++) {
+        free((char*) list[i]);
+    }
+
+    free(list);
+}
+
+/*
+ * @brief Wakes the idle workers of a scan, so the ones above the thread
+ * limit leave it.
+ *
+ * @param thread_context A pointer to the thread context of the scan.
+*/
+static void wake_workers(ThreadContext* thread_context) {
+    pthread_mutex_lock(&thread_context->mutex_work);
+    pthread_cond_broadcast(&thread_context->cond_work);
+    pthread_mutex_unlock(&thread_context->mutex_work);
+}
+
+/*
+ * @brief Shares the threads of the pool out over the running scans.
+ *
+ * Each scan gets an even share on top of its caller, the first scans get
+ * one more for the threads that are left.
+ *
+ * @param pool Pointer to the pool, its mutex must be held.
+*/
+static void share_threads(MduPool* pool) {
+    int index = 0;
+
+    for (struct mdu_pool_scan* scan = pool->scans ; scan != NULL ;
+            scan = scan->next) {
+        int share = pool->thread_num / pool->scan_num +
+                    (index < pool->thread_num % pool->scan_num ? 1 : 0);
+
+        atomic_store(&scan->thread_context->thread_limit, share + 1);
+        wake_workers(scan->thread_context);
+        index++;
+    }
+
+    pthread_cond_broadcast(&pool->cond_scan);
+}
+
+/*
+ * @brief Finds a worker for a thread of the pool.
+ *
+ * The worker is taken from the scan with the fewest threads of the pool,
+ * among the scans with work pending and a free worker below their thread
+ * limit.
+ *
+ * @param pool Pointer to the pool, its mutex must be held.
+ * @param worker_id Set to the id of the worker.
+ * @return Returns the scan of the worker; else NULL if there is none.
+*/
+static struct mdu_pool_scan* find_worker(MduPool* pool, int* worker_id) {
+    struct mdu_pool_scan* best = NULL;
+
+    for (struct mdu_pool_scan* scan = pool->scans ; scan != NULL ;
+            scan = scan->next) {
+        ThreadContext* thread_context = scan->thread_context;
+
+        if (scan->running + 1 >= atomic_load(&thread_context->thread_limit) ||
+                atomic_load(&thread_context->pending_jobs) == 0) {
+            continue;
+        }
+
+        if (best == NULL || scan->running < best->running) {
+            best = scan;
+        }
+    }
+
+    if (best == NULL) {
+        return NULL;
+    }
+
+    int limit = atomic_load(&best->thread_context->thread_limit);
+
+    for (int i = 1 ; i < limit ; i++) {
+        if (!best->claimed[i]) {
+            *worker_id = i;
+            return best;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * @brief The thread of a pool.
+ *
+ * @param arg Pointer to the pool.
+ * @return Returns NULL.
+*/
+static void* pool_thread(void* arg) {
+    MduPool* pool = arg;
+    struct mdu_pool_scan* scan;
+    int worker_id;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (true) {
+        while (!pool->stop && (scan = find_worker(pool, &worker_id)) == NULL) {
+            pthread_cond_wait(&pool->cond_scan, &pool->mutex);
+        }
+
+        if (pool->stop) {
+            break;
+        }
+
+        scan->claimed[worker_id] = true;
+        scan->running++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        free(thread_handler(scan->thread_context->workers[worker_id]));
+
+        pthread_mutex_lock(&pool->mutex);
+        scan->claimed[worker_id] = false;
+        scan->running--;
+
+        if (scan->running == 0) {
+            pthread_cond_broadcast(&pool->cond_done);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+/*
+ * @brief Checks if the options can be used together by a scan.
+ *
+ * The directory callback is not supported with `trust_mtime`, since the
+ * cache holds no totals of the directory's below a skipped directory, and
+ * neither is `dedup_links`, since the hard links below it are not seen.
+ *
+ * @param options Pointer to the options.
+ * @param callbacks Pointer to the callbacks or NULL.
+ * @return Returns true if they can; else false.
+*/
+static bool is_supported(const Options* options,
+                            const MduCallbacks* callbacks) {
+    return !options->trust_mtime || (!options->dedup_links && 
+            (callbacks == NULL || callbacks->directory == NULL));
+}
+
+/*
+ * @brief Runs a step of a scan with a recovery point set, so a failed
+ * allocation ends the step instead of the program.
+ *
+ * @param step The step to run.
+ * @param state Pointer to the state of the scan.
+ * @return Returns true if the step was run; else false if an allocation
+ * failed, the status is then `MDU_ERROR_NOMEM`.
+*/
+static bool run_step(void (*step)(struct scan_state*),
+                        struct scan_state* state) {
+    jmp_buf recovery;
+
+    if (setjmp(recovery) != 0) {
+        safe_set_recovery(NULL);
+        state->status = MDU_ERROR_NOMEM;
+
+        return false;
+    }
+
+    safe_set_recovery(&recovery);
+    step(state);
+    safe_set_recovery(NULL);
+
+    return true;
+}
+
+/*
+ * @brief Creates the thread context and the workers of a scan and
+ * processes its paths.
+ *
+ * Each scan may hold open its share of the directory's of the pool, so the
+ * scans running at once do not run out of file descriptors.
+ *
+ * @param state Pointer to the state of the scan.
+*/
+static void set_up_scan(struct scan_state* state) {
+    int worker_num = state->pool->thread_num + 1;
+    ThreadContext* thread_context = create_thread_context();
+
+    state->thread_context = thread_context;
+    thread_context->options = *state->options;
+    thread_context->options.thread_num = state->pool->thread_num;
+    thread_context->options.breakdown = false;
+    thread_context->options.top = 0;
+    thread_context->embedded = true;
+
+    if (state->callbacks != NULL) {
+        if (state->callbacks->directory != NULL) {
+            thread_context->directory_callback = &forward_directory;
+            thread_context->track_subtrees = true;
+        }
+
+        if (state->callbacks->error != NULL) {
+            thread_context->error_callback = &forward_error;
+        }
+
+        thread_context->callback_data = (void*) state->callbacks;
+    }
+
+    pthread_mutex_lock(&state->pool->mutex);
+    thread_context->max_open_handles /= state->pool->scan_num + 1;
+    pthread_mutex_unlock(&state->pool->mutex);
+
+    state->files = safe_malloc(state->path_num * sizeof(struct stat),
+                                thread_context);
+    state->roots = safe_malloc(state->path_num * sizeof(int), thread_context);
+
+    if (!scan_prepare(thread_context)) {
+        state->status = MDU_ERROR_INVALID;
+        return;
+    }
+
+    for (int i = 0 ; i < state->path_num ; i++) {
+        if (!process_argument(state->paths[i], &state->files[i],
+                                thread_context)) {
+            state->roots[i] = ROOT_NONE;
+
+        } else if (is_dictionary(state->files[i])) {
+            state->roots[i] = thread_context->dir_num - 1;
+
+        } else {
+            state->roots[i] = ROOT_FILE;
+        }
+    }
+
+    if (!scan_start(thread_context, worker_num)) {
+        state->status = MDU_ERROR_INVALID;
+        return;
+    }
+
+    state->scan.thread_context = thread_context;
+    state->scan.claimed = safe_calloc(worker_num, sizeof(bool),
+                                        thread_context);
+    state->scan.running = 0;
+    state->scan.next = NULL;
+
+    push_root_jobs(thread_context);
+}
+
+/*
+ * @brief Runs a scan on the pool and on the calling thread.
+ *
+ * @param state Pointer to the state of the scan.
+*/
+static void run_scan(struct scan_state* state) {
+    MduPool* pool = state->pool;
+    ThreadContext* thread_context = state->thread_context;
+
+    pthread_mutex_lock(&pool->mutex);
+    state->scan.next = pool->scans;
+    pool->scans = &state->scan;
+    pool->scan_num++;
+    share_threads(pool);
+    pthread_mutex_unlock(&pool->mutex);
+
+    free(thread_handler(thread_context->workers[0]));
+
+    pthread_mutex_lock(&pool->mutex);
+    struct mdu_pool_scan** link = &pool->scans;
+
+    while (*link != &state->scan) {
+        link = &(*link)->next;
+    }
+
+    *link = state->scan.next;
+    pool->scan_num--;
+
+    if (pool->scan_num > 0) {
+        share_threads(pool);
+    }
+
+    while (state->scan.running > 0) {
+        pthread_cond_wait(&pool->cond_done, &pool->mutex);
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    scan_finish(thread_context);
+}
+
+/*
+ * @brief Sets the total of every path and the status of a scan, and saves
+ * its scan cache.
+ *
+ * A scan whose worker failed to allocate memory has lost the totals of
+ * the jobs it gave up, so its status is `MDU_ERROR_NOMEM`.
+ *
+ * @param state Pointer to the state of the scan.
+*/
+static void collect_totals(struct scan_state* state) {
+    ThreadContext* thread_context = state->thread_context;
+
+    for (int i = 0 ; i < state->path_num ; i++) {
+        Usage usage = {0};
+
+        if (state->roots[i] >= 0) {
+            usage = thread_context->coordinator[state->roots[i]]->total;
+
+        } else if (state->roots[i] == ROOT_FILE &&
+                    is_counted(&state->files[i], thread_context)) {
+            usage_add_file(&usage, &state->files[i]);
+        }
+
+        state->totals[i] = (MduUsage) {
+            .blocks = usage.blocks,
+            .bytes = usage.bytes,
+            .inodes = usage.inodes
+        };
+    }
+
+    if (atomic_load(&thread_context->out_of_memory)) {
+        state->status = MDU_ERROR_NOMEM;
+
+    } else if (atomic_load(&thread_context->aborted)) {
+        state->status = MDU_ERROR_ABORTED;
+
+    } else if (error_count(thread_context) > 0) {
+        state->status = MDU_ERROR_ACCESS;
+    }
+
+    /* A cache of a scan with errors would hide the unread directory's. */
+    if (thread_context->cache != NULL && state->status == MDU_OK &&
+            !scan_cache_save(thread_context->cache, thread_context)) {
+        report_message(thread_context, "mdu: cannot write cache '%s': %s\n",
+                        state->options->cache_path, strerror(errno));
+        state->status = MDU_ERROR_ACCESS;
+    }
+}
+
+/*
+ * @brief Deallocates the state of a scan.
+ *
+ * The patterns of the options belong to the options of the caller, so
+ * they are not freed with the thread context.
+ *
+ * @param state Pointer to the state of the scan.
+*/
+static void destroy_state(struct scan_state* state) {
+    if (state->thread_context != NULL) {
+        state->thread_context->options.excludes = NULL;
+        state->thread_context->options.exclude_files = NULL;
+        thread_context_destroy(state->thread_context);
+    }
+
+    free(state->scan.claimed);
+    free(state->roots);
+    free(state->files);
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+MduPool* mdu_pool_create(int thread_num) {
+    MduPool* pool = malloc(sizeof(MduPool));
+
+    if (pool == NULL || thread_num < 0) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->threads = malloc((thread_num + 1) * sizeof(pthread_t));
+    pool->thread_num = 0;
+    pool->scans = NULL;
+    pool->scan_num = 0;
+    pool->stop = false;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond_scan, NULL);
+    pthread_cond_init(&pool->cond_done, NULL);
+
+    if (pool->threads == NULL) {
+        mdu_pool_destroy(pool);
+        return NULL;
+    }
+
+    /* `thread_num` only counts the started threads, they are joined. */
+    for (int i = 0 ; i < thread_num ; i++) {
+        if (pthread_create(&pool->threads[i], NULL, &pool_thread, pool) != 0) {
+            mdu_pool_destroy(pool);
+            return NULL;
+        }
+
+        pool->thread_num++;
+    }
+
+    return pool;
+}
+
+
+void mdu_pool_destroy(MduPool* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->cond_scan);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0 ; i < pool->thread_num ; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->cond_scan);
+    pthread_cond_destroy(&pool->cond_done);
+    free(pool->threads);
+    free(pool);
+}
+
+
+MduOptions* mdu_options_create(void) {
+    MduOptions* options = malloc(sizeof(MduOptions));
+
+    if (options != NULL) {
+        set_default_options(&options->options);
+    }
+
+    return options;
+}
+
+
+void mdu_options_destroy(MduOptions* options) {
+    if (options == NULL) {
+        return;
+    }
+
+    free((char*) options->options.cache_path);
+    free((char*) options->options.dev_jobs);
+    free_strings(options->options.excludes, options->options.exclude_num);
+    free_strings(options->options.exclude_files,
+                    options->options.exclude_file_num);
+    free(options);
+}
+
+
+MduStatus mdu_options_set_traversal(MduOptions* options, MduEngine engine,
+                                    MduReader reader, MduOrder order) {
+    static const Engine engines[] = {
+        [MDU_ENGINE_SYNC] = ENGINE_SYNC,
+        [MDU_ENGINE_BATCH] = ENGINE_BATCH,
+        [MDU_ENGINE_URING] = ENGINE_URING
+    };
+    static const Reader readers[] = {
+        [MDU_READER_READDIR] = READER_READDIR,
+        [MDU_READER_GETDENTS] = READER_GETDENTS
+    };
+    static const Order orders[] = {
+        [MDU_ORDER_HYBRID] = ORDER_HYBRID,
+        [MDU_ORDER_DFS] = ORDER_DFS,
+        [MDU_ORDER_BFS] = ORDER_BFS
+    };
+
+    if ((unsigned) engine > MDU_ENGINE_URING ||
+            (unsigned) reader > MDU_READER_GETDENTS ||
+            (unsigned) order > MDU_ORDER_BFS) {
+        return MDU_ERROR_INVALID;
+    }
+
+    options->options.engine = engines[engine];
+    options->options.reader = readers[reader];
+    options->options.order = orders[order];
+
+    return MDU_OK;
+}
+
+
+MduStatus mdu_options_set_limits(MduOptions* options,
+                                    size_t getdents_buffer_size,
+                                    long split_threshold) {
+    if (split_threshold < 0) {
+        return MDU_ERROR_INVALID;
+    }
+
+    if (getdents_buffer_size == 0) {
+        getdents_buffer_size = DIR_BUFFER_DEFAULT_SIZE;
+
+    } else if (getdents_buffer_size < DIR_BUFFER_MIN_SIZE) {
+        getdents_buffer_size = DIR_BUFFER_MIN_SIZE;
+    }
+
+    options->options.getdents_buffer_size = getdents_buffer_size;
+    options->options.split_threshold = split_threshold;
+
+    return MDU_OK;
+}
+
+
+MduStatus mdu_options_set_counting(MduOptions* options, bool dedup,
+                                    bool one_file_system,
+                                    MduErrorPolicy errors) {
+    if ((unsigned) errors > MDU_ERRORS_ABORT) {
+        return MDU_ERROR_INVALID;
+    }
+
+    options->options.dedup_links = dedup;
+    options->options.one_file_system = one_file_system;
+    options->options.errors = errors == MDU_ERRORS_ABORT ? ERRORS_ABORT :
+                                                            ERRORS_CONTINUE;
+
+    return MDU_OK;
+}
+
+
+void mdu_options_set_max_depth(MduOptions* options, long max_depth) {
+    options->options.max_depth = max_depth < 0 ? -1 : max_depth;
+}
+
+
+MduStatus mdu_options_set_cache(MduOptions* options, const char* path,
+                                bool trust_mtime) {
+    if (trust_mtime && path == NULL) {
+        return MDU_ERROR_INVALID;
+    }
+
+    if (copy_string(path, &options->options.cache_path) != MDU_OK) {
+        return MDU_ERROR_NOMEM;
+    }
+
+    options->options.trust_mtime = trust_mtime;
+
+    return MDU_OK;
+}
+
+
+MduStatus mdu_options_set_dev_jobs(MduOptions* options, const char* spec) {
+    return copy_string(spec, &options->options.dev_jobs);
+}
+
+
+MduStatus mdu_options_add_exclude(MduOptions* options, const char* pattern) {
+    return add_string(&options->options.excludes,
+                        &options->options.exclude_num, pattern);
+}
+
+
+MduStatus mdu_options_add_exclude_file(MduOptions* options, const char* path) {
+    return add_string(&options->options.exclude_files,
+                        &options->options.exclude_file_num, path);
+}
+
+
+MduStatus mdu_options_set_prefetch(MduOptions* options, long prefetch) {
+    if (prefetch < 0) {
+        return MDU_ERROR_INVALID;
+    }
+
+    options->options.prefetch = prefetch;
+
+    return MDU_OK;
+}
+
+
+MduStatus mdu_scan(MduPool* pool, const char* const* paths, int path_num,
+                    const MduOptions* options, const MduCallbacks* callbacks,
+                    MduUsage* totals) {
+    if (pool == NULL || paths == NULL || path_num <= 0 || options == NULL ||
+            totals == NULL || !is_supported(&options->options, callbacks)) {
+        return MDU_ERROR_INVALID;
+    }
+
+    struct scan_state state = {
+        .pool = pool,
+        .paths = paths,
+        .path_num = path_num,
+        .options = &options->options,
+        .callbacks = callbacks,
+        .totals = totals,
+        .thread_context = NULL,
+        .files = NULL,
+        .roots = NULL,
+        .scan = {0},
+        .status = MDU_OK
+    };
+
+    if (run_step(&set_up_scan, &state) && state.status == MDU_OK) {
+        run_scan(&state);
+        run_step(&collect_totals, &state);
+    }
+
+    destroy_state(&state);
+
+    return state.status;
+}
@@ -0,0 +1,307 @@
+/**
+ * @defgroup module_libmdu libmdu
+ *
+ * @file libmdu.h
+ * @brief The library runs the scans of mdu within another program.
+ *
+ * A pool of threads is created once by `mdu_pool_create()`, and
+ * `mdu_scan()` scans a set of paths on it and returns the 64-bit total of
+ * each path. Several threads may run scans on the same pool at once. The
+ * threads of the pool are then spread evenly over the running scans, a
+ * thread leaves a scan for a newly started one once it finishes its
+ * current directory. The thread calling `mdu_scan()` runs a worker of the
+ * scan itself, so a scan makes progress even while every thread of the
+ * pool is busy.
+ *
+ * The options of a scan are created by `mdu_options_create()` with the
+ * defaults of the command line and changed by the `mdu_options_set_*()`
+ * functions, each of them stands for the flag of the same name. The
+ * options that print, start threads or processes of their own or place
+ * the threads have no setter. `trust_mtime` cannot be used together with
+ * `dedup` or a directory callback. `prefetch` is the exception, it starts
+ * its thread for each scan.
+ *
+ * Errors never end the program. The errors of the files and the messages
+ * of a scan that cannot be set up or whose cache cannot be written are
+ * handed to the error callback and reflected in the status of the scan. A
+ * failed allocation returns `MDU_ERROR_NOMEM`, a worker whose allocation
+ * fails aborts the scan.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef LIBMDU_H
+#define LIBMDU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The status of a scan.
+ *
+ * `MDU_ERROR_ACCESS` is returned if a file could not be read, the totals
+ * then leave it out, or the cache could not be written.
+ * `MDU_ERROR_ABORTED` is returned if a scan with `MDU_ERRORS_ABORT` stopped
+ * at its first error, and `MDU_ERROR_INVALID` if the options or arguments
+ * are not supported or invalid.
+*/
+typedef enum {
+    MDU_OK = 0,
+    MDU_ERROR_ACCESS,
+    MDU_ERROR_ABORTED,
+    MDU_ERROR_INVALID,
+    MDU_ERROR_NOMEM
+} MduStatus;
+
+/**
+ * @brief The engines of `--engine`.
+*/
+typedef enum {
+    MDU_ENGINE_SYNC,
+    MDU_ENGINE_BATCH,
+    MDU_ENGINE_URING
+} MduEngine;
+
+/**
+ * @brief The readers of `--reader`.
+*/
+typedef enum {
+    MDU_READER_READDIR,
+    MDU_READER_GETDENTS
+} MduReader;
+
+/**
+ * @brief The orders of `--order`.
+*/
+typedef enum {
+    MDU_ORDER_HYBRID,
+    MDU_ORDER_DFS,
+    MDU_ORDER_BFS
+} MduOrder;
+
+/**
+ * @brief The policies of `--errors`.
+*/
+typedef enum {
+    MDU_ERRORS_CONTINUE,
+    MDU_ERRORS_ABORT
+} MduErrorPolicy;
+
+/**
+ * @struct MduUsage
+ *
+ * @brief Type for the disk usage of a set of files.
+ *
+ * Contains the number of 512 byte blocks, the apparent size in bytes and
+ * the number of inodes.
+*/
+typedef struct {
+    uint64_t blocks;
+    uint64_t bytes;
+    uint64_t inodes;
+} MduUsage;
+
+/**
+ * @brief Receives the total of a directory once its sub tree is done.
+ *
+ * @param path String of the directory's path.
+ * @param usage The usage of the directory and everything below it.
+ * @param depth The number of levels below its path.
+ * @param data The data of the callbacks.
+*/
+typedef void (*MduDirectoryCallback)(const char* path, const MduUsage* usage,
+                                        int depth, void* data);
+
+/**
+ * @brief Receives the message of an error, without a trailing newline.
+ *
+ * @param message String of the message.
+ * @param data The data of the callbacks.
+*/
+typedef void (*MduErrorCallback)(const char* message, void* data);
+
+/**
+ * @brief The callbacks of a scan, each may be NULL.
+ *
+ * `directory` receives the total of every directory, `error` the message
+ * of every error. They are called from the threads of the pool, several
+ * at once, with `data`.
+*/
+typedef struct {
+    MduDirectoryCallback directory;
+    MduErrorCallback error;
+    void* data;
+} MduCallbacks;
+
+/**
+ * @brief Type for the pool of threads.
+*/
+typedef struct mdu_pool MduPool;
+
+/**
+ * @brief Type for the options of a scan.
+*/
+typedef struct mdu_options MduOptions;
+
+/**
+ * @brief Creates a pool and starts its threads.
+ *
+ * @param thread_num The number of threads, zero runs every scan on the
+ * thread calling `mdu_scan()` only.
+ * @return Returns the pool; else NULL if the memory or the threads cannot
+ * be allocated.
+ *
+ * @note The pool is stopped and deallocated by `mdu_pool_destroy()`.
+*/
+MduPool* mdu_pool_create(int thread_num);
+
+/**
+ * @brief Stops the threads of a pool and deallocates it.
+ *
+ * @param pool Pointer to the pool or NULL, no scan may be running on it.
+*/
+void mdu_pool_destroy(MduPool* pool);
+
+/**
+ * @brief Creates options set to the defaults of the command line.
+ *
+ * @return Returns the options; else NULL if the memory cannot be
+ * allocated.
+ *
+ * @note The options are deallocated by `mdu_options_destroy()`.
+*/
+MduOptions* mdu_options_create(void);
+
+/**
+ * @brief Deallocates options.
+ *
+ * @param options Pointer to the options or NULL.
+*/
+void mdu_options_destroy(MduOptions* options);
+
+/**
+ * @brief Sets the engine, the reader and the order of the workers.
+ *
+ * @param options Pointer to the options.
+ * @param engine The engine of `--engine`.
+ * @param reader The reader of `--reader`.
+ * @param order The order of `--order`.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_INVALID` if a value is not
+ * known.
+*/
+MduStatus mdu_options_set_traversal(MduOptions* options, MduEngine engine,
+                                    MduReader reader, MduOrder order);
+
+/**
+ * @brief Sets the size of the buffer of `--getdents-buffer` and the entry
+ * count of `--split-threshold`.
+ *
+ * @param options Pointer to the options.
+ * @param getdents_buffer_size The size in bytes, zero keeps the default. A
+ * smaller size than the command line allows is raised to it.
+ * @param split_threshold The entry count, zero never splits.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_INVALID` if the count is
+ * negative.
+*/
+MduStatus mdu_options_set_limits(MduOptions* options,
+                                    size_t getdents_buffer_size,
+                                    long split_threshold);
+
+/**
+ * @brief Sets `--dedup`, `-x` and `--errors`.
+ *
+ * @param options Pointer to the options.
+ * @param dedup If hard links are only counted once.
+ * @param one_file_system If directory's on other devices are skipped.
+ * @param errors The policy for a file that cannot be read.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_INVALID` if the policy is not
+ * known.
+*/
+MduStatus mdu_options_set_counting(MduOptions* options, bool dedup,
+                                    bool one_file_system,
+                                    MduErrorPolicy errors);
+
+/**
+ * @brief Sets the levels of `--max-depth` the directory callback receives.
+ *
+ * @param options Pointer to the options.
+ * @param max_depth The number of levels, negative for no limit.
+*/
+void mdu_options_set_max_depth(MduOptions* options, long max_depth);
+
+/**
+ * @brief Sets the scan cache of `--cache` and `--trust-mtime`.
+ *
+ * @param options Pointer to the options.
+ * @param path The path of the cache, it is copied, or NULL for none.
+ * @param trust_mtime If the unchanged directory's are not traversed.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_INVALID` if `trust_mtime` is
+ * set without a path or `MDU_ERROR_NOMEM`.
+*/
+MduStatus mdu_options_set_cache(MduOptions* options, const char* path,
+                                bool trust_mtime);
+
+/**
+ * @brief Sets the budgets of `--dev-jobs`.
+ *
+ * @param options Pointer to the options.
+ * @param spec The budgets, they are copied, or NULL for none.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_NOMEM`.
+*/
+MduStatus mdu_options_set_dev_jobs(MduOptions* options, const char* spec);
+
+/**
+ * @brief Adds a pattern of `--exclude`.
+ *
+ * @param options Pointer to the options.
+ * @param pattern The pattern, it is copied.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_NOMEM`.
+*/
+MduStatus mdu_options_add_exclude(MduOptions* options, const char* pattern);
+
+/**
+ * @brief Adds a file of patterns of `--exclude-from`.
+ *
+ * @param options Pointer to the options.
+ * @param path The path of the file, it is copied and read by each scan.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_NOMEM`.
+*/
+MduStatus mdu_options_add_exclude_file(MduOptions* options, const char* path);
+
+/**
+ * @brief Sets the directory's `--prefetch` opens ahead of the workers.
+ *
+ * @param options Pointer to the options.
+ * @param prefetch The number of directory's, zero for none.
+ * @return Returns `MDU_OK`; else `MDU_ERROR_INVALID` if it is negative.
+*/
+MduStatus mdu_options_set_prefetch(MduOptions* options, long prefetch);
+
+/**
+ * @brief Scans a set of paths on a pool.
+ *
+ * The paths are counted as the arguments of the command line are, a hard
+ * link of `dedup` is only counted in the first path it is seen in.
+ *
+ * @param pool Pointer to the pool.
+ * @param paths The paths to scan.
+ * @param path_num The number of paths, at least one.
+ * @param options Pointer to the options, they are copied.
+ * @param callbacks Pointer to the callbacks or NULL.
+ * @param totals Array of `path_num` usages, set to the total of each path
+ * unless the status is `MDU_ERROR_INVALID` or `MDU_ERROR_NOMEM`.
+ * @return Returns `MDU_OK` on success; else the status of the failure.
+*/
+MduStatus mdu_scan(MduPool* pool, const char* const* paths, int path_num,
+                    const MduOptions* options, const MduCallbacks* callbacks,
+                    MduUsage* totals);
+
+#endif /* LIBMDU_H */
+
+/**
+ * }
+*/
@@ -17,371 +17,301 @@
 /*-----------------------INTERNAL FUCTIONS-----------------------*/
 
 /*
- * @brief Returns the length of the path from `file_path` and `directory_path`.
+ * @brief Assigns a cpu and a NUMA node to every worker.
  * 
- * @param file_path String of a file path.
- * @param directory_path String of a directory path.
- * @return Returns the length of combined strings including the terminating 
- * character `\0`.
-*/
-static int get_path_length(const char* file_path, const char* directory_path) {
-    return strlen(file_path) + strlen(directory_path) + 2;
-}
-
-/*
- * @brief Checks if a path is the `.` or `..` directory's.
+ * If the cpus cannot be read, the workers are not pinned.
  * 
- * @param path String of a path.
- * @return Returns true if the path is either the `.` or `..` directory; 
- * else false.
+ * @param thread_context A pointer to the thread context struct containing the 
+ * workers.
 */
-static bool is_dot_or_dot_dot(char* path) {
-    return strcmp(path, ".") == 0 || strcmp(path, "..") == 0;
-}
+static void place_workers(ThreadContext* thread_context) {
+    thread_context->topology = topology_create(thread_context);
 
-/*
- * @brief Checks if a file is a directory.
- * 
- * @param file_info A stat strcut containing the information on a file.
- * @return Returns true if the file is a directory; else false.
-*/
-static bool is_dictionary(struct stat file_info) {
-    return (file_info.st_mode & S_IFMT) == S_IFDIR;
-}
+    if (thread_context->topology == NULL) {
+        fprintf(stderr, "mdu: cannot read the cpus, the threads are not pinned\n");
+        return;
+    }
 
-/*
- * @brief Checks if the index in `argv` is the flag or its argument.
- * input arguments.
- * 
- * @param i Index for argv
- * @return Returns true if it is the flag argument; else false.
-*/
-static bool is_flag_arg(int i) {
-    return i == (optind - 2) || i == optind - 1;
+    for (int i = 0 ; i < thread_context->worker_num ; i++) {
+        topology_assign(thread_context->topology, thread_context->workers[i], 
+                        thread_context->options.numa);
+    }
 }
 
 /*
- * @brief Checks that the the user entered atleast one argument.
- *
- * If no argument was given, the function will print out a message to stderr 
- * and exit the program.
+ * @brief Exits the program if the scan was aborted by an error.
  * 
- * @param argc The amount of arguments entered.
+ * The messages of every thread are written to stderr first, so it is only 
+ * called once the workers are joined.
+ * 
+ * @param thread_context A pointer to the thread context struct.
 */
-static void check_arguments(int argc) {
-    if (argc < 2) {
-        fprintf(stderr, "mdu -j {antal trådar} {fil} [filer ...]\n");
-        exit(EXIT_FAILURE);
+static void exit_if_aborted(ThreadContext* thread_context) {
+    if (!atomic_load(&thread_context->aborted)) {
+        return;
     }
+
+    flush_errors(thread_context);
+    thread_context_destroy(thread_context);
+    exit(EXIT_FAILURE);
 }
 
 /*
- * @brief Processes an argument from `argv`.
- * 
- * If the argument is a directory, it will create a new coordinator for the 
- * directory. In the new coordinator it will add the directory to its queue 
- * and update the total size of the directory.
+ * @brief Scans the arguments with the remote workers, prints the results 
+ * and exits the program.
  * 
- * @param index The Index for the argument in argv.
- * @param arg The argument to process.
+ * @param argc The amount of input arguments.
+ * @param argv The input arguments.
  * @param thread_context A pointer to the thread context struct containing the 
  * coordinators.
 */
-static void process_argument(int index , char* arg, 
-                                ThreadContext* thread_context) {
-    struct stat file_info;
+static void scan_remote(int argc, char* argv[], ThreadContext* thread_context) {
+    int exit_status = remote_scan(thread_context);
 
-    if (!is_flag_arg(index)) {
-        safe_lstat(arg, &file_info, thread_context);
+    exit_if_aborted(thread_context);
+    flush_errors(thread_context);
 
-        if (is_dictionary(file_info)) {
-            thread_context->dir_num++;
-            int dir_num = thread_context->dir_num;
-
-            expand_and_create_coordinator(thread_context);
-            queue_enqueue(thread_context->coordinator[dir_num - 1]->dir_queue, 
-                                arg, thread_context);
-
-            update_total_sum(file_info.st_blocks, 
-                                thread_context->coordinator[dir_num - 1]);
-        }
+    if (error_count(thread_context) > 0) {
+        exit_status = EXIT_FAILURE;
     }
-}
 
-/*
- * @brief Check if there are any threads active or available work in a 
- * coordinator.
- * 
- * @param thread_context A pointer to the thread context struct containing the 
- * coordinators.
- * @return Returns true if there are threads active, or there is work available 
- * in a coordinator.
-*/
-static bool are_threads_active(ThreadContext *thread_context) {
-    for (int i = 0 ; i < thread_context->dir_num ; i++) {
-        Coordinator* coordinator = thread_context->coordinator[i];
-        int threads_num = get_counter_value(coordinator->active_threads);
-
-        if (threads_num > 0 || !queue_is_empty(coordinator->dir_queue)) {
-            return true;
-        }
+    if (thread_context->breakdown != NULL) {
+        breakdown_print(thread_context->breakdown);
     }
 
-    return false;
+    print_results(argc, argv, thread_context);
+    thread_context_destroy(thread_context);
+
+    exit(exit_status);
 }
 
 /*
- * @brief Finds a coordinator in a thread context struct that has an 
- * non-empty queue.
+ * @brief Prints the histogram of every directory argument to stdout.
  * 
- * @param thread_context A pointer to the thread context struct containing the 
- * coordinators.
- * @param dir_path A pointer to a string containing the directory path.
- * @return Returns a non-empty coordinator if found; else `NULL` is returned.
+ * @param thread_context A pointer to the thread context struct.
 */
-static Coordinator* get_non_empty_coordinator(ThreadContext *thread_context, 
-                                                char** dir_path) {
+static void print_histograms(ThreadContext* thread_context) {
+    reduce_histograms(thread_context);
+
     for (int i = 0 ; i < thread_context->dir_num ; i++) {
         Coordinator* coordinator = thread_context->coordinator[i];
 
-        if (!queue_is_empty(coordinator->dir_queue)) {
-            *dir_path = queue_dequeue(coordinator->dir_queue);
-            increment_counter(coordinator->active_threads);
+        if (thread_context->options.histogram == HISTOGRAM_JSON) {
+            histogram_print_json(&thread_context->histograms[i], 
+                                    coordinator->path, stdout);
 
-            return coordinator;
+        } else {
+            histogram_print(&thread_context->histograms[i], 
+                            coordinator->path, stdout);
         }
     }
-
-    return NULL;
-}
-
-/*
- * @brief Creates the full path to a file.
- * 
- * @param dir_name String of a directory path.
- * @param file_name String of a file path.
- * @return Returns the full path of the file.
-*/
-static char* create_full_path(const char* dir_name, const char *file_name, 
-                                ThreadContext* thread_context) {
-    int path_length = get_path_length(file_name, dir_name);
-    char* full_path = safe_calloc(path_length, sizeof(char), thread_context);
-    snprintf(full_path, path_length, "%s/%s", dir_name, file_name);
-
-    return full_path;
 }
 
 /*
- * @brief Processes a directory entry.
+ * @brief Prints the stats of the traversal to stderr.
  * 
- * If the entry is a directory, add the directory to its queue and add the 
- * size of the directory to `sum`; else it will only add the files size to `sum`.
- * 
- * @param full_path String of the files full path.
- * @param sum The current sum of the traversed directory.
- * @param coordinator A pointer to the coordinator for the directory.
- * @param thread_context A pointer to the thread context struct containing the 
- * coordinators.
+ * @param thread_context A pointer to the thread context struct.
+ * @param start The time the traversal started, from `stats_now()`.
 */
-static void process_directory_entry(char* full_path, int *sum, 
-                                Coordinator* coordinator, ThreadContext *thread_context) {
-    struct stat file_info;
-    safe_lstat(full_path ,&file_info, thread_context);
-    
-    if (is_dictionary(file_info)) {
-        queue_enqueue(coordinator->dir_queue, full_path, thread_context);
-    }
+static void print_stats(ThreadContext* thread_context, uint64_t start) {
+    StatsTotals totals;
+    double seconds = (stats_now() - start) / 1e9;
 
-    *sum += file_info.st_blocks;
+    collect_stats(thread_context, &totals);
 
+    if (thread_context->options.stats == STATS_JSON) {
+        stats_print_json(&totals, seconds, true, stderr);
 
+    } else {
+        stats_print(&totals, seconds, stderr);
+    }
 }
 
-/*
- * @brief Processes all entry's in a directory.
- * 
- * Adds each entry's files size into sum.
- * 
- * @param dir_name String of the directory's path.
- * @param directory The DIR object of the directory.
- * @param sum The current sum of the traversed directory.
- * @param coordinator A pointer to the coordinator for the directory.
- * @param thread_context A pointer to the thread context struct containing the 
- * coordinators.
-*/
-static void process_directory_entries(char* dir_name, DIR* directory, int* sum, 
-                            Coordinator* coordinator, ThreadContext* thread_context) {
-    struct dirent* file;
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
 
-    while((file = readdir(directory)) != NULL) {
 
-        if (!is_dot_or_dot_dot(file->d_name)) {
-            char* full_path = create_full_path(dir_name, file->d_name, thread_context);
-            process_directory_entry(full_path, sum, coordinator, thread_context);
+void traverse_input_arguments(int argc ,char* argv[], ThreadContext* thread_context) {
+    struct stat file_info;
 
-            free(full_path);
-        }
+    for (int i = optind ; i < argc ; i++) {
+        process_argument(argv[i], &file_info, thread_context);
     }
 }
 
 
-/*-----------------------EXTERNAL FUCTIONS-----------------------*/
-
-
-int get_thread_amount(int argc, char* argv[]) {
-    int opt;
+void print_results(int argc, char* argv[], ThreadContext* thread_context) {
+    int dir_num = 0;
+    struct stat file_info;
 
-    while((opt = getopt(argc, argv, "j:")) != -1) {
-        switch (opt) {
-            case 'j':
-                if (*optarg < 1) {
-                    return 0;
+    for (int i = optind ; i < argc ; i++) {
+        Usage usage = {0};
 
-                } else {
-                    return atoi(optarg) - 1;
-                }
-            case '?':
-                break;
+        /* The error is reported by `process_argument()`. */
+        if (lstat(argv[i], &file_info) == -1) {
+            continue;
         }
-    }
-
-    return 0;
-}
-
-
-void traverse_input_arguments(int argc ,char* argv[], ThreadContext* thread_context) {
-    for (int i = 1 ; i < argc ; i++) {
-        process_argument(i, argv[i], thread_context);
-    }
-}
 
+        char* file_path = argv[i];
 
-void* thread_handler(void* arg) {
-    ThreadContext* thread_context = (ThreadContext*) arg;
+        if (is_dictionary(file_info)) {
+            Coordinator* coordinator = thread_context->coordinator[dir_num];
+            dir_num++;
+            file_path = coordinator->path;
 
-    char* dir_path = NULL;
-    Coordinator* coordinator;
+            if (thread_context->breakdown != NULL) {
+                continue;
+            }
 
-    while((coordinator = get_coordinator_with_work(thread_context, &dir_path)) != NULL) {
-        traverse_directory(dir_path, coordinator, thread_context);
+            usage = coordinator->total;
 
-        pthread_mutex_lock(&thread_context->mutex_work);
-        decrement_counter(coordinator->active_threads);
-        pthread_cond_broadcast(&thread_context->cond_work);
-        pthread_mutex_unlock(&thread_context->mutex_work);
-    }
+        } else if (is_counted(&file_info, thread_context)) {
+            usage_add_file(&usage, &file_info);
+        }
 
-    int *exit_status = safe_malloc(sizeof(int), thread_context);
+        if (thread_context->binary != NULL) {
+            struct binary_entry entry = {
+                .id = binary_writer_next_id(thread_context->binary),
+                .parent = BINARY_NO_PARENT,
+                .blocks = usage.blocks,
+                .bytes = usage.bytes,
+                .inodes = usage.inodes
+            };
+
+            binary_writer_add(thread_context->binary, 0, &entry, file_path, 
+                                thread_context);
+            continue;
+        }
 
-    if (errno != 0) {
-        *exit_status = 1;
-        return exit_status;
+        printf("%" PRIu64 "	%s\n", 
+                usage_reported_value(&usage, &thread_context->options), file_path);
     }
-
-    *exit_status = 0;
-    return exit_status;
 }
 
 
-Coordinator* get_coordinator_with_work(ThreadContext* thread_context, char** dir_path) {
-    pthread_mutex_lock(&thread_context->mutex_work);
+void collect_thread_exit_statuses(pthread_t *threads, int thread_num, int* exit_status) {
+    void* value;
 
-    while(are_threads_active(thread_context)) {
-       Coordinator* coordinator;
-       coordinator = get_non_empty_coordinator(thread_context, dir_path);
+    for (int i = 0 ; i < thread_num ; i++) {
+        pthread_join(threads[i], &value);
 
-        if (coordinator == NULL) {
-            pthread_cond_wait(&thread_context->cond_work, &thread_context->mutex_work);
+        if (*(int*) value == EXIT_FAILURE) {
+            *exit_status = EXIT_FAILURE;
+        }
 
-        } else {
-            pthread_mutex_unlock(&thread_context->mutex_work);
-            return coordinator;
-       }
+        free(value);
     }
-
-    pthread_mutex_unlock(&thread_context->mutex_work);
-
-    return NULL;
 }
 
 
-void traverse_directory(char* dir_name, Coordinator* coordinator, ThreadContext* thread_context) {
-    DIR* directory = safe_opendir(dir_name, thread_context);
-    int sum = 0;
-    
-    if (directory != NULL) {
-        process_directory_entries(dir_name ,directory, &sum, coordinator, thread_context);
-
-        update_total_sum(sum, coordinator);
-        closedir(directory);
-    }
+int main(int argc, char* argv[]) {
+    Options options;
+    parse_options(argc, argv, &options);
 
-    free(dir_name);
-}
+    int thread_num = options.thread_num;
+    pthread_t threads[thread_num + 1];
 
+    ThreadContext* thread_context = create_thread_context();
+    thread_context->options = options;
 
-void print_results(int argc, char* argv[], ThreadContext* thread_context) {
-    int file_size;
-    int dir_num = 0;
-    struct stat file_info;
+    if (options.serve != NULL) {
+        int exit_status = remote_serve(thread_context);
 
-    for (int i = 1 ; i < argc ; i++) {
-        if (!is_flag_arg(i)) {
-            safe_lstat(argv[i], &file_info, thread_context);
+        thread_context_destroy(thread_context);
+        exit(exit_status);
+    }
 
-            if (is_dictionary(file_info)) {
-                Coordinator* coordinator = thread_context->coordinator[dir_num];
-                dir_num++;
+    if (!scan_prepare(thread_context)) {
+        thread_context_destroy(thread_context);
+        exit(EXIT_FAILURE);
+    }
 
-                file_size = coordinator->tot_sum;
+    traverse_input_arguments(argc, argv, thread_context);
 
-            } else {
-                file_size = file_info.st_blocks;
-            }
+    exit_if_aborted(thread_context);
 
-        char* file_path = argv[i];
-        printf("%d	%s\n", file_size, file_path);
-        }
+    if (options.remote != NULL || options.local_workers > 0) {
+        scan_remote(argc, argv, thread_context);
     }
-}
 
+    if (!scan_start(thread_context, thread_num + 1)) {
+        thread_context_destroy(thread_context);
+        exit(EXIT_FAILURE);
+    }
 
-void collect_thread_exit_statuses(pthread_t *threads, int thread_num, int* exit_status) {
-    void* value;
+    if (options.affinity || options.numa) {
+        place_workers(thread_context);
+    }
 
-    for (int i = 0 ; i < thread_num ; i++) {
-        pthread_join(threads[i], &value);
+    push_root_jobs(thread_context);
 
-        if (*(int*) value == EXIT_FAILURE) {
-            *exit_status = EXIT_FAILURE;
-        }
+    uint64_t start = stats_now();
+    Controller* controller = NULL;
+    Reporter* reporter = NULL;
+    Reporter* progress = NULL;
 
-        free(value);
+    if (options.auto_threads) {
+        controller = controller_start(thread_context, CONTROLLER_INTERVAL);
     }
-}
 
+    if (options.stats_interval > 0) {
+        reporter = reporter_start(thread_context, options.stats_interval, start, 
+                                    false);
+    }
 
-int main(int argc, char* argv[]) {
-    check_arguments(argc);
-
-    int thread_num = get_thread_amount(argc, argv);
-    pthread_t threads[thread_num];
+    if (options.progress_interval > 0) {
+        progress = reporter_start(thread_context, options.progress_interval, 
+                                    start, true);
+    }
 
-    ThreadContext* thread_context = create_thread_context();
-    traverse_input_arguments(argc, argv, thread_context);
-    
     for (int i = 0 ; i < thread_num ; i++) {
-        pthread_create(&threads[i], NULL, &thread_handler, thread_context);
+        pthread_create(&threads[i], NULL, &thread_handler, 
+                        thread_context->workers[i + 1]);
     }
 
-    void* arg = thread_handler(thread_context);
+    void* arg = thread_handler(thread_context->workers[0]);
 
     int exit_status = *(int*) arg;
     free(arg);
     collect_thread_exit_statuses(threads, thread_num, &exit_status);
+    controller_stop(controller);
+    reporter_stop(reporter);
+    reporter_stop(progress);
+    scan_finish(thread_context);
+    exit_if_aborted(thread_context);
+    flush_errors(thread_context);
+
+    if (options.stats != STATS_NONE) {
+        print_stats(thread_context, start);
+    }
+
+    if (error_count(thread_context) > 0) {
+        exit_status = EXIT_FAILURE;
+    }
+
+    /* A cache of a scan with errors would hide the unread directory's. */
+    if (thread_context->cache != NULL && exit_status == EXIT_SUCCESS && 
+            !scan_cache_save(thread_context->cache, thread_context)) {
+        fprintf(stderr, "mdu: cannot write cache '%s': %s\n", 
+                options.cache_path, strerror(errno));
+    }
+
+    if (thread_context->breakdown != NULL) {
+        breakdown_print(thread_context->breakdown);
+    }
 
     print_results(argc, argv, thread_context);
 
+    if (thread_context->histograms != NULL) {
+        print_histograms(thread_context);
+    }
+
+    if (thread_context->binary != NULL && 
+            !binary_writer_finish(thread_context->binary, thread_context)) {
+        fprintf(stderr, "mdu: cannot write '%s': %s\n", options.output_path, 
+                strerror(errno));
+        exit_status = EXIT_FAILURE;
+    }
+
     thread_context_destroy(thread_context);
 
     if (exit_status != EXIT_SUCCESS) {
@@ -4,7 +4,57 @@
  * directory tree or file.
  * 
  * All figures are reported with a block size of 512 bytes. It works 
- * the same as the command `du -s -l -B512 {fil} [filer ...]`.
+ * the same as the command `du -s -l -B512 {fil} [filer ...]`. With 
+ * `--apparent-size` or `--inodes` it reports the apparent size or the 
+ * number of inodes instead. With `--dedup` a hard linked file is only 
+ * counted once, as `du` does without `-l`. With `--breakdown`, 
+ * `--max-depth` or `--top` the total of every directory is reported, as 
+ * `du` does without `-s`. With `--cache=FILE` the usage below every 
+ * directory is saved, and with `--trust-mtime` a directory whose mtime and 
+ * ctime are unchanged since the last scan is not traversed again. A cache 
+ * saved with other `--dedup`, `-x` or exclude patterns is not used. With 
+ * `--output=binary` the totals are written to a columnar file instead.
+ * 
+ * A file that cannot be read is reported and skipped, the program then 
+ * ends with a failure status. With `--errors=abort` it ends at the first 
+ * such error instead. With `--stats` the counters of the workers are 
+ * printed to stderr when the traversal is done, and with 
+ * `--stats-interval=MS` they are also printed as JSON lines while it runs. 
+ * `--progress[=MS]` prints a line of progress to stderr every second, or 
+ * every MS milliseconds.
+ * 
+ * With `-j auto` the number of threads at work follows the measured rate 
+ * of entry's, the threads not needed are parked. With `--affinity` each 
+ * thread is pinned to a cpu. With `--numa` the threads are spread over the 
+ * NUMA nodes, their memory is allocated on their node and they steal from 
+ * threads on the same node first.
+ * 
+ * With `--remote=HOST:PORT,...` or `--local-workers=N` the sub trees below 
+ * the top `--remote-depth` levels are scanned by worker processes, which 
+ * are started with `--serve=[ADDR:]PORT` on other nodes or forked locally. 
+ * A worker scans any path it is sent without authentication, so it 
+ * listens on 127.0.0.1 unless it is given an address.
+ * 
+ * With `-x` directory's on other devices than their argument are skipped, 
+ * as `du -x` does. With `--dev-jobs=LIST` the number of workers on each 
+ * device is limited, by filesystem type or `major:minor`, such as 
+ * `--dev-jobs=nfs=8,default=32`. Within its budget, the limit of a device 
+ * is lowered while its stat latency climbs and raised when it falls.
+ * 
+ * With `--exclude=PATTERN` and `--exclude-from=FILE` the entry's matching 
+ * a pattern are skipped, such as `--exclude=node_modules` or 
+ * `--exclude=.git/objects`. An excluded directory is not read at all. 
+ * `--histogram[=text|json]` prints a histogram of the file sizes and of 
+ * the mtime ages of each directory argument after the results. 
+ * `--prefetch[=K]` opens up to K, by default 64, of the pushed directory's 
+ * ahead of the workers, the hit rate is reported by `--stats`.
+ * 
+ * The traversal is also built as the library libmdu by `make lib`, which 
+ * runs the scans of another program on a persistent pool of threads, see 
+ * libmdu.h. `make release` builds mdu_release with `-O2`, `make pgo` 
+ * builds mdu_pgo trained on the trees of mdu_bench, and `make 
+ * bench-compare` prints the throughput of the release build beside that 
+ * of the debug build.
  *
  * @author Daniel Hylander
  * @date 2023-10-18
@@ -18,6 +68,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <ctype.h>
 #include <sys/types.h>
@@ -27,35 +79,34 @@
 #include <dirent.h>
 #include <errno.h>
 
-#include "queue.h"
+#include "deque.h"
+#include "job.h"
+#include "options.h"
+#include "stat_batch.h"
+#include "dir_buffer.h"
+#include "inode_set.h"
+#include "arena.h"
+#include "breakdown.h"
+#include "scan_cache.h"
+#include "binary_output.h"
+#include "error_buffer.h"
+#include "stats.h"
+#include "reporter.h"
+#include "device.h"
+#include "controller.h"
+#include "topology.h"
+#include "remote.h"
+#include "prefetch.h"
+#include "scan.h"
 #include "safe_functions.h"
 #include "thread_context.h"
 
-#define BLOCK_SIZE 512
-
-/**
- * @brief Returns the users requested thread amount.
- * 
- * @param argc Number of input arguments.
- * @param argv Input arguments.
- * @return Returns the users requested thread amount.
-*/
-int get_thread_amount(int argc, char* argv[]);
-
-/**
- * @brief Handles the logic for what work each thread will preform.
- * 
- * @param arg A thread context struct.
- * @return Returns the threads exit status.
-*/
-void* thread_handler(void* arg);
 
 /**
  * @brief Traverses and processes all arguments from `argv`.
  * 
  * If the argument is a directory, it will create a new coordinator for the 
- * directory. In the new coordinator it will add the directory to its queue 
- * and update the total size of the directory.
+ * directory and update the total size of the directory.
  * 
  * @param argc The amount of input arguments.
  * @param argv The input arguments.
@@ -65,35 +116,6 @@ void* thread_handler(void* arg);
 void traverse_input_arguments(int argc ,char* argv[], 
                                 ThreadContext* thread_context);
 
-/**
- * @brief Traverses and processes all entry's in a directory.
- * 
- * Adds each entry's files size into the coordinators `tot_sum`.
- * 
- * @param dir_name String of the directory's path.
- * @param coordinator A pointer to the coordinator for the directory.
- * @param thread_context A pointer to the thread context struct containing the 
- * coordinators.
-*/
-void traverse_directory(char* dir_name, Coordinator* coordinator, 
-                            ThreadContext* thread_context);
-
-/**
- * @brief Finds a coordinator struct that has work available.
- * 
- * Tries to find a coordinator with a non-empty queue, if non exist 
- * it will wait till a thread is done traversing a directory. If no thread is 
- * active it will return `NULL`.
- * 
- * @param thread_context A pointer to the thread context struct containing the 
- * coordinators.
- * @param dir_path String of the directory's path.
- * @return Returns a coordinator with work available; else if none exists and
- * no thread is active NULL is returned.
-*/
-Coordinator* get_coordinator_with_work(ThreadContext* thread_context, 
-                                        char** dir_path);
-
 /**
  * @brief Prints the disk usage of each file file entered as an argument.
  * 
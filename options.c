@@ -0,0 +1,568 @@
+/*
+ * @brief This module parses the command line options of the program.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include "options.h"
+#include "dir_buffer.h"
+
+#define USAGE "mdu [-j {antal trådar}|auto] [--affinity] [--numa] [-x] " \
+                "[--engine=sync|batch|uring] " \
+                "[--reader=readdir|getdents] [--getdents-buffer=SIZE] " \
+                "[--split-threshold=N] [--order=dfs|bfs|hybrid] " \
+                "[--apparent-size | --inodes] [--dedup] " \
+                "[--breakdown] [--max-depth=N] [--top=N] " \
+                "[--cache=FILE [--trust-mtime]] " \
+                "[--output=text|binary --output-file=FILE] " \
+                "[--errors=continue|abort] " \
+                "[--stats[=text|json]] [--stats-interval=MS] [--progress[=MS]] " \
+                "[--dev-jobs=TYPE=N,...,default=N] " \
+                "[--exclude=PATTERN] [--exclude-from=FILE] " \
+                "[--histogram[=text|json]] [--prefetch[=K]] " \
+                "[--remote=HOST:PORT,... | --local-workers=N] [--remote-depth=N] " \
+                "{fil} [filer ...]\n" \
+                "mdu [-j {antal trådar}|auto] [-x] --serve=[ADDR:]PORT\n"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Returns the most threads `-j auto` may use.
+ *
+ * Traversals spend most of their time waiting for the file system, so 
+ * there are `AUTO_THREADS_PER_CPU` threads for each online cpu, at most 
+ * `AUTO_MAX_THREADS`.
+ *
+ * @return Returns the number of threads to create besides the main thread.
+*/
+static int get_auto_thread_amount(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    long threads = cpus > 0 ? cpus * AUTO_THREADS_PER_CPU : AUTO_MAX_THREADS;
+
+    if (threads > AUTO_MAX_THREADS) {
+        threads = AUTO_MAX_THREADS;
+    }
+
+    return threads - 1;
+}
+
+/*
+ * @brief Prints the usage of the program to stderr and exits the program.
+*/
+static void usage(void) {
+    fprintf(stderr, USAGE);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * @brief Returns the engine named by `arg`.
+ *
+ * If `arg` is not the name of an engine, a message is printed to stderr
+ * and the program exits.
+ *
+ * @param arg The argument of the `--engine` flag.
+ * @return Returns the engine.
+*/
+static Engine get_engine(const char* arg) {
+    if (strcmp(arg, "sync") == 0) {
+        return ENGINE_SYNC;
+
+    } else if (strcmp(arg, "batch") == 0) {
+        return ENGINE_BATCH;
+
+    } else if (strcmp(arg, "uring") == 0) {
+        return ENGINE_URING;
+    }
+
+    fprintf(stderr, "mdu: unknown engine '%s'\n", arg);
+    usage();
+
+    return ENGINE_SYNC;
+}
+
+/*
+ * @brief Returns the reader named by `arg`.
+ *
+ * If `arg` is not the name of a reader, a message is printed to stderr
+ * and the program exits.
+ *
+ * @param arg The argument of the `--reader` flag.
+ * @return Returns the reader.
+*/
+static Reader get_reader(const char* arg) {
+    if (strcmp(arg, "readdir") == 0) {
+        return READER_READDIR;
+
+    } else if (strcmp(arg, "getdents") == 0) {
+        return READER_GETDENTS;
+    }
+
+    fprintf(stderr, "mdu: unknown reader '%s'\n", arg);
+    usage();
+
+    return READER_READDIR;
+}
+
+/*
+ * @brief Returns the order named by `arg`.
+ *
+ * If `arg` is not the name of an order, a message is printed to stderr
+ * and the program exits.
+ *
+ * @param arg The argument of the `--order` flag.
+ * @return Returns the order.
+*/
+static Order get_order(const char* arg) {
+    if (strcmp(arg, "hybrid") == 0) {
+        return ORDER_HYBRID;
+
+    } else if (strcmp(arg, "dfs") == 0) {
+        return ORDER_DFS;
+
+    } else if (strcmp(arg, "bfs") == 0) {
+        return ORDER_BFS;
+    }
+
+    fprintf(stderr, "mdu: unknown order '%s'\n", arg);
+    usage();
+
+    return ORDER_HYBRID;
+}
+
+/*
+ * @brief Returns the output format named by `arg`.
+ *
+ * If `arg` is not the name of a format, a message is printed to stderr
+ * and the program exits.
+ *
+ * @param arg The argument of the `--output` flag.
+ * @return Returns the format.
+*/
+static Output get_output(const char* arg) {
+    if (strcmp(arg, "text") == 0) {
+        return OUTPUT_TEXT;
+
+    } else if (strcmp(arg, "binary") == 0) {
+        return OUTPUT_BINARY;
+    }
+
+    fprintf(stderr, "mdu: unknown output format '%s'\n", arg);
+    usage();
+
+    return OUTPUT_TEXT;
+}
+
+/*
+ * @brief Returns the error policy named by `arg`.
+ *
+ * If `arg` is not the name of a policy, a message is printed to stderr
+ * and the program exits.
+ *
+ * @param arg The argument of the `--errors` flag.
+ * @return Returns the policy.
+*/
+static ErrorPolicy get_error_policy(const char* arg) {
+    if (strcmp(arg, "continue") == 0) {
+        return ERRORS_CONTINUE;
+
+    } else if (strcmp(arg, "abort") == 0) {
+        return ERRORS_ABORT;
+    }
+
+    fprintf(stderr, "mdu: unknown error policy '%s'\n", arg);
+    usage();
+
+    return ERRORS_CONTINUE;
+}
+
+/*
+ * @brief Returns the stats format named by `arg`.
+ *
+ * If `arg` is NULL the format is text. If `arg` is not the name of a 
+ * format, a message is printed to stderr and the program exits.
+ *
+ * @param arg The argument of the `--stats` flag or NULL.
+ * @return Returns the format.
+*/
+static Stats get_stats(const char* arg) {
+    if (arg == NULL || strcmp(arg, "text") == 0) {
+        return STATS_TEXT;
+
+    } else if (strcmp(arg, "json") == 0) {
+        return STATS_JSON;
+    }
+
+    fprintf(stderr, "mdu: unknown stats format '%s'\n", arg);
+    usage();
+
+    return STATS_TEXT;
+}
+
+/*
+ * @brief Returns the histogram format named by `arg`.
+ *
+ * If `arg` is NULL the format is text. If `arg` is not the name of a 
+ * format, a message is printed to stderr and the program exits.
+ *
+ * @param arg The argument of the `--histogram` flag or NULL.
+ * @return Returns the format.
+*/
+static HistogramFormat get_histogram(const char* arg) {
+    if (arg == NULL || strcmp(arg, "text") == 0) {
+        return HISTOGRAM_TEXT;
+
+    } else if (strcmp(arg, "json") == 0) {
+        return HISTOGRAM_JSON;
+    }
+
+    fprintf(stderr, "mdu: unknown histogram format '%s'\n", arg);
+    usage();
+
+    return HISTOGRAM_TEXT;
+}
+
+/*
+ * @brief Returns the non-negative number given by `arg`.
+ *
+ * If `arg` is not a valid number, a message is printed to stderr and the
+ * program exits.
+ *
+ * @param arg The argument to parse.
+ * @return Returns the number.
+*/
+static long get_count(const char* arg) {
+    char* end;
+    long count = strtol(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || count < 0) {
+        fprintf(stderr, "mdu: invalid number '%s'\n", arg);
+        usage();
+    }
+
+    return count;
+}
+
+/*
+ * @brief Adds an argument to a list of arguments.
+ *
+ * The list holds at most `argc` arguments, it is allocated when the first
+ * argument is added. If memory allocation fails, the program exits.
+ *
+ * @param list Pointer to the list or to NULL.
+ * @param num Pointer to the number of arguments in the list.
+ * @param arg The argument to add.
+ * @param argc Number of input arguments.
+*/
+static void add_argument(const char*** list, int* num, const char* arg, 
+                            int argc) {
+    if (*list == NULL) {
+        *list = malloc(argc * sizeof(char*));
+
+        if (*list == NULL) {
+            fprintf(stderr, "malloc() failed to allocate memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    (*list)[(*num)++] = arg;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+void set_default_options(Options* options) {
+    options->thread_num = 0;
+    options->auto_threads = false;
+    options->affinity = false;
+    options->numa = false;
+    options->engine = ENGINE_SYNC;
+    options->reader = READER_READDIR;
+    options->getdents_buffer_size = DIR_BUFFER_DEFAULT_SIZE;
+    options->split_threshold = DEFAULT_SPLIT_THRESHOLD;
+    options->order = ORDER_HYBRID;
+    options->report = REPORT_BLOCKS;
+    options->dedup_links = false;
+    options->breakdown = false;
+    options->max_depth = -1;
+    options->top = 0;
+    options->cache_path = NULL;
+    options->trust_mtime = false;
+    options->output = OUTPUT_TEXT;
+    options->output_path = NULL;
+    options->errors = ERRORS_CONTINUE;
+    options->stats = STATS_NONE;
+    options->stats_interval = 0;
+    options->progress_interval = 0;
+    options->one_file_system = false;
+    options->dev_jobs = NULL;
+    options->remote = NULL;
+    options->local_workers = 0;
+    options->remote_depth = DEFAULT_REMOTE_DEPTH;
+    options->serve = NULL;
+    options->excludes = NULL;
+    options->exclude_num = 0;
+    options->exclude_files = NULL;
+    options->exclude_file_num = 0;
+    options->histogram = HISTOGRAM_NONE;
+    options->prefetch = 0;
+}
+
+
+void parse_options(int argc, char* argv[], Options* options) {
+    static const struct option long_options[] = {
+        {"engine", required_argument, NULL, 'e'},
+        {"reader", required_argument, NULL, 'r'},
+        {"getdents-buffer", required_argument, NULL, 'B'},
+        {"split-threshold", required_argument, NULL, 'S'},
+        {"order", required_argument, NULL, 'o'},
+        {"apparent-size", no_argument, NULL, 'A'},
+        {"inodes", no_argument, NULL, 'I'},
+        {"dedup", no_argument, NULL, 'D'},
+        {"breakdown", no_argument, NULL, 'b'},
+        {"max-depth", required_argument, NULL, 'd'},
+        {"top", required_argument, NULL, 't'},
+        {"cache", required_argument, NULL, 'c'},
+        {"trust-mtime", no_argument, NULL, 'T'},
+        {"output", required_argument, NULL, 'O'},
+        {"output-file", required_argument, NULL, 'F'},
+        {"errors", required_argument, NULL, 'E'},
+        {"stats", optional_argument, NULL, 'a'},
+        {"stats-interval", required_argument, NULL, 'i'},
+        {"progress", optional_argument, NULL, 'p'},
+        {"one-file-system", no_argument, NULL, 'x'},
+        {"dev-jobs", required_argument, NULL, 'J'},
+        {"affinity", no_argument, NULL, 'C'},
+        {"numa", no_argument, NULL, 'N'},
+        {"remote", required_argument, NULL, 'R'},
+        {"local-workers", required_argument, NULL, 'L'},
+        {"remote-depth", required_argument, NULL, 'P'},
+        {"serve", required_argument, NULL, 'W'},
+        {"exclude", required_argument, NULL, 'X'},
+        {"exclude-from", required_argument, NULL, 'Y'},
+        {"histogram", optional_argument, NULL, 'H'},
+        {"prefetch", optional_argument, NULL, 'K'},
+        {NULL, 0, NULL, 0}
+    };
+    int opt;
+
+    set_default_options(options);
+
+    while((opt = getopt_long(argc, argv, "j:x", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'j':
+                options->auto_threads = strcmp(optarg, "auto") == 0;
+                options->thread_num = options->auto_threads ? 
+                                        get_auto_thread_amount() : 
+                                        get_thread_amount(optarg);
+                break;
+            case 'e':
+                options->engine = get_engine(optarg);
+                break;
+            case 'r':
+                options->reader = get_reader(optarg);
+                break;
+            case 'B':
+                options->getdents_buffer_size = get_size(optarg);
+
+                if (options->getdents_buffer_size < DIR_BUFFER_MIN_SIZE) {
+                    options->getdents_buffer_size = DIR_BUFFER_MIN_SIZE;
+                }
+                break;
+            case 'S':
+                options->split_threshold = get_count(optarg);
+                break;
+            case 'o':
+                options->order = get_order(optarg);
+                break;
+            case 'A':
+                options->report = REPORT_APPARENT_SIZE;
+                break;
+            case 'I':
+                options->report = REPORT_INODES;
+                break;
+            case 'D':
+                options->dedup_links = true;
+                break;
+            case 'b':
+                options->breakdown = true;
+                break;
+            case 'd':
+                options->breakdown = true;
+                options->max_depth = get_count(optarg);
+                break;
+            case 't':
+                options->breakdown = true;
+                options->top = get_count(optarg);
+                break;
+            case 'c':
+                options->cache_path = optarg;
+                break;
+            case 'T':
+                options->trust_mtime = true;
+                break;
+            case 'O':
+                options->output = get_output(optarg);
+                break;
+            case 'F':
+                options->output_path = optarg;
+                break;
+            case 'E':
+                options->errors = get_error_policy(optarg);
+                break;
+            case 'a':
+                options->stats = get_stats(optarg);
+                break;
+            case 'i':
+                options->stats_interval = get_count(optarg);
+                break;
+            case 'x':
+                options->one_file_system = true;
+                break;
+            case 'J':
+                options->dev_jobs = optarg;
+                break;
+            case 'C':
+                options->affinity = true;
+                break;
+            case 'N':
+                options->numa = true;
+                break;
+            case 'R':
+                options->remote = optarg;
+                break;
+            case 'L':
+                options->local_workers = get_thread_amount(optarg) + 1;
+                break;
+            case 'P':
+                options->remote_depth = get_count(optarg);
+
+                if (options->remote_depth < 1) {
+                    options->remote_depth = 1;
+                }
+                break;
+            case 'W':
+                options->serve = optarg;
+                break;
+            case 'X':
+                add_argument(&options->excludes, &options->exclude_num, optarg, 
+                                argc);
+                break;
+            case 'Y':
+                add_argument(&options->exclude_files, 
+                                &options->exclude_file_num, optarg, argc);
+                break;
+            case 'H':
+                options->histogram = get_histogram(optarg);
+                break;
+            case 'K':
+                options->prefetch = optarg == NULL ? 
+                                    DEFAULT_PREFETCH : get_count(optarg);
+                break;
+            case 'p':
+                options->progress_interval = optarg == NULL ? 
+                                    DEFAULT_PROGRESS_INTERVAL : get_count(optarg);
+                break;
+            case '?':
+                break;
+        }
+    }
+
+    if (options->trust_mtime && options->cache_path == NULL) {
+        fprintf(stderr, "mdu: --trust-mtime requires --cache\n");
+        usage();
+    }
+
+    if (options->trust_mtime && options->histogram != HISTOGRAM_NONE) {
+        fprintf(stderr, "mdu: --histogram cannot be used with --trust-mtime\n");
+        usage();
+    }
+
+    /* The hard links below a skipped directory are not in the inode set. */
+    if (options->trust_mtime && options->dedup_links) {
+        fprintf(stderr, "mdu: --dedup cannot be used with --trust-mtime\n");
+        usage();
+    }
+
+    if (options->output == OUTPUT_BINARY) {
+        if (options->output_path == NULL || options->top > 0) {
+            fprintf(stderr, "mdu: --output=binary requires --output-file "
+                            "and cannot be used with --top\n");
+            usage();
+        }
+
+        options->breakdown = true;
+    }
+
+    /* The cache holds the totals of a skipped directory, not its children. */
+    if (options->trust_mtime && options->breakdown) {
+        fprintf(stderr, "mdu: --breakdown, --max-depth, --top and "
+                        "--output=binary cannot be used with --trust-mtime\n");
+        usage();
+    }
+
+    if ((options->remote != NULL || options->local_workers > 0) && 
+            (options->dedup_links || options->cache_path != NULL || 
+            options->output == OUTPUT_BINARY || options->excludes != NULL || 
+            options->exclude_files != NULL || 
+            options->histogram != HISTOGRAM_NONE)) {
+        fprintf(stderr, "mdu: --remote and --local-workers cannot be used "
+                        "with --dedup, --cache, --output=binary, --exclude "
+                        "or --histogram\n");
+        usage();
+    }
+
+    if (options->stats_interval > 0 && options->stats == STATS_NONE) {
+        options->stats = STATS_JSON;
+    }
+
+    if (optind >= argc && options->serve == NULL) {
+        usage();
+    }
+}
+
+
+size_t get_size(const char* arg) {
+    char* end;
+    unsigned long long size = strtoull(arg, &end, 10);
+
+    if (end == arg) {
+        fprintf(stderr, "mdu: invalid size '%s'\n", arg);
+        usage();
+    }
+
+    switch (*end) {
+        case 'G':
+        case 'g':
+            size *= 1024;
+            /* fall through */
+        case 'M':
+        case 'm':
+            size *= 1024;
+            /* fall through */
+        case 'K':
+        case 'k':
+            size *= 1024;
+            end++;
+            break;
+    }
+
+    if (*end != '\0') {
+        fprintf(stderr, "mdu: invalid size '%s'\n", arg);
+        usage();
+    }
+
+    return size;
+}
+
+
+int get_thread_amount(const char* arg) {
+    char* end;
+    long threads = strtol(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || threads < 1 || threads > MAX_THREADS) {
+        fprintf(stderr, "mdu: invalid thread amount '%s'\n", arg);
+        usage();
+    }
+
+    return threads - 1;
+}
@@ -0,0 +1,264 @@
+/**
+ * @defgroup module_options Options
+ *
+ * @file options.h
+ * @brief This module parses the command line options of the program.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#define DEFAULT_SPLIT_THRESHOLD 50000
+#define DEFAULT_PROGRESS_INTERVAL 1000
+#define AUTO_THREADS_PER_CPU 4
+#define AUTO_MAX_THREADS 64
+#define MAX_THREADS 1024
+#define DEFAULT_REMOTE_DEPTH 1
+#define DEFAULT_PREFETCH 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <getopt.h>
+
+/**
+ * @brief The engines used to stat the entry's of a directory.
+ *
+ * `ENGINE_SYNC` stats every entry as soon as it is read. `ENGINE_BATCH` uses
+ * the `d_type` of the entry's to push sub directory's without waiting for a
+ * stat and stats the remaining entry's in batches. `ENGINE_URING` works as
+ * `ENGINE_BATCH`, but submits each batch as io_uring statx requests.
+*/
+typedef enum {
+    ENGINE_SYNC,
+    ENGINE_BATCH,
+    ENGINE_URING
+} Engine;
+
+/**
+ * @brief The readers used to read the entry's of a directory.
+ *
+ * `READER_READDIR` uses `readdir`. `READER_GETDENTS` calls `getdents64`
+ * directly into a large buffer that each worker reuses.
+*/
+typedef enum {
+    READER_READDIR,
+    READER_GETDENTS
+} Reader;
+
+/**
+ * @brief The orders in which the workers traverse their directory's.
+ *
+ * `ORDER_HYBRID` pushes every sub directory to the deque of the worker, the
+ * owner takes the newest and thieves the oldest. `ORDER_DFS` keeps the sub
+ * directory's on a private stack that is only published for stealing when
+ * other workers are idle, which keeps the frontier small. `ORDER_BFS` makes
+ * the owner take the oldest job of its deque as well.
+*/
+typedef enum {
+    ORDER_HYBRID,
+    ORDER_DFS,
+    ORDER_BFS
+} Order;
+
+/**
+ * @brief The formats of the output.
+ *
+ * `OUTPUT_TEXT` prints a line for each result. `OUTPUT_BINARY` writes the 
+ * totals of every directory to a columnar file, see `BinaryWriter`.
+*/
+typedef enum {
+    OUTPUT_TEXT,
+    OUTPUT_BINARY
+} Output;
+
+/**
+ * @brief The policies for a file that cannot be read.
+ *
+ * `ERRORS_CONTINUE` reports the error, skips the file and ends the program 
+ * with a failure status once everything else is counted. `ERRORS_ABORT` 
+ * ends the program at the first error.
+*/
+typedef enum {
+    ERRORS_CONTINUE,
+    ERRORS_ABORT
+} ErrorPolicy;
+
+/**
+ * @brief The formats of the stats of the traversal.
+ *
+ * `STATS_NONE` does not report the stats and does not time the workers.
+ * `STATS_TEXT` prints a summary to stderr when the traversal is done, 
+ * `STATS_JSON` prints it as a JSON line instead.
+*/
+typedef enum {
+    STATS_NONE,
+    STATS_TEXT,
+    STATS_JSON
+} Stats;
+
+/**
+ * @brief The formats of the histograms of the arguments.
+ *
+ * `HISTOGRAM_NONE` does not count the histograms. `HISTOGRAM_TEXT` prints 
+ * them after the results, `HISTOGRAM_JSON` prints a JSON line for each 
+ * argument instead.
+*/
+typedef enum {
+    HISTOGRAM_NONE,
+    HISTOGRAM_TEXT,
+    HISTOGRAM_JSON
+} HistogramFormat;
+
+/**
+ * @brief The values that can be reported for each file.
+*/
+typedef enum {
+    REPORT_BLOCKS,
+    REPORT_APPARENT_SIZE,
+    REPORT_INODES
+} Report;
+
+/**
+ * @struct Options
+ *
+ * @brief Type for the command line options.
+ *
+ * If `breakdown` is set, the total of every directory is reported instead 
+ * of only the arguments. `max_depth` limits the reported directory's to 
+ * those at most that many levels below an argument, it is negative if 
+ * there is no limit. If `top` is non-zero, only that many of the largest 
+ * directory's are reported.
+ * 
+ * `cache_path` is the path of the scan cache or NULL. If `trust_mtime` is 
+ * set, a directory with the same mtime and ctime as in the cache is assumed 
+ * to hold the same usage as in the cache and is not traversed, so it 
+ * cannot be used with the breakdown, the histograms or `dedup_links`. 
+ * `output_path` is the file the binary output is written to. If 
+ * `stats_interval` is non-zero, the stats are also printed as JSON lines 
+ * every that many milliseconds. If `progress_interval` is non-zero, a line 
+ * of progress is printed every that many milliseconds.
+ * 
+ * If `auto_threads` is set, `thread_num` is the most threads created and 
+ * the number of threads at work is picked while the traversal runs. If 
+ * `affinity` is set, each thread is pinned to a cpu. If `numa` is set, the 
+ * threads are spread over the NUMA nodes and pinned to their node.
+ * 
+ * If `one_file_system` is set, directory's on other devices than their 
+ * argument are skipped. `dev_jobs` is the list of budgets for the workers 
+ * on each device or NULL, see `DeviceTable`.
+ * 
+ * `remote` is the list of workers `host:port` to scan with and 
+ * `local_workers` the number of worker processes to fork, see `Remote`. 
+ * The directory's `remote_depth` levels below the arguments are handed 
+ * out as sub trees. If `serve` is set, the program serves scans on that 
+ * `[ADDR:]PORT` instead.
+ * 
+ * `excludes` holds the `exclude_num` patterns of `--exclude` and 
+ * `exclude_files` the `exclude_file_num` files of `--exclude-from`, both 
+ * point into `argv`. They are NULL if there are none. `histogram` is the 
+ * format of the histograms of the sizes and ages of the files, see 
+ * `Histogram`. If `prefetch` is non-zero, up to that many pushed 
+ * directory's are opened ahead of the workers, see `Prefetcher`.
+*/
+typedef struct {
+    int thread_num;
+    bool auto_threads;
+    bool affinity;
+    bool numa;
+    Engine engine;
+    Reader reader;
+    size_t getdents_buffer_size;
+    long split_threshold;
+    Order order;
+    Report report;
+    bool dedup_links;
+
+    bool breakdown;
+    long max_depth;
+    long top;
+
+    const char* cache_path;
+    bool trust_mtime;
+
+    Output output;
+    const char* output_path;
+
+    ErrorPolicy errors;
+
+    Stats stats;
+    long stats_interval;
+    long progress_interval;
+
+    bool one_file_system;
+    const char* dev_jobs;
+
+    const char* remote;
+    int local_workers;
+    long remote_depth;
+    const char* serve;
+
+    const char** excludes;
+    int exclude_num;
+    const char** exclude_files;
+    int exclude_file_num;
+
+    HistogramFormat histogram;
+    long prefetch;
+} Options;
+
+/**
+ * @brief Sets `options` to the defaults of the command line.
+ *
+ * @param options Pointer to the options to fill in.
+*/
+void set_default_options(Options* options);
+
+/**
+ * @brief Parses the command line options into `options`.
+ *
+ * When the function returns, `optind` is the index of the first file
+ * argument in `argv`. If the options are invalid or no file is given, a
+ * message is printed to stderr and the program exits.
+ *
+ * @param argc Number of input arguments.
+ * @param argv Input arguments.
+ * @param options Pointer to the options to fill in.
+*/
+void parse_options(int argc, char* argv[], Options* options);
+
+/**
+ * @brief Returns the size given by `arg`.
+ *
+ * The size is a number of bytes, optionally followed by the suffix `K`, `M`
+ * or `G`. If `arg` is not a valid size, a message is printed to stderr and
+ * the program exits.
+ *
+ * @param arg The argument to parse.
+ * @return Returns the size in bytes.
+*/
+size_t get_size(const char* arg);
+
+/**
+ * @brief Returns the users requested thread amount.
+ *
+ * If `arg` is not a number between 1 and `MAX_THREADS`, a message is 
+ * printed to stderr and the program exits.
+ *
+ * @param arg The argument of the `-j` flag.
+ * @return Returns the number of threads to create besides the main thread.
+*/
+int get_thread_amount(const char* arg);
+
+#endif /* OPTIONS_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,261 @@
+/*
+ * @brief This module implements the datatype Prefetcher.
+ *
+ * The thread takes every request handed out since its last batch at once.
+ * A ticket is only marked done once its parent directory is released, and
+ * `completed` only moves past a batch once all of it is done, so a slot is
+ * never reused while the thread still reads it.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "prefetch.h"
+#include "safe_functions.h"
+
+#define PREFETCH_FLAGS (O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC)
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Returns the smallest power of two not below `value`.
+ *
+ * @param value The value, at least one.
+ * @return Returns the power of two.
+*/
+static uint64_t round_up_power_of_two(uint64_t value) {
+    uint64_t power = 1;
+
+    while (power < value) {
+        power *= 2;
+    }
+
+    return power;
+}
+
+/*
+ * @brief Prefetches the directories of the tickets from `first` up to
+ * `last`.
+ *
+ * @param prefetcher Pointer to the prefetcher.
+ * @param first The first ticket of the batch.
+ * @param last The ticket after the batch.
+*/
+static void prefetch_batch(Prefetcher* prefetcher, uint64_t first,
+                            uint64_t last) {
+    uint64_t mask = prefetcher->capacity - 1;
+    int count = last - first;
+    int dir_fds[count];
+    const char* names[count];
+    int results[count];
+
+    for (int i = 0 ; i < count ; i++) {
+        struct prefetch_request* request = &prefetcher->requests[(first + i) &
+                                                                    mask];
+
+        dir_fds[i] = dirfd(request->parent->directory);
+        names[i] = request->name;
+        results[i] = -EINVAL;
+    }
+
+    if (prefetcher->ring != NULL) {
+        uring_openat_batch(prefetcher->ring, dir_fds, names, count,
+                            PREFETCH_FLAGS, results);
+    }
+
+    for (int i = 0 ; i < count ; i++) {
+        struct prefetch_request* request = &prefetcher->requests[(first + i) &
+                                                                    mask];
+
+        /* Also covers kernels without `IORING_OP_OPENAT`. */
+        if (results[i] == -EINVAL) {
+            results[i] = openat(dir_fds[i], names[i], PREFETCH_FLAGS);
+        }
+
+        if (results[i] >= 0) {
+            syscall(SYS_getdents64, results[i], prefetcher->buffer,
+                    PREFETCH_READ_SIZE);
+            close(results[i]);
+        }
+
+        dir_handle_release(request->parent, prefetcher->thread_context);
+        atomic_store_explicit(&prefetcher->done[(first + i) & mask], first + i,
+                                memory_order_release);
+    }
+
+    atomic_store_explicit(&prefetcher->completed, last, memory_order_release);
+}
+
+/*
+ * @brief Releases the parent directory's of the requests not yet taken.
+ *
+ * @param prefetcher Pointer to the prefetcher, its thread must be stopped.
+*/
+static void drop_requests(Prefetcher* prefetcher) {
+    uint64_t last = atomic_load(&prefetcher->next_ticket);
+
+    for (uint64_t ticket = prefetcher->next_request ; ticket < last ; ticket++) {
+        struct prefetch_request* request = &prefetcher->requests[ticket &
+                                                (prefetcher->capacity - 1)];
+
+        dir_handle_release(request->parent, prefetcher->thread_context);
+    }
+}
+
+/*
+ * @brief The thread of the prefetcher.
+ *
+ * @param arg Pointer to the prefetcher.
+ * @return Returns NULL.
+*/
+static void* prefetcher_thread(void* arg) {
+    Prefetcher* prefetcher = arg;
+
+    pthread_mutex_lock(&prefetcher->mutex);
+
+    while (true) {
+        while (!prefetcher->stop && prefetcher->next_request ==
+                atomic_load(&prefetcher->next_ticket)) {
+            pthread_cond_wait(&prefetcher->cond, &prefetcher->mutex);
+        }
+
+        if (prefetcher->stop) {
+            break;
+        }
+
+        uint64_t first = prefetcher->next_request;
+        uint64_t last = atomic_load(&prefetcher->next_ticket);
+
+        prefetcher->next_request = last;
+        pthread_mutex_unlock(&prefetcher->mutex);
+
+        prefetch_batch(prefetcher, first, last);
+
+        pthread_mutex_lock(&prefetcher->mutex);
+    }
+
+    pthread_mutex_unlock(&prefetcher->mutex);
+
+    return NULL;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Prefetcher* prefetcher_start(ThreadContext* thread_context, int limit) {
+    Prefetcher* prefetcher = safe_aligned_alloc(CACHE_LINE_SIZE,
+                                                sizeof(Prefetcher),
+                                                thread_context);
+
+    if (limit > PREFETCH_MAX) {
+        limit = PREFETCH_MAX;
+    }
+
+    if (limit > thread_context->max_open_handles / 2) {
+        limit = thread_context->max_open_handles / 2 > 0 ?
+                thread_context->max_open_handles / 2 : 1;
+    }
+
+    prefetcher->thread_context = thread_context;
+    prefetcher->limit = limit;
+    prefetcher->capacity = round_up_power_of_two(limit);
+    prefetcher->requests = safe_malloc(prefetcher->capacity *
+                                        sizeof(struct prefetch_request),
+                                        thread_context);
+    prefetcher->done = safe_calloc(prefetcher->capacity,
+                                    sizeof(_Atomic uint64_t), thread_context);
+    atomic_init(&prefetcher->next_ticket, 1);
+    atomic_init(&prefetcher->completed, 1);
+    prefetcher->next_request = 1;
+    prefetcher->ring = uring_create(prefetcher->capacity);
+    prefetcher->buffer = safe_malloc(PREFETCH_READ_SIZE, thread_context);
+    prefetcher->stop = false;
+    pthread_mutex_init(&prefetcher->mutex, NULL);
+    pthread_cond_init(&prefetcher->cond, NULL);
+
+    if (pthread_create(&prefetcher->thread, NULL, &prefetcher_thread,
+                        prefetcher) != 0) {
+        report_message(thread_context, "mdu: cannot start the prefetcher: %s\n",
+                        strerror(errno));
+        prefetcher->stop = true;
+        prefetcher_stop(prefetcher);
+
+        return NULL;
+    }
+
+    return prefetcher;
+}
+
+
+void prefetcher_stop(Prefetcher* prefetcher) {
+    if (prefetcher == NULL) {
+        return;
+    }
+
+    if (!prefetcher->stop) {
+        pthread_mutex_lock(&prefetcher->mutex);
+        prefetcher->stop = true;
+        pthread_cond_signal(&prefetcher->cond);
+        pthread_mutex_unlock(&prefetcher->mutex);
+
+        pthread_join(prefetcher->thread, NULL);
+    }
+
+    drop_requests(prefetcher);
+    uring_destroy(prefetcher->ring);
+    pthread_mutex_destroy(&prefetcher->mutex);
+    pthread_cond_destroy(&prefetcher->cond);
+    free(prefetcher->buffer);
+    free(prefetcher->done);
+    free(prefetcher->requests);
+    free(prefetcher);
+}
+
+
+uint64_t prefetcher_add(Prefetcher* prefetcher, DirHandle* parent,
+                        const char* name) {
+    uint64_t ticket = atomic_load_explicit(&prefetcher->next_ticket,
+                                            memory_order_relaxed);
+
+    if (ticket - atomic_load_explicit(&prefetcher->completed,
+                                        memory_order_acquire) >=
+            prefetcher->limit || strlen(name) > NAME_MAX) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&prefetcher->mutex);
+    ticket = atomic_load_explicit(&prefetcher->next_ticket,
+                                    memory_order_relaxed);
+
+    if (ticket - atomic_load(&prefetcher->completed) >= prefetcher->limit) {
+        pthread_mutex_unlock(&prefetcher->mutex);
+
+        return 0;
+    }
+
+    struct prefetch_request* request = &prefetcher->requests[ticket &
+                                            (prefetcher->capacity - 1)];
+
+    dir_handle_retain(parent);
+    request->parent = parent;
+    strcpy(request->name, name);
+
+    atomic_store_explicit(&prefetcher->next_ticket, ticket + 1,
+                            memory_order_relaxed);
+    pthread_cond_signal(&prefetcher->cond);
+    pthread_mutex_unlock(&prefetcher->mutex);
+
+    return ticket;
+}
+
+
+bool prefetcher_is_done(const Prefetcher* prefetcher, uint64_t ticket) {
+    return atomic_load_explicit(&prefetcher->done[ticket &
+                                    (prefetcher->capacity - 1)],
+                                memory_order_acquire) >= ticket;
+}
@@ -0,0 +1,137 @@
+/**
+ * @defgroup module_prefetch Prefetcher
+ *
+ * @file prefetch.h
+ * @brief This module implements the datatype Prefetcher.
+ *
+ * With `--prefetch=K` the sub directory's pushed by the workers are opened
+ * ahead of them by a thread of its own, at most K at a time. The
+ * prefetcher opens a batch of directory's with io_uring `OPENAT` requests,
+ * or with `openat` if io_uring is not available, reads their first entry's
+ * and closes them again. The metadata of the directory's is then in the
+ * caches of the kernel when a worker takes their jobs, so a cold directory
+ * on a slow file system costs the worker one round trip less.
+ *
+ * Each prefetched directory is given a ticket that is stored in its job.
+ * A worker taking the job checks if the ticket is done, which is counted
+ * as a hit, or still in flight, which is counted as a miss. The prefetcher
+ * never touches a job, so a job may complete before it is prefetched.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include "job.h"
+#include "uring.h"
+
+#define PREFETCH_MAX 4096
+#define PREFETCH_READ_SIZE (32 * 1024)
+
+/**
+ * @brief A directory to prefetch.
+ *
+ * `parent` is the open parent directory, the request holds a reference of
+ * it.
+*/
+struct prefetch_request {
+    DirHandle* parent;
+    char name[NAME_MAX + 1];
+};
+
+/**
+ * @struct Prefetcher
+ *
+ * @brief Type for the prefetcher.
+ *
+ * The tickets are handed out in order from one, ticket `t` uses request
+ * and slot `t & (capacity - 1)`. `next_ticket` is the next ticket to hand
+ * out and `next_request` the next one the thread takes, both are guarded
+ * by `mutex`. Every ticket below `completed` is done, at most `limit`
+ * tickets are handed out beyond it. `done` holds the last done ticket of
+ * each slot, so a worker checks a ticket without a lock.
+*/
+typedef struct prefetcher {
+    ThreadContext* thread_context;
+    uint64_t limit;
+    uint64_t capacity;
+
+    struct prefetch_request* requests;
+    _Atomic uint64_t* done;
+    alignas(CACHE_LINE_SIZE) _Atomic uint64_t next_ticket;
+    alignas(CACHE_LINE_SIZE) _Atomic uint64_t completed;
+    uint64_t next_request;
+
+    Uring* ring;
+    char* buffer;
+
+    bool stop;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} Prefetcher;
+
+/**
+ * @brief Starts a prefetcher thread.
+ *
+ * The limit is at most half of the directory's that may be held open, so
+ * the prefetched directory's never take the file descriptors the workers
+ * need.
+ *
+ * @param thread_context A pointer to the thread context.
+ * @param limit The most directory's prefetched at a time.
+ * @return Returns the prefetcher; else NULL if the thread cannot be
+ * created.
+ *
+ * @note The prefetcher is stopped and deallocated by `prefetcher_stop()`.
+*/
+Prefetcher* prefetcher_start(ThreadContext* thread_context, int limit);
+
+/**
+ * @brief Stops and deallocates a prefetcher.
+ *
+ * The directory's not yet prefetched are dropped.
+ *
+ * @param prefetcher Pointer to the prefetcher, may be NULL.
+*/
+void prefetcher_stop(Prefetcher* prefetcher);
+
+/**
+ * @brief Hands a directory to the prefetcher.
+ *
+ * The directory is dropped if `limit` directory's are already in flight.
+ *
+ * @param prefetcher Pointer to the prefetcher.
+ * @param parent The open parent directory, the prefetcher takes a
+ * reference of it.
+ * @param name String of the directory's name.
+ * @return Returns the ticket of the directory; else zero if it was dropped.
+*/
+uint64_t prefetcher_add(Prefetcher* prefetcher, DirHandle* parent,
+                        const char* name);
+
+/**
+ * @brief Checks if a directory has been prefetched.
+ *
+ * @param prefetcher Pointer to the prefetcher.
+ * @param ticket The ticket of the directory, not zero.
+ * @return Returns true if the directory is prefetched; else false if it is
+ * still in flight.
+*/
+bool prefetcher_is_done(const Prefetcher* prefetcher, uint64_t ticket);
+
+#endif /* PREFETCH_H */
+
+/**
+ * }
+*/
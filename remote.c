@@ -0,0 +1,1404 @@
+/*
+ * @brief This module implements the distributed scan.
+ *
+ * The coordinator keeps the directory's it traverses itself as nodes, in
+ * the order they are found, so a parent always comes before its children.
+ * The usage of a sub tree is added to the node it was found in, and the
+ * nodes are summed into their parents from the last to the first.
+ *
+ * A worker runs each scan in a child process writing to a memfd, and
+ * follows the parents of the binary file to rebuild the paths.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "remote.h"
+#include "binary_output.h"
+#include "safe_functions.h"
+
+/*
+ * @brief A directory traversed by the coordinator, below the argument
+ * `root`.
+*/
+struct remote_node {
+    char* path;
+    int root;
+    int parent;
+    int depth;
+    Usage usage;
+};
+
+/*
+ * @brief A sub tree handed out to a worker, found in the node `node`.
+*/
+struct remote_task {
+    char* path;
+    int node;
+    int depth;
+};
+
+/*
+ * @brief A connection to a worker.
+ *
+ * `task` is the task the worker is scanning or -1 if it is idle, `fd` is
+ * -1 once the connection is lost. `pid` is the process of a local worker,
+ * else zero.
+*/
+struct remote_peer {
+    int fd;
+    pid_t pid;
+    int task;
+    bool has_records;
+};
+
+/*
+ * @brief The state of the coordinator.
+ *
+ * `queue` holds the tasks not yet handed out, from `queue_head` to
+ * `queue_tail`. A task lost with its worker before any record of it was
+ * received is queued again.
+*/
+typedef struct {
+    ThreadContext* thread_context;
+
+    struct remote_node* nodes;
+    int node_num;
+    int node_capacity;
+
+    struct remote_task* tasks;
+    int task_num;
+    int task_capacity;
+
+    int* queue;
+    int queue_head;
+    int queue_tail;
+    int done;
+
+    struct remote_peer* peers;
+    int peer_num;
+    int live_peers;
+
+    int exit_status;
+} Remote;
+
+/*
+ * @brief A directory read from a binary file.
+*/
+struct remote_entry {
+    uint64_t id;
+    uint64_t parent;
+    uint64_t blocks;
+    uint64_t bytes;
+    uint64_t inodes;
+    const char* name;
+};
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Writes all bytes of a buffer to a socket.
+ *
+ * @param fd The socket.
+ * @param buffer The bytes to write.
+ * @param length The number of bytes.
+ * @return Returns true on success; else false.
+*/
+static bool write_full(int fd, const void* buffer, size_t length) {
+    const char* data = buffer;
+
+    while (length > 0) {
+        ssize_t written = send(fd, data, length, MSG_NOSIGNAL);
+
+        if (written == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (written <= 0) {
+            return false;
+        }
+
+        data += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+/*
+ * @brief Reads exactly `length` bytes from a socket.
+ *
+ * @param fd The socket.
+ * @param buffer The buffer to read into.
+ * @param length The number of bytes.
+ * @return Returns true on success; else false if the socket was closed or
+ * failed.
+*/
+static bool read_full(int fd, void* buffer, size_t length) {
+    char* data = buffer;
+
+    while (length > 0) {
+        ssize_t count = read(fd, data, length);
+
+        if (count == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            return false;
+        }
+
+        data += count;
+        length -= count;
+    }
+
+    return true;
+}
+
+/*
+ * @brief Sends a frame.
+ *
+ * @param fd The socket.
+ * @param header The header of the frame, in host order.
+ * @param path The path of the frame, `header->length` bytes.
+ * @return Returns true on success; else false.
+*/
+static bool send_frame(int fd, const struct remote_header* header,
+                        const char* path) {
+    struct remote_header wire = {
+        .type = htobe32(header->type),
+        .length = htobe32(header->length),
+        .depth = htobe32(header->depth),
+        .flags = htobe32(header->flags)
+    };
+
+    for (int i = 0 ; i < 3 ; i++) {
+        wire.values[i] = htobe64(header->values[i]);
+    }
+
+    return write_full(fd, &wire, sizeof(wire)) &&
+            write_full(fd, path, header->length);
+}
+
+/*
+ * @brief Receives a frame.
+ *
+ * @param fd The socket.
+ * @param header Set to the header of the frame, in host order.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the null terminated path of the frame, it must be freed
+ * by the caller; else NULL if the socket was closed or the frame is
+ * invalid.
+*/
+static char* receive_frame(int fd, struct remote_header* header,
+                            void* in_use_data) {
+    if (!read_full(fd, header, sizeof(*header))) {
+        return NULL;
+    }
+
+    header->type = be32toh(header->type);
+    header->length = be32toh(header->length);
+    header->depth = be32toh(header->depth);
+    header->flags = be32toh(header->flags);
+
+    for (int i = 0 ; i < 3 ; i++) {
+        header->values[i] = be64toh(header->values[i]);
+    }
+
+    if (header->length > REMOTE_MAX_PATH) {
+        return NULL;
+    }
+
+    char* path = safe_malloc(header->length + 1, in_use_data);
+
+    if (!read_full(fd, path, header->length)) {
+        free(path);
+        return NULL;
+    }
+
+    path[header->length] = '\0';
+
+    return path;
+}
+
+/*
+ * @brief Compares two entry's by id, for `qsort()` and `bsearch()`.
+ *
+ * @param a Pointer to the first entry.
+ * @param b Pointer to the second entry.
+ * @return Returns a negative, zero or positive value.
+*/
+static int compare_entries(const void* a, const void* b) {
+    uint64_t x = ((const struct remote_entry*) a)->id;
+    uint64_t y = ((const struct remote_entry*) b)->id;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * @brief Reads the directory's of a binary file in memory.
+ *
+ * @param data The bytes of the file.
+ * @param size The size of the file.
+ * @param count Set to the number of directory's.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the directory's sorted by id, they must be freed by the
+ * caller; else NULL if the file is invalid.
+*/
+static struct remote_entry* read_binary(const char* data, size_t size,
+                                        size_t* count, void* in_use_data) {
+    struct binary_footer footer;
+
+    if (size < sizeof(footer)) {
+        return NULL;
+    }
+
+    memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+
+    if (memcmp(footer.magic, BINARY_FOOTER_MAGIC, sizeof(footer.magic)) != 0 ||
+            footer.index_offset > size - sizeof(footer) ||
+            footer.chunk_count > (size - sizeof(footer) - footer.index_offset) /
+                                    sizeof(struct binary_chunk_index)) {
+        return NULL;
+    }
+
+    struct remote_entry* entries = safe_malloc(
+                    (footer.entry_count + 1) * sizeof(struct remote_entry),
+                    in_use_data);
+    *count = 0;
+
+    for (uint64_t c = 0 ; c < footer.chunk_count ; c++) {
+        struct binary_chunk_index index;
+        struct binary_chunk_header header;
+
+        memcpy(&index, data + footer.index_offset + c * sizeof(index),
+                sizeof(index));
+
+        if (index.offset > size - sizeof(header)) {
+            free(entries);
+            return NULL;
+        }
+
+        memcpy(&header, data + index.offset, sizeof(header));
+
+        size_t columns = index.offset + sizeof(header);
+        size_t strings = columns + header.count * 
+                            (5 * sizeof(uint64_t) + sizeof(uint32_t));
+
+        if (header.count > BINARY_CHUNK_ENTRIES ||
+                *count + header.count > footer.entry_count ||
+                strings + header.string_bytes > size) {
+            free(entries);
+            return NULL;
+        }
+
+        for (uint32_t i = 0 ; i < header.count ; i++) {
+            struct remote_entry* entry = &entries[(*count)++];
+            uint64_t values[5];
+            uint32_t name_offset;
+
+            for (int v = 0 ; v < 5 ; v++) {
+                memcpy(&values[v], data + columns +
+                        (v * header.count + i) * sizeof(uint64_t),
+                        sizeof(uint64_t));
+            }
+
+            memcpy(&name_offset, data + columns + 5 * header.count *
+                    sizeof(uint64_t) + i * sizeof(uint32_t), sizeof(uint32_t));
+
+            if (name_offset >= header.string_bytes ||
+                    memchr(data + strings + name_offset, '\0',
+                            header.string_bytes - name_offset) == NULL) {
+                free(entries);
+                return NULL;
+            }
+
+            *entry = (struct remote_entry) {
+                .id = values[0],
+                .parent = values[1],
+                .blocks = values[2],
+                .bytes = values[3],
+                .inodes = values[4],
+                .name = data + strings + name_offset
+            };
+        }
+    }
+
+    qsort(entries, *count, sizeof(struct remote_entry), compare_entries);
+
+    return entries;
+}
+
+/*
+ * @brief Returns the path of a directory read from a binary file.
+ *
+ * The names are joined the same way as `job_get_path()` joins them.
+ *
+ * @param entries The directory's sorted by id.
+ * @param count The number of directory's.
+ * @param entry Pointer to the directory.
+ * @param depth Set to the number of parents of the directory.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the path, it must be freed by the caller; else NULL if
+ * a parent is missing.
+*/
+static char* entry_path(const struct remote_entry* entries, size_t count,
+                        const struct remote_entry* entry, uint32_t* depth,
+                        void* in_use_data) {
+    const struct remote_entry* e = entry;
+    size_t length = 0;
+
+    *depth = 0;
+
+    for (;;) {
+        length += strlen(e->name) + 1;
+
+        if (e->parent == BINARY_NO_PARENT) {
+            break;
+        }
+
+        struct remote_entry key = {.id = e->parent};
+        e = bsearch(&key, entries, count, sizeof(key), compare_entries);
+
+        if (e == NULL || ++(*depth) > count) {
+            return NULL;
+        }
+    }
+
+    char* path = safe_malloc(length, in_use_data);
+    size_t end = length - 1;
+
+    path[end] = '\0';
+
+    for (e = entry ; ; ) {
+        size_t name_length = strlen(e->name);
+
+        end -= name_length;
+        memcpy(&path[end], e->name, name_length);
+
+        if (e->parent == BINARY_NO_PARENT) {
+            break;
+        }
+
+        struct remote_entry key = {.id = e->parent};
+        e = bsearch(&key, entries, count, sizeof(key), compare_entries);
+
+        if (e->name[strlen(e->name) - 1] != '/') {
+            path[--end] = '/';
+        }
+    }
+
+    if (end > 0) {
+        memmove(path, &path[end], length - end);
+    }
+
+    return path;
+}
+
+/*
+ * @brief Sends a record for every directory of a binary file.
+ *
+ * @param fd The socket of the coordinator.
+ * @param data The bytes of the file.
+ * @param size The size of the file.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns 1 if the file is invalid, -1 if the socket failed; else
+ * zero.
+*/
+static int send_records(int fd, const char* data, size_t size,
+                        void* in_use_data) {
+    size_t count;
+    struct remote_entry* entries = read_binary(data, size, &count, in_use_data);
+    int result = 0;
+
+    if (entries == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0 ; i < count && result == 0 ; i++) {
+        struct remote_header header = {
+            .type = REMOTE_RECORD,
+            .values = {entries[i].blocks, entries[i].bytes, entries[i].inodes}
+        };
+        char* path = entry_path(entries, count, &entries[i], &header.depth,
+                                in_use_data);
+
+        if (path == NULL) {
+            result = 1;
+            break;
+        }
+
+        header.length = strlen(path);
+
+        if (!send_frame(fd, &header, path)) {
+            result = -1;
+        }
+
+        free(path);
+    }
+
+    free(entries);
+
+    return result;
+}
+
+/*
+ * @brief Scans a sub tree in a child process and writes the binary output
+ * to a memfd.
+ *
+ * @param thread_context A pointer to the thread context of the worker.
+ * @param task The header of the task.
+ * @param path The path of the sub tree.
+ * @param status Set to the exit status of the scan.
+ * @param errors_fd The memfd the scan writes its messages to, or -1 to
+ * leave them on stderr.
+ * @return Returns the memfd holding the output, or -1 if the scan failed
+ * before it.
+*/
+static int run_scan(ThreadContext* thread_context,
+                    const struct remote_header* task, const char* path,
+                    int* status, int errors_fd) {
+    Options* options = &thread_context->options;
+    int memfd = memfd_create("mdu-remote", 0);
+    char jobs[16], output[64], depth[32];
+    char* argv[12];
+    int n = 0;
+
+    *status = EXIT_FAILURE;
+
+    if (memfd == -1) {
+        fprintf(stderr, "mdu: cannot create the output of '%s': %s\n", path,
+                strerror(errno));
+        return -1;
+    }
+
+    if (options->auto_threads) {
+        snprintf(jobs, sizeof(jobs), "auto");
+
+    } else {
+        snprintf(jobs, sizeof(jobs), "%d", options->thread_num + 1);
+    }
+
+    snprintf(output, sizeof(output), "--output-file=/proc/self/fd/%d", memfd);
+    snprintf(depth, sizeof(depth), "--max-depth=%" PRId64,
+                (int64_t) task->values[0]);
+
+    argv[n++] = "mdu";
+    argv[n++] = "-j";
+    argv[n++] = jobs;
+    argv[n++] = "--output=binary";
+    argv[n++] = output;
+
+    if (task->flags & REMOTE_FLAG_ONE_FILE_SYSTEM) {
+        argv[n++] = "-x";
+    }
+
+    if ((int64_t) task->values[0] >= 0) {
+        argv[n++] = depth;
+    }
+
+    argv[n++] = "--";
+    argv[n++] = (char*) path;
+    argv[n] = NULL;
+
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        if (errors_fd != -1) {
+            dup2(errors_fd, STDERR_FILENO);
+        }
+
+        execv("/proc/self/exe", argv);
+        fprintf(stderr, "mdu: cannot run the scan of '%s': %s\n", path,
+                strerror(errno));
+        _exit(EXIT_FAILURE);
+    }
+
+    int wait_status;
+
+    if (pid == -1 || waitpid(pid, &wait_status, 0) == -1) {
+        close(memfd);
+        return -1;
+    }
+
+    if (WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == EXIT_SUCCESS) {
+        *status = EXIT_SUCCESS;
+    }
+
+    return memfd;
+}
+
+/*
+ * @brief Sends an error frame for every line written to a memfd.
+ *
+ * @param fd The socket of the coordinator.
+ * @param errors_fd The memfd holding the messages.
+ * @return Returns true on success; else false if the socket failed.
+*/
+static bool send_errors(int fd, int errors_fd) {
+    struct stat file_info;
+
+    if (fstat(errors_fd, &file_info) == -1 || file_info.st_size == 0) {
+        return true;
+    }
+
+    char* data = mmap(NULL, file_info.st_size, PROT_READ, MAP_PRIVATE,
+                        errors_fd, 0);
+    bool sent = true;
+
+    if (data == MAP_FAILED) {
+        return true;
+    }
+
+    for (size_t start = 0 ; start < (size_t) file_info.st_size && sent ; ) {
+        const char* newline = memchr(&data[start], '\n',
+                                        file_info.st_size - start);
+        size_t end = newline != NULL ? (size_t) (newline - data) :
+                                        (size_t) file_info.st_size;
+        struct remote_header header = {
+            .type = REMOTE_ERROR,
+            .length = end - start < REMOTE_MAX_PATH ?
+                        end - start : REMOTE_MAX_PATH
+        };
+
+        sent = send_frame(fd, &header, &data[start]);
+        start = end + 1;
+    }
+
+    munmap(data, file_info.st_size);
+
+    return sent;
+}
+
+/*
+ * @brief Scans the sub tree of a task and sends its records and the
+ * messages of the scan to the coordinator.
+ *
+ * @param thread_context A pointer to the thread context of the worker.
+ * @param fd The socket of the coordinator.
+ * @param task The header of the task.
+ * @param path The path of the sub tree.
+ * @return Returns true on success; else false if the socket failed.
+*/
+static bool run_task(ThreadContext* thread_context, int fd,
+                        const struct remote_header* task, const char* path) {
+    int status;
+    int errors_fd = memfd_create("mdu-remote-errors", MFD_CLOEXEC);
+    int memfd = run_scan(thread_context, task, path, &status, errors_fd);
+    struct stat file_info;
+
+    if (memfd != -1 && fstat(memfd, &file_info) == 0 && file_info.st_size > 0) {
+        char* data = mmap(NULL, file_info.st_size, PROT_READ, MAP_PRIVATE,
+                            memfd, 0);
+
+        if (data != MAP_FAILED) {
+            int result = send_records(fd, data, file_info.st_size,
+                                        thread_context);
+
+            munmap(data, file_info.st_size);
+
+            if (result == -1) {
+                close(memfd);
+                close(errors_fd);
+                return false;
+            }
+
+            if (result != 0) {
+                status = EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (memfd != -1) {
+        close(memfd);
+    }
+
+    if (errors_fd != -1) {
+        bool sent = send_errors(fd, errors_fd);
+
+        close(errors_fd);
+
+        if (!sent) {
+            return false;
+        }
+    }
+
+    struct remote_header done = {
+        .type = REMOTE_DONE,
+        .values = {status}
+    };
+
+    return send_frame(fd, &done, "");
+}
+
+/*
+ * @brief Serves the tasks of a coordinator until the connection is closed.
+ *
+ * @param thread_context A pointer to the thread context of the worker.
+ * @param fd The socket of the coordinator.
+*/
+static void serve_connection(ThreadContext* thread_context, int fd) {
+    struct remote_header header;
+    char* path;
+
+    while ((path = receive_frame(fd, &header, thread_context)) != NULL) {
+        bool served = header.type == REMOTE_TASK &&
+                        run_task(thread_context, fd, &header, path);
+
+        free(path);
+
+        if (!served) {
+            break;
+        }
+    }
+}
+
+/*
+ * @brief Adds a node to the coordinator.
+ *
+ * @param remote Pointer to the coordinator.
+ * @param path String of the path, the node takes ownership of it.
+ * @param root The index of the argument the node is below.
+ * @param parent The index of the parent node, or -1 for a root.
+ * @param depth The level of the node below its root.
+ * @param usage The usage counted for the node so far.
+*/
+static void add_node(Remote* remote, char* path, int root, int parent, 
+                        int depth, const Usage* usage) {
+    if (remote->node_num == remote->node_capacity) {
+        remote->node_capacity = remote->node_capacity > 0 ?
+                                remote->node_capacity * 2 : 64;
+        remote->nodes = safe_realloc(remote->nodes,
+                    remote->node_capacity * sizeof(struct remote_node),
+                    remote->thread_context);
+    }
+
+    remote->nodes[remote->node_num++] = (struct remote_node) {
+        .path = path,
+        .root = root,
+        .parent = parent,
+        .depth = depth,
+        .usage = *usage
+    };
+}
+
+/*
+ * @brief Adds a task to the coordinator.
+ *
+ * @param remote Pointer to the coordinator.
+ * @param path String of the path, the task takes ownership of it.
+ * @param node The index of the node the sub tree was found in.
+ * @param depth The level of the sub tree below its root.
+*/
+static void add_task(Remote* remote, char* path, int node, int depth) {
+    if (remote->task_num == remote->task_capacity) {
+        remote->task_capacity = remote->task_capacity > 0 ?
+                                remote->task_capacity * 2 : 64;
+        remote->tasks = safe_realloc(remote->tasks,
+                    remote->task_capacity * sizeof(struct remote_task),
+                    remote->thread_context);
+    }
+
+    remote->tasks[remote->task_num++] = (struct remote_task) {
+        .path = path,
+        .node = node,
+        .depth = depth
+    };
+}
+
+/*
+ * @brief Joins the path of a directory and the name of an entry.
+ *
+ * @param path String of the path.
+ * @param name String of the name.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the joined path, it must be freed by the caller.
+*/
+static char* join_path(const char* path, const char* name, void* in_use_data) {
+    size_t path_length = strlen(path);
+    size_t length = path_length + strlen(name) + 2;
+    char* joined = safe_malloc(length, in_use_data);
+    bool has_separator = path_length > 0 && path[path_length - 1] == '/';
+
+    snprintf(joined, length, "%s%s%s", path, has_separator ? "" : "/", name);
+
+    return joined;
+}
+
+/*
+ * @brief Reads a node of the coordinator.
+ *
+ * The files are counted in the node. A sub directory above `remote_depth`
+ * becomes a node of its own, a sub directory at it becomes a task.
+ *
+ * @param remote Pointer to the coordinator.
+ * @param index The index of the node.
+*/
+static void expand_node(Remote* remote, int index) {
+    ThreadContext* thread_context = remote->thread_context;
+    Options* options = &thread_context->options;
+    struct remote_node* node = &remote->nodes[index];
+    dev_t dev = thread_context->coordinator[node->root]->dev;
+    DIR* directory = opendir(node->path);
+    struct dirent* entry;
+    struct stat file_info;
+
+    if (directory == NULL) {
+        report_error(thread_context, &thread_context->errors,
+                        "du: cannot read directory '%s': %s\n", node->path,
+                        strerror(errno));
+        return;
+    }
+
+    /* `readdir` only sets errno on an error, not at the end. */
+    while ((errno = 0, entry = readdir(directory)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        node = &remote->nodes[index];
+        char* path = join_path(node->path, entry->d_name, thread_context);
+
+        if (fstatat(dirfd(directory), entry->d_name, &file_info,
+                    AT_SYMLINK_NOFOLLOW) == -1) {
+            report_error(thread_context, &thread_context->errors,
+                            "du: cannot access '%s': %s\n", path,
+                            strerror(errno));
+            free(path);
+            continue;
+        }
+
+        if (!S_ISDIR(file_info.st_mode)) {
+            usage_add_file(&node->usage, &file_info);
+            free(path);
+
+        } else if (options->one_file_system && file_info.st_dev != dev) {
+            free(path);
+
+        } else if (node->depth + 1 < options->remote_depth) {
+            Usage usage = {0};
+
+            usage_add_file(&usage, &file_info);
+            add_node(remote, path, node->root, index, node->depth + 1, &usage);
+
+        } else {
+            add_task(remote, path, index, node->depth + 1);
+        }
+    }
+
+    if (errno != 0) {
+        report_error(thread_context, &thread_context->errors,
+                        "du: cannot read directory '%s': %s\n", 
+                        remote->nodes[index].path, strerror(errno));
+    }
+
+    closedir(directory);
+}
+
+/*
+ * @brief Splits an address `host:port` in place, the host may be in `[]`.
+ *
+ * @param spec String of the address.
+ * @param host Set to the host; else NULL if the address has no host.
+ * @return Returns the port.
+*/
+static char* split_address(char* spec, char** host) {
+    char* separator = strrchr(spec, ':');
+
+    if (separator == NULL) {
+        *host = NULL;
+        return spec;
+    }
+
+    *separator = '\0';
+    *host = spec;
+
+    if (spec[0] == '[' && separator > spec && separator[-1] == ']') {
+        (*host)++;
+        separator[-1] = '\0';
+    }
+
+    if (**host == '\0') {
+        *host = NULL;
+    }
+
+    return separator + 1;
+}
+
+/*
+ * @brief Connects to a worker given as `host:port`.
+ *
+ * @param remote Pointer to the coordinator.
+ * @param spec String of the host and the port, the host may be in `[]`.
+ * @return Returns the socket; else -1 with the error reported.
+*/
+static int connect_peer(Remote* remote, char* spec) {
+    ThreadContext* thread_context = remote->thread_context;
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo* addresses;
+    char* host;
+    int fd = -1;
+    int error;
+
+    if (strchr(spec, ':') == NULL) {
+        report_error(thread_context, &thread_context->errors,
+                        "mdu: invalid worker '%s'\n", spec);
+        return -1;
+    }
+
+    char* port = split_address(spec, &host);
+
+    error = getaddrinfo(host, port, &hints, &addresses);
+
+    if (error != 0) {
+        report_error(thread_context, &thread_context->errors,
+                        "mdu: cannot resolve worker '%s': %s\n", host,
+                        gai_strerror(error));
+        return -1;
+    }
+
+    for (struct addrinfo* a = addresses ; a != NULL && fd == -1 ; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+        error = errno;
+
+        if (fd != -1 && connect(fd, a->ai_addr, a->ai_addrlen) == -1) {
+            error = errno;
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    freeaddrinfo(addresses);
+
+    if (fd == -1) {
+        report_error(thread_context, &thread_context->errors,
+                        "mdu: cannot connect to worker '%s': %s\n", host,
+                        strerror(error));
+    }
+
+    return fd;
+}
+
+/*
+ * @brief Adds a connected worker to the coordinator.
+ *
+ * @param remote Pointer to the coordinator.
+ * @param fd The socket of the worker.
+ * @param pid The process of a local worker, else zero.
+*/
+static void add_peer(Remote* remote, int fd, pid_t pid) {
+    remote->peers = safe_realloc(remote->peers,
+                        (remote->peer_num + 1) * sizeof(struct remote_peer),
+                        remote->thread_context);
+    remote->peers[remote->peer_num++] = (struct remote_peer) {
+        .fd = fd,
+        .pid = pid,
+        .task = -1,
+        .has_records = false
+    };
+    remote->live_peers++;
+}
+
+/*
+ * @brief Forks a local worker connected over a socketpair.
+ *
+ * @param remote Pointer to the coordinator.
+*/
+static void start_local_peer(Remote* remote) {
+    ThreadContext* thread_context = remote->thread_context;
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) {
+        report_error(thread_context, &thread_context->errors,
+                        "mdu: cannot create a local worker: %s\n",
+                        strerror(errno));
+        return;
+    }
+
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        close(fds[0]);
+
+        for (int i = 0 ; i < remote->peer_num ; i++) {
+            close(remote->peers[i].fd);
+        }
+
+        serve_connection(thread_context, fds[1]);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fds[1]);
+
+    if (pid == -1) {
+        report_error(thread_context, &thread_context->errors,
+                        "mdu: cannot create a local worker: %s\n",
+                        strerror(errno));
+        close(fds[0]);
+        return;
+    }
+
+    add_peer(remote, fds[0], pid);
+}
+
+/*
+ * @brief Connects the workers of `--remote` and forks those of
+ * `--local-workers`.
+ *
+ * @param remote Pointer to the coordinator.
+*/
+static void start_peers(Remote* remote) {
+    ThreadContext* thread_context = remote->thread_context;
+    Options* options = &thread_context->options;
+
+    if (options->remote != NULL) {
+        char* list = safe_malloc(strlen(options->remote) + 1, thread_context);
+        char* save;
+
+        strcpy(list, options->remote);
+
+        for (char* spec = strtok_r(list, ",", &save) ; spec != NULL ;
+                spec = strtok_r(NULL, ",", &save)) {
+            int fd = connect_peer(remote, spec);
+
+            if (fd != -1) {
+                add_peer(remote, fd, 0);
+            }
+        }
+
+        free(list);
+    }
+
+    for (int i = 0 ; i < options->local_workers ; i++) {
+        start_local_peer(remote);
+    }
+}
+
+/*
+ * @brief Hands out the queued tasks to the idle workers.
+ *
+ * @param remote Pointer to the coordinator.
+*/
+static void dispatch_tasks(Remote* remote) {
+    Options* options = &remote->thread_context->options;
+
+    for (int i = 0 ; i < remote->peer_num && remote->queue_head < remote->queue_tail ;
+            i++) {
+        struct remote_peer* peer = &remote->peers[i];
+
+        if (peer->fd == -1 || peer->task != -1) {
+            continue;
+        }
+
+        int index = remote->queue[remote->queue_head++];
+        struct remote_task* task = &remote->tasks[index];
+        int64_t depth = 0;
+
+        if (remote->thread_context->breakdown != NULL && options->max_depth < 0) {
+            depth = -1;
+
+        } else if (remote->thread_context->breakdown != NULL &&
+                    options->max_depth > task->depth) {
+            depth = options->max_depth - task->depth;
+        }
+
+        struct remote_header header = {
+            .type = REMOTE_TASK,
+            .length = strlen(task->path),
+            .flags = options->one_file_system ? REMOTE_FLAG_ONE_FILE_SYSTEM : 0,
+            .values = {depth}
+        };
+
+        peer->task = index;
+        peer->has_records = false;
+
+        if (!send_frame(peer->fd, &header, task->path)) {
+            remote->queue[--remote->queue_head] = index;
+            peer->task = -1;
+            close(peer->fd);
+            peer->fd = -1;
+            remote->live_peers--;
+        }
+    }
+}
+
+/*
+ * @brief Handles a lost worker.
+ *
+ * Its task is queued again, unless some of it was already counted.
+ *
+ * @param remote Pointer to the coordinator.
+ * @param peer Pointer to the worker.
+*/
+static void lose_peer(Remote* remote, struct remote_peer* peer) {
+    ThreadContext* thread_context = remote->thread_context;
+
+    close(peer->fd);
+    peer->fd = -1;
+    remote->live_peers--;
+
+    if (peer->task == -1) {
+        return;
+    }
+
+    if (peer->has_records) {
+        report_error(thread_context, &thread_context->errors,
+                        "mdu: lost the worker scanning '%s'\n",
+                        remote->tasks[peer->task].path);
+        remote->exit_status = EXIT_FAILURE;
+        remote->done++;
+
+    } else {
+        remote->queue[remote->queue_tail++] = peer->task;
+    }
+
+    peer->task = -1;
+}
+
+/*
+ * @brief Receives a frame from a worker.
+ *
+ * @param remote Pointer to the coordinator.
+ * @param peer Pointer to the worker.
+*/
+static void receive_result(Remote* remote, struct remote_peer* peer) {
+    ThreadContext* thread_context = remote->thread_context;
+    Options* options = &thread_context->options;
+    struct remote_header header;
+    char* path = receive_frame(peer->fd, &header, thread_context);
+
+    if (path == NULL || peer->task == -1 || (header.type != REMOTE_RECORD &&
+            header.type != REMOTE_DONE && header.type != REMOTE_ERROR)) {
+        free(path);
+        lose_peer(remote, peer);
+        return;
+    }
+
+    if (header.type == REMOTE_ERROR) {
+        report_error(thread_context, &thread_context->errors, "%s\n", path);
+        free(path);
+        return;
+    }
+
+    struct remote_task* task = &remote->tasks[peer->task];
+
+    if (header.type == REMOTE_DONE) {
+        if (header.values[0] != EXIT_SUCCESS) {
+            remote->exit_status = EXIT_FAILURE;
+        }
+
+        peer->task = -1;
+        remote->done++;
+        free(path);
+        return;
+    }
+
+    Usage usage = {
+        .blocks = header.values[0],
+        .bytes = header.values[1],
+        .inodes = header.values[2]
+    };
+    int depth = task->depth + header.depth;
+
+    peer->has_records = true;
+
+    if (header.depth == 0) {
+        usage_add(&remote->nodes[task->node].usage, &usage);
+    }
+
+    if (thread_context->breakdown != NULL &&
+            (options->max_depth < 0 || depth <= options->max_depth)) {
+        breakdown_add(thread_context->breakdown,
+                        usage_reported_value(&usage, options), path);
+        return;
+    }
+
+    free(path);
+}
+
+/*
+ * @brief Hands out the tasks and receives the results until every task is
+ * done or no worker is left.
+ *
+ * @param remote Pointer to the coordinator.
+*/
+static void run_tasks(Remote* remote) {
+    ThreadContext* thread_context = remote->thread_context;
+    struct pollfd* fds = safe_malloc((remote->peer_num + 1) * sizeof(struct pollfd),
+                                        thread_context);
+    int* owners = safe_malloc((remote->peer_num + 1) * sizeof(int),
+                                thread_context);
+
+    while (remote->done < remote->task_num && remote->live_peers > 0 &&
+            !atomic_load(&thread_context->aborted)) {
+        int count = 0;
+
+        dispatch_tasks(remote);
+
+        for (int i = 0 ; i < remote->peer_num ; i++) {
+            if (remote->peers[i].fd != -1 && remote->peers[i].task != -1) {
+                fds[count] = (struct pollfd) {remote->peers[i].fd, POLLIN, 0};
+                owners[count++] = i;
+            }
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        if (poll(fds, count, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0 ; i < count ; i++) {
+            struct remote_peer* peer = &remote->peers[owners[i]];
+
+            if (fds[i].revents != 0 && peer->fd != -1) {
+                receive_result(remote, peer);
+            }
+        }
+    }
+
+    if (remote->done < remote->task_num &&
+            !atomic_load(&thread_context->aborted)) {
+        report_error(thread_context, &thread_context->errors,
+                        "mdu: no workers left, %d sub trees are not scanned\n",
+                        remote->task_num - remote->done);
+        remote->exit_status = EXIT_FAILURE;
+    }
+
+    free(fds);
+    free(owners);
+}
+
+/*
+ * @brief Closes the connections and waits for the local workers.
+ *
+ * @param remote Pointer to the coordinator.
+*/
+static void stop_peers(Remote* remote) {
+    for (int i = 0 ; i < remote->peer_num ; i++) {
+        if (remote->peers[i].fd != -1) {
+            close(remote->peers[i].fd);
+        }
+    }
+
+    for (int i = 0 ; i < remote->peer_num ; i++) {
+        if (remote->peers[i].pid > 0) {
+            waitpid(remote->peers[i].pid, NULL, 0);
+        }
+    }
+}
+
+/*
+ * @brief Sums the nodes into their parents and the roots into the
+ * coordinators, and adds the reported nodes to the breakdown.
+ *
+ * @param remote Pointer to the coordinator.
+*/
+static void finish_nodes(Remote* remote) {
+    ThreadContext* thread_context = remote->thread_context;
+    Options* options = &thread_context->options;
+
+    for (int i = remote->node_num - 1 ; i >= 0 ; i--) {
+        struct remote_node* node = &remote->nodes[i];
+
+        if (node->parent >= 0) {
+            usage_add(&remote->nodes[node->parent].usage, &node->usage);
+
+        } else {
+            thread_context->coordinator[node->root]->total = node->usage;
+        }
+
+        if (thread_context->breakdown != NULL &&
+                (options->max_depth < 0 || node->depth <= options->max_depth)) {
+            breakdown_add(thread_context->breakdown,
+                            usage_reported_value(&node->usage, options),
+                            node->path);
+            node->path = NULL;
+        }
+    }
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+int remote_scan(ThreadContext* thread_context) {
+    Remote remote = {
+        .thread_context = thread_context,
+        .exit_status = EXIT_SUCCESS
+    };
+
+    for (int i = 0 ; i < thread_context->dir_num ; i++) {
+        Coordinator* coordinator = thread_context->coordinator[i];
+        char* path = safe_malloc(strlen(coordinator->path) + 1, thread_context);
+
+        strcpy(path, coordinator->path);
+        add_node(&remote, path, i, -1, 0, &coordinator->total);
+    }
+
+    for (int i = 0 ; i < remote.node_num &&
+            !atomic_load(&thread_context->aborted) ; i++) {
+        expand_node(&remote, i);
+    }
+
+    remote.queue = safe_malloc((remote.task_num + 1) * sizeof(int), thread_context);
+
+    for (int i = 0 ; i < remote.task_num ; i++) {
+        remote.queue[remote.queue_tail++] = i;
+    }
+
+    if (remote.task_num > 0) {
+        start_peers(&remote);
+        run_tasks(&remote);
+        stop_peers(&remote);
+    }
+
+    finish_nodes(&remote);
+
+    for (int i = 0 ; i < remote.node_num ; i++) {
+        free(remote.nodes[i].path);
+    }
+
+    for (int i = 0 ; i < remote.task_num ; i++) {
+        free(remote.tasks[i].path);
+    }
+
+    free(remote.nodes);
+    free(remote.tasks);
+    free(remote.queue);
+    free(remote.peers);
+
+    return remote.exit_status;
+}
+
+
+int remote_serve(ThreadContext* thread_context) {
+    const char* serve = thread_context->options.serve;
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo* addresses;
+    char spec[strlen(serve) + 1];
+    char* host;
+    int listener = -1;
+    int on = 1;
+    int off = 0;
+
+    strcpy(spec, serve);
+
+    char* port = split_address(spec, &host);
+    int error = getaddrinfo(host != NULL ? host : REMOTE_DEFAULT_HOST, port, 
+                            &hints, &addresses);
+
+    if (error != 0) {
+        fprintf(stderr, "mdu: invalid address '%s': %s\n", serve, 
+                gai_strerror(error));
+        return EXIT_FAILURE;
+    }
+
+    /* An IPv6 socket that also accepts IPv4 is tried first. */
+    for (int pass = 0 ; pass < 2 && listener == -1 ; pass++) {
+        for (struct addrinfo* a = addresses ; a != NULL && listener == -1 ;
+                a = a->ai_next) {
+            if ((pass == 0) != (a->ai_family == AF_INET6)) {
+                continue;
+            }
+
+            listener = socket(a->ai_family, 
+                                a->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                                a->ai_protocol);
+
+            if (listener == -1) {
+                error = errno;
+                continue;
+            }
+
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+            if (a->ai_family == AF_INET6) {
+                setsockopt(listener, IPPROTO_IPV6, IPV6_V6ONLY, &off, 
+                            sizeof(off));
+            }
+
+            if (bind(listener, a->ai_addr, a->ai_addrlen) == -1 ||
+                    listen(listener, 16) == -1) {
+                error = errno;
+                close(listener);
+                listener = -1;
+            }
+        }
+    }
+
+    freeaddrinfo(addresses);
+
+    if (listener == -1) {
+        fprintf(stderr, "mdu: cannot listen on '%s': %s\n", serve,
+                strerror(error));
+        return EXIT_FAILURE;
+    }
+
+    for (;;) {
+        struct pollfd ready = {.fd = listener, .events = POLLIN};
+
+        while (waitpid(-1, NULL, WNOHANG) > 0) {
+        }
+
+        /* The timeout wakes an idle server to reap its processes. */
+        if (poll(&ready, 1, REMOTE_REAP_INTERVAL) <= 0) {
+            continue;
+        }
+
+        int fd = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+
+        /* Out of descriptors or memory, the connection stays queued. */
+        if (fd == -1) {
+            if (errno != EINTR && errno != ECONNABORTED && errno != EAGAIN) {
+                poll(NULL, 0, REMOTE_ACCEPT_BACKOFF);
+            }
+            continue;
+        }
+
+        pid_t pid = fork();
+
+        if (pid == 0) {
+            close(listener);
+            serve_connection(thread_context, fd);
+            _exit(EXIT_SUCCESS);
+        }
+
+        if (pid == -1) {
+            fprintf(stderr, "mdu: cannot serve a coordinator: %s\n",
+                    strerror(errno));
+            poll(NULL, 0, REMOTE_ACCEPT_BACKOFF);
+        }
+
+        close(fd);
+    }
+
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+/**
+ * @defgroup module_remote Remote
+ *
+ * @file remote.h
+ * @brief This module implements the distributed scan.
+ *
+ * The coordinator traverses the top `remote_depth` levels of each argument
+ * itself and hands the directory's below them out as sub trees to worker
+ * processes, either `mdu --serve=ADDR:PORT` on other nodes over TCP or local
+ * processes forked with `--local-workers=N` over a socketpair. Each worker
+ * is given a new sub tree when it reports the last one done, so a worker
+ * that finishes early is kept busy while the others are still scanning.
+ *
+ * The protocol is a stream of frames, each a `struct remote_header`
+ * followed by `length` bytes of path. The coordinator sends a
+ * `REMOTE_TASK`, the worker answers with a `REMOTE_RECORD` for every
+ * reported directory of the sub tree and a `REMOTE_ERROR` for every
+ * message of the scan, and ends with a `REMOTE_DONE`. The coordinator
+ * prints the messages and counts them as its own errors. The fields of
+ * the header are sent in big-endian order.
+ *
+ * There is no authentication. A worker scans any path a coordinator names
+ * and sends the names of its directory's back, with the rights of the
+ * user it runs as. `--serve=PORT` therefore only listens on
+ * `REMOTE_DEFAULT_HOST`, another address such as `--serve=0.0.0.0:PORT`
+ * should only be given on a trusted network.
+ *
+ * A worker scans a sub tree by running `mdu --output=binary` on it, and
+ * passes the raw 64-bit usage of each directory on, so the coordinator
+ * sums exactly what a single process would have counted.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef REMOTE_H
+#define REMOTE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "thread_context.h"
+
+#define REMOTE_TASK 1
+#define REMOTE_RECORD 2
+#define REMOTE_DONE 3
+#define REMOTE_ERROR 4
+
+#define REMOTE_FLAG_ONE_FILE_SYSTEM 1
+#define REMOTE_MAX_PATH (1024 * 1024)
+#define REMOTE_DEFAULT_HOST "127.0.0.1"
+#define REMOTE_ACCEPT_BACKOFF 100
+#define REMOTE_REAP_INTERVAL 1000
+
+/**
+ * @brief The header of a frame.
+ *
+ * For a `REMOTE_TASK`, `values[0]` is the deepest level below the sub tree
+ * to report, zero for only the sub tree itself or -1 for every level, and
+ * `flags` holds the `REMOTE_FLAG_` options. For a `REMOTE_RECORD`,
+ * `depth` is the level of the directory below the sub tree and `values`
+ * its blocks, bytes and inodes. For a `REMOTE_ERROR`, the path is the
+ * message without its newline. For a `REMOTE_DONE`, `values[0]` is the
+ * exit status of the scan.
+*/
+struct remote_header {
+    uint32_t type;
+    uint32_t length;
+    uint32_t depth;
+    uint32_t flags;
+    uint64_t values[3];
+};
+
+/**
+ * @brief Scans the arguments of the thread context with the remote workers.
+ *
+ * The coordinators must be created by `traverse_input_arguments()`. When
+ * the function returns, the total of each coordinator is set and the
+ * reported directory's are added to the breakdown, if there is one.
+ *
+ * @param thread_context A pointer to the thread context.
+ * @return Returns `EXIT_SUCCESS` if every sub tree was scanned without
+ * errors; else `EXIT_FAILURE`.
+*/
+int remote_scan(ThreadContext* thread_context);
+
+/**
+ * @brief Serves coordinators on the address of `--serve`.
+ *
+ * Each connection is served by a process of its own, so several
+ * coordinators are served at once, each scan with the threads of `-j`. A
+ * failed accept is retried after `REMOTE_ACCEPT_BACKOFF` milliseconds.
+ * The processes that are done are reaped at least every 
+ * `REMOTE_REAP_INTERVAL` milliseconds, also while no coordinator connects.
+ * The function only returns if the address cannot be listened on.
+ *
+ * @param thread_context A pointer to the thread context holding the
+ * options of the worker.
+ * @return Returns `EXIT_FAILURE`.
+*/
+int remote_serve(ThreadContext* thread_context);
+
+#endif /* REMOTE_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,155 @@
+/*
+ * @brief This module implements the datatype Reporter.
+ *
+ * The reporter sleeps on a condition variable of its own with a timeout,
+ * so it can be stopped at once instead of after the end of an interval.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <time.h>
+#include <inttypes.h>
+
+#include "reporter.h"
+#include "safe_functions.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Prints the progress of the traversal.
+ *
+ * The rate is the number of entries counted since the last report.
+ *
+ * @param reporter Pointer to the reporter.
+ * @param totals The current counters of the workers.
+ * @param now The current time, from `stats_now()`.
+*/
+static void report_progress(Reporter* reporter, const StatsTotals* totals,
+                            uint64_t now) {
+    ThreadContext* thread_context = reporter->thread_context;
+    double interval = (now - reporter->last_time) / 1e9;
+    double rate = interval > 0 ? 
+                    (totals->entries - reporter->last_entries) / interval : 0;
+    int idle = atomic_load_explicit(&thread_context->idle_threads, 
+                                    memory_order_relaxed) + 
+                atomic_load_explicit(&thread_context->parked_threads, 
+                                    memory_order_relaxed);
+    long queued = atomic_load_explicit(&thread_context->queued_jobs, 
+                                        memory_order_relaxed);
+
+    fprintf(stderr, "mdu: progress: %.1f s, %" PRIu64 " entries (%.0f/s), %" 
+            PRIu64 " blocks, %ld queued, %d/%d threads active\n", 
+            (now - reporter->start) / 1e9, totals->entries, rate, 
+            totals->blocks, queued > 0 ? queued : 0, 
+            thread_context->worker_num - idle, thread_context->worker_num);
+
+    reporter->last_entries = totals->entries;
+    reporter->last_time = now;
+}
+
+/*
+ * @brief Prints the current counters of the workers.
+ *
+ * @param reporter Pointer to the reporter.
+*/
+static void report(Reporter* reporter) {
+    StatsTotals totals;
+    uint64_t now = stats_now();
+
+    collect_stats(reporter->thread_context, &totals);
+
+    if (reporter->progress) {
+        report_progress(reporter, &totals, now);
+
+    } else {
+        stats_print_json(&totals, (now - reporter->start) / 1e9, false, stderr);
+    }
+}
+
+/*
+ * @brief The main function of the reporter thread.
+ *
+ * @param arg Pointer to the reporter.
+ * @return Returns NULL.
+*/
+static void* reporter_handler(void* arg) {
+    Reporter* reporter = arg;
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    pthread_mutex_lock(&reporter->mutex);
+
+    while (!reporter->stop) {
+        deadline.tv_sec += reporter->interval / 1000;
+        deadline.tv_nsec += (reporter->interval % 1000) * 1000000;
+
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        while (!reporter->stop && pthread_cond_timedwait(&reporter->cond, 
+                    &reporter->mutex, &deadline) == 0) {
+        }
+
+        if (!reporter->stop) {
+            report(reporter);
+        }
+    }
+
+    pthread_mutex_unlock(&reporter->mutex);
+
+    return NULL;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Reporter* reporter_start(ThreadContext* thread_context, long interval,
+                            uint64_t start, bool progress) {
+    Reporter* reporter = safe_malloc(sizeof(Reporter), thread_context);
+    pthread_condattr_t attr;
+
+    reporter->thread_context = thread_context;
+    reporter->interval = interval;
+    reporter->start = start;
+    reporter->progress = progress;
+    reporter->last_entries = 0;
+    reporter->last_time = start;
+    reporter->stop = false;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&reporter->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&reporter->mutex, NULL);
+
+    if (pthread_create(&reporter->thread, NULL, reporter_handler, 
+                        reporter) != 0) {
+        fprintf(stderr, "mdu: cannot start the reporter thread\n");
+        pthread_cond_destroy(&reporter->cond);
+        pthread_mutex_destroy(&reporter->mutex);
+        free(reporter);
+
+        return NULL;
+    }
+
+    return reporter;
+}
+
+
+void reporter_stop(Reporter* reporter) {
+    if (reporter == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&reporter->mutex);
+    reporter->stop = true;
+    pthread_cond_signal(&reporter->cond);
+    pthread_mutex_unlock(&reporter->mutex);
+
+    pthread_join(reporter->thread, NULL);
+    pthread_cond_destroy(&reporter->cond);
+    pthread_mutex_destroy(&reporter->mutex);
+    free(reporter);
+}
@@ -0,0 +1,76 @@
+/**
+ * @defgroup module_reporter Reporter
+ *
+ * @file reporter.h
+ * @brief This module implements the datatype Reporter.
+ *
+ * A reporter is a thread of its own that wakes up at a fixed interval while
+ * the workers run. It sums the counters of the workers with relaxed loads
+ * and prints them to stderr, either as a JSON line of stats or as a line of
+ * progress. The workers never wait for the reporter.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef REPORTER_H
+#define REPORTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "thread_context.h"
+
+/**
+ * @brief The type for the reporter.
+ *
+ * `start` is the time the traversal started, from `stats_now()`. If 
+ * `progress` is set, progress is reported instead of the stats, 
+ * `last_entries` and `last_time` are then the entry's counted and the time 
+ * at the last report.
+*/
+typedef struct {
+    ThreadContext* thread_context;
+    long interval;
+    uint64_t start;
+    bool progress;
+
+    uint64_t last_entries;
+    uint64_t last_time;
+
+    bool stop;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} Reporter;
+
+/**
+ * @brief Starts a reporter thread.
+ *
+ * @param thread_context A pointer to the thread context, the workers must
+ * be created.
+ * @param interval The time between two reports, in milliseconds.
+ * @param start The time the traversal started, from `stats_now()`.
+ * @param progress If progress should be reported instead of the stats.
+ * @return Returns the reporter; else NULL if the thread cannot be created.
+ *
+ * @note The reporter is stopped and deallocated by `reporter_stop()`.
+*/
+Reporter* reporter_start(ThreadContext* thread_context, long interval,
+                            uint64_t start, bool progress);
+
+/**
+ * @brief Stops the reporter thread and deallocates the reporter.
+ *
+ * @param reporter Pointer to the reporter, may be NULL.
+*/
+void reporter_stop(Reporter* reporter);
+
+#endif /* REPORTER_H */
+
+/**
+ * }
+*/
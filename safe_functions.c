@@ -14,13 +14,39 @@
 
 #include "safe_functions.h"
 
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+static __thread jmp_buf* recovery_point = NULL;
+
+/*
+ * @brief Handles a failed allocation.
+ * 
+ * @param function String of the name of the failed function.
+ * @param in_use_data A pointer to data that should be destroyed.
+*/
+static _Noreturn void allocation_failed(const char* function, 
+                                        void* in_use_data) {
+    if (recovery_point != NULL) {
+        longjmp(*recovery_point, 1);
+    }
+
+    fprintf(stderr, "%s failed to allocate memory\n", function);
+    thread_context_destroy(in_use_data);
+    exit(EXIT_FAILURE);
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+void safe_set_recovery(jmp_buf* recovery) {
+    recovery_point = recovery;
+}
+
+
 void* safe_malloc(size_t size, void* in_use_data) {
     char *ptr;
 
     if ((ptr = malloc(size)) == NULL) {
-        fprintf(stderr, "malloc() failed to allocate memory\n");
-        thread_context_destroy(in_use_data);
-        exit(EXIT_FAILURE);
+        allocation_failed("malloc()", in_use_data);
     }
 
     return ptr;
@@ -31,51 +57,37 @@ void* safe_calloc(size_t __nmemb, size_t size, void* in_use_data) {
     char *ptr;
     
     if ((ptr = calloc(__nmemb, size)) == NULL) {
-        fprintf(stderr, "calloc() failed to allocate memory\n");
-        thread_context_destroy(in_use_data);
-        exit(EXIT_FAILURE);
+        allocation_failed("calloc()", in_use_data);
     }
 
     return ptr;
 }
 
 
-void* safe_realloc(void *__ptr, size_t size, void *in_use_data) {
+void* safe_aligned_alloc(size_t alignment, size_t size, void* in_use_data) {
     void *ptr;
-    
-    if ((ptr = realloc(__ptr, size)) == NULL) {
-        fprintf(stderr, "realloc() failed to allocate memory\n");
-        thread_context_destroy(in_use_data);
-        exit(EXIT_FAILURE);
+    size_t aligned_size = (size + alignment - 1) & ~(alignment - 1);
+
+    if (aligned_size == 0) {
+        aligned_size = alignment;
+    }
+
+    if ((ptr = aligned_alloc(alignment, aligned_size)) == NULL) {
+        allocation_failed("aligned_alloc()", in_use_data);
     }
 
     return ptr;
 }
 
 
-void safe_lstat(char* path_name, struct stat* buff, void *in_use_data) {
-    if (lstat(path_name, buff) == -1) {
-        perror("lstat");
-        thread_context_destroy(in_use_data);
-        exit(EXIT_FAILURE);
+void* safe_realloc(void *__ptr, size_t size, void *in_use_data) {
+    void *ptr;
+    
+    if ((ptr = realloc(__ptr, size)) == NULL) {
+        allocation_failed("realloc()", in_use_data);
     }
-}
-
-
-DIR* safe_opendir(const char* dir_name, void* in_use_data) {
-    ThreadContext* thread_context = (ThreadContext*) in_use_data;
-
-    pthread_mutex_lock(&thread_context->mutex_error);
-    DIR* dir;
 
-    if ((dir = opendir(dir_name)) == NULL) {
-        fprintf(stderr, "du: cannot read directory '%s': %s\n", 
-            dir_name, strerror(errno));
-        pthread_mutex_unlock(&thread_context->mutex_error);
+    return ptr;
+}
 
-        return NULL;
-    }
 
-    pthread_mutex_unlock(&thread_context->mutex_error);
-    return dir;
-}
\ No newline at end of file
@@ -8,7 +8,9 @@
  * can be used to manage resources such as memory allocation, file operations, 
  * and process management. These functions are designed to handle errors, 
  * print informative error messages to the standard error stream, and exit 
- * the program with a failure status code when errors occur.
+ * the program with a failure status code when errors occur. A thread that 
+ * must not end the program, such as the caller of the library, sets a 
+ * recovery point instead, a failed allocation then jumps back to it.
  *
  * @author  Daniel Hylander
  * @date 2023-10-18
@@ -27,8 +29,11 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <dirent.h>
+#include <string.h>
+#include <setjmp.h>
 
 #include "thread_context.h"
+#include "stat_batch.h"
 
 /**
  * @brief Safely allocates memory using malloc.
@@ -69,6 +74,28 @@ void* safe_malloc(size_t size, void* in_use_data);
 */
 void* safe_calloc(size_t __nmemb, size_t size, void* in_use_data);
 
+/**
+ * @brief Safely allocates aligned memory using aligned_alloc.
+ * 
+ * This function allocates memory of the specified size, aligned to `alignment`,
+ * using the `aligned_alloc` function. If the allocation fails, an error message 
+ * is printed to the standard error stream, and any data specified by the 
+ * `in_use_data` parameter is destroyed to prevent memory leaks.
+ * The function then exits the program with a failure status code.
+ * 
+ * @param alignment The alignment, a power of two.
+ * @param size The size of the memory block to allocate, it is rounded up to 
+ * a multiple of `alignment`.
+ * @param in_use_data A pointer to data that should be destroyed if 
+ * memory allocation fails.
+ * 
+ * @return A void pointer to the alloacted memory.
+ * 
+ * @note It is the caller's responsibility to handle the returned pointer and 
+ * free the memory when no longer needed.
+*/
+void* safe_aligned_alloc(size_t alignment, size_t size, void* in_use_data);
+
 /**
  * @brief Safely re-allocates memory using realloc.
  * 
@@ -89,36 +116,18 @@ void* safe_calloc(size_t __nmemb, size_t size, void* in_use_data);
 */
 void* safe_realloc(void *__ptr, size_t size, void *in_use_data);
 
-
 /**
- * @brief Safely creates a stat struct using lstat.
+ * @brief Sets the recovery point of the calling thread.
  * 
- * This function creates a stat struct from the file specified by the 
- * file name `path_name` and stores it in `buff` using the function `lstat`. If the 
- * execution of stat fails, an error message is printed to the standard error 
- * stream. The function then exits he program with a failure status code.
+ * While it is set, a failed allocation of the thread does not print a 
+ * message, destroy `in_use_data` or exit, it jumps to `recovery` with 
+ * `longjmp()`. The caller must then deallocate the data itself.
  * 
- * @param path_name String of the file name.
- * @param buff The the struct to store the created stat struct in.
- * @param in_use_data A pointer to data that should be destroyed if 
- * memory allocation fails.
+ * @param recovery Pointer to the buffer filled by `setjmp()`; else NULL to 
+ * exit on failure again.
 */
-void safe_lstat(char* path_name, struct stat* buff, void* in_use_data);
-
+void safe_set_recovery(jmp_buf* recovery);
 
-/**
- * @brief Safely opens a directory using opendir.
- * 
- * This function opens a directory specified by the directory name `dir_name` using the 
- * `opendir` function. If it fails to open the file, an error message is printed 
- * to the standard error stream. The function then returns NULL.
- * 
- * @param dir_name String of the directory name to be opened.
- * 
- * @return On success it returns the DIR pointer of the opened 
- * directory; else NULL.
-*/
-DIR* safe_opendir(const char* dir_name, void* in_use_data);
 
 #endif
 
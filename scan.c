@@ -0,0 +1,1211 @@
+/*
+ * @brief This module implements the traversal engine shared by the program 
+ * and the library.
+ *
+ * The program and the library run their scans with the same functions, 
+ * they only differ in which threads run the workers.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include "scan.h"
+
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief The state of a directory being traversed by a worker.
+*/
+typedef struct {
+    Job* job;
+    Worker* worker;
+    DirHandle* handle;
+    int dir_fd;
+    Usage sum;
+
+    long entry_count;
+    Job* chunk;
+} Traversal;
+
+/*
+ * @brief Checks if a path is the `.` or `..` directory's.
+ * 
+ * @param path String of a path.
+ * @return Returns true if the path is either the `.` or `..` directory; 
+ * else false.
+*/
+static bool is_dot_or_dot_dot(const char* path) {
+    return strcmp(path, ".") == 0 || strcmp(path, "..") == 0;
+}
+
+/*
+ * @brief Wakes one idle worker if there are any sleeping.
+ * 
+ * @param thread_context A pointer to the thread context struct containing the 
+ * workers.
+*/
+static void wake_idle_worker(ThreadContext* thread_context) {
+    if (atomic_load(&thread_context->idle_threads) > 0) {
+        pthread_mutex_lock(&thread_context->mutex_work);
+        pthread_cond_signal(&thread_context->cond_work);
+        pthread_mutex_unlock(&thread_context->mutex_work);
+    }
+}
+
+/*
+ * @brief Publishes a job in the deque of a worker, so it can be stolen.
+ * 
+ * @param job A pointer to the job.
+ * @param worker A pointer to the worker that owns the deque.
+*/
+static void publish_job(Job* job, Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+
+    deque_push(worker->deque, job, thread_context);
+    atomic_fetch_add(&thread_context->queued_jobs, 1);
+
+    wake_idle_worker(thread_context);
+}
+
+/*
+ * @brief Pushes a job to the private stack of a worker.
+ * 
+ * @param job A pointer to the job.
+ * @param worker A pointer to the worker that owns the stack.
+*/
+static void stack_push(Job* job, Worker* worker) {
+    if (worker->stack_top == worker->stack_capacity) {
+        long count = worker->stack_top - worker->stack_bottom;
+
+        if (worker->stack_bottom > worker->stack_capacity / 2) {
+            memmove(worker->stack, &worker->stack[worker->stack_bottom], 
+                    count * sizeof(Job*));
+
+        } else {
+            worker->stack_capacity = worker->stack_capacity > 0 ? 
+                                        worker->stack_capacity * 2 : 64;
+            worker->stack = safe_realloc(worker->stack, 
+                                worker->stack_capacity * sizeof(Job*), 
+                                worker->thread_context);
+            memmove(worker->stack, &worker->stack[worker->stack_bottom], 
+                    count * sizeof(Job*));
+        }
+
+        worker->stack_bottom = 0;
+        worker->stack_top = count;
+    }
+
+    worker->stack[worker->stack_top++] = job;
+}
+
+/*
+ * @brief Pops the newest job from the private stack of a worker.
+ * 
+ * @param worker A pointer to the worker that owns the stack.
+ * @return Returns the job; else NULL if the stack is empty.
+*/
+static Job* stack_pop(Worker* worker) {
+    if (worker->stack_top == worker->stack_bottom) {
+        worker->stack_top = 0;
+        worker->stack_bottom = 0;
+        return NULL;
+    }
+
+    return worker->stack[--worker->stack_top];
+}
+
+/*
+ * @brief Moves the oldest jobs of the private stack of a worker to its 
+ * deque, one for each idle worker.
+ * 
+ * The oldest jobs are closest to the root, so they are likely to hold the 
+ * largest sub trees.
+ * 
+ * @param worker A pointer to the worker that owns the stack.
+*/
+static void publish_stack(Worker* worker) {
+    int idle = atomic_load_explicit(&worker->thread_context->idle_threads, 
+                                    memory_order_relaxed);
+
+    while (idle > 0 && worker->stack_bottom < worker->stack_top) {
+        publish_job(worker->stack[worker->stack_bottom++], worker);
+        idle--;
+    }
+}
+
+/*
+ * @brief Pushes a job for the worker.
+ * 
+ * With the depth-first order the job is pushed to the private stack of the 
+ * worker, and jobs are only published if other workers are idle; else the 
+ * job is published in the deque of the worker.
+ * 
+ * @param job A pointer to the job.
+ * @param worker A pointer to the worker that found the job.
+*/
+static void push_job(Job* job, Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+
+    atomic_fetch_add(&thread_context->pending_jobs, 1);
+
+    if (thread_context->options.order == ORDER_DFS) {
+        stack_push(job, worker);
+        publish_stack(worker);
+
+    } else {
+        publish_job(job, worker);
+    }
+
+    stats_max(&worker->stats->max_queue_depth, deque_size(worker->deque) + 
+                worker->stack_top - worker->stack_bottom);
+}
+
+/*
+ * @brief Marks a job as finished.
+ * 
+ * If it was the last pending job, all idle and parked workers are woken so 
+ * they can exit.
+ * 
+ * @param thread_context A pointer to the thread context struct containing the 
+ * workers.
+*/
+static void finish_job(ThreadContext* thread_context) {
+    if (atomic_fetch_sub(&thread_context->pending_jobs, 1) == 1) {
+        pthread_mutex_lock(&thread_context->mutex_work);
+        pthread_cond_broadcast(&thread_context->cond_work);
+        pthread_mutex_unlock(&thread_context->mutex_work);
+
+        if (thread_context->options.auto_threads) {
+            controller_set_limit(thread_context, thread_context->worker_num);
+        }
+    }
+}
+
+/*
+ * @brief Tries to steal a job from the deque of another worker.
+ * 
+ * The victims are visited in order, starting at a random worker. With 
+ * `--numa` the workers on the same node are visited first.
+ * 
+ * @param worker A pointer to the worker that is stealing.
+ * @return Returns the stolen job; else `NULL`.
+*/
+static Job* steal_job(Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    int worker_num = thread_context->worker_num;
+    int start = rand_r(&worker->seed) % worker_num;
+    int passes = thread_context->options.numa ? 2 : 1;
+
+    for (int pass = 0 ; pass < passes ; pass++) {
+        for (int i = 0 ; i < worker_num ; i++) {
+            Worker* victim = thread_context->workers[(start + i) % worker_num];
+
+            if (victim == worker || 
+                    (passes > 1 && (victim->node == worker->node) != (pass == 0))) {
+                continue;
+            }
+
+            Job* job = deque_steal(victim->deque);
+
+            if (job != NULL) {
+                stats_add(&worker->stats->steals, 1);
+                return job;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * @brief Copies a name or a path to the arena of the worker.
+ * 
+ * @param path String of the path.
+ * @param worker A pointer to the worker.
+ * @return Returns the copied path.
+*/
+static char* clone_path(const char* path, Worker* worker) {
+    size_t length = strlen(path) + 1;
+    char* copy = arena_alloc(worker->arena, length, worker->thread_context);
+    memcpy(copy, path, length);
+
+    return copy;
+}
+
+/*
+ * @brief Checks if the workers should time their work.
+ * 
+ * @param thread_context A pointer to the thread context struct.
+ * @return Returns true if the stats are reported; else false.
+*/
+static bool is_timed(const ThreadContext* thread_context) {
+    return thread_context->options.stats != STATS_NONE;
+}
+
+/*
+ * @brief Parks the worker if it is above the thread limit.
+ * 
+ * The private jobs of the worker are published first, so the running 
+ * workers can steal them. The worker may have been woken from `cond_work` 
+ * for a job it will not take, so another idle worker is woken for it. 
+ * The worker of a pool is not parked, it leaves the scan so its thread can 
+ * run a worker of another scan.
+ * 
+ * @param worker A pointer to the worker.
+ * @return Returns true if the worker should leave the scan; else false.
+*/
+static bool park_worker(Worker* worker) {
+    if (!controller_should_park(worker)) {
+        return false;
+    }
+
+    while (worker->stack_bottom < worker->stack_top) {
+        publish_job(worker->stack[worker->stack_bottom++], worker);
+    }
+
+    wake_idle_worker(worker->thread_context);
+
+    if (worker->thread_context->embedded) {
+        return true;
+    }
+
+    controller_park(worker);
+
+    return false;
+}
+
+/*
+ * @brief Takes a job from the workers stack or deque, or steals one from 
+ * another worker.
+ * 
+ * @param worker A pointer to the worker.
+ * @return Returns the job; else NULL if no job was found.
+*/
+static Job* take_job(Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    Job* job = stack_pop(worker);
+
+    if (job != NULL) {
+        publish_stack(worker);
+        return job;
+    }
+
+    if (thread_context->options.order == ORDER_BFS) {
+        job = deque_steal(worker->deque);
+
+    } else {
+        job = deque_take(worker->deque);
+    }
+
+    if (job == NULL) {
+        job = steal_job(worker);
+    }
+
+    if (job != NULL) {
+        atomic_fetch_sub(&thread_context->queued_jobs, 1);
+    }
+
+    return job;
+}
+
+/*
+ * @brief Puts the worker to sleep until there is work queued, all work is 
+ * done or the worker is above the thread limit.
+ * 
+ * @param worker A pointer to the worker.
+*/
+static void wait_for_work(Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    uint64_t start = is_timed(thread_context) ? stats_now() : 0;
+
+    pthread_mutex_lock(&thread_context->mutex_work);
+    atomic_fetch_add(&thread_context->idle_threads, 1);
+
+    while (atomic_load(&thread_context->queued_jobs) == 0 && 
+            atomic_load(&thread_context->pending_jobs) > 0 && 
+            !controller_should_park(worker)) {
+        pthread_cond_wait(&thread_context->cond_work, &thread_context->mutex_work);
+    }
+
+    atomic_fetch_sub(&thread_context->idle_threads, 1);
+    pthread_mutex_unlock(&thread_context->mutex_work);
+
+    if (is_timed(thread_context)) {
+        stats_add(&worker->stats->idle_ns, stats_now() - start);
+    }
+}
+
+/*
+ * @brief Checks if the device of a sub directory must be known before its 
+ * job is pushed.
+ * 
+ * @param thread_context A pointer to the thread context struct.
+ * @return Returns true if sub directory's must be stat'ed; else false.
+*/
+static bool needs_device(const ThreadContext* thread_context) {
+    return thread_context->options.one_file_system || 
+            thread_context->devices != NULL;
+}
+
+/*
+ * @brief Pushes a job for a sub directory to the workers deque.
+ * 
+ * The job inherits the device of its parent, unless the sub directory is 
+ * stat'ed and on another device. With a prefetcher, the sub directory is 
+ * also handed to it if it is opened relative to the open directory.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param name String of the sub directory's name.
+ * @param file_info The stat struct of the sub directory or NULL if it is not 
+ * stat'ed.
+ * @param count_self If the size of the sub directory has not been counted.
+*/
+static void push_sub_directory(Traversal* traversal, const char* name, 
+                                const struct stat* file_info, bool count_self) {
+    Job* job = traversal->job;
+    ThreadContext* thread_context = traversal->worker->thread_context;
+    DeviceTable* devices = thread_context->devices;
+
+    if (traversal->handle != NULL) {
+        dir_handle_retain(traversal->handle);
+    }
+
+    Job* sub_job = job_create(clone_path(name, traversal->worker), job, 
+                                traversal->handle, job->root, 
+                                traversal->worker);
+    sub_job->count_self = count_self;
+
+    if (thread_context->prefetcher != NULL && traversal->handle != NULL) {
+        sub_job->prefetch_ticket = prefetcher_add(thread_context->prefetcher, 
+                                                    traversal->handle, name);
+
+        if (sub_job->prefetch_ticket != 0) {
+            stats_add(&traversal->worker->stats->prefetches, 1);
+        }
+    }
+
+    if (devices != NULL && file_info != NULL && 
+            (job->device == NULL || job->device->dev != file_info->st_dev)) {
+        sub_job->device = device_table_get(devices, file_info->st_dev, 
+                                            traversal->worker->thread_context);
+    }
+
+    push_job(sub_job, traversal->worker);
+}
+
+/*
+ * @brief Adds the usage counted by a traversal to the worker and to the sub 
+ * tree of its job, and releases the job.
+ * 
+ * @param traversal The state of the traversed directory.
+*/
+static void finish_traversal(Traversal* traversal) {
+    Job* job = traversal->job;
+    Worker* worker = traversal->worker;
+
+    update_worker_sum(&traversal->sum, worker, job->root);
+
+    if (worker->thread_context->track_subtrees) {
+        job_add_usage(job, &traversal->sum);
+    }
+
+    job_release(job, worker);
+}
+
+/*
+ * @brief Looks up the traversed directory in the scan cache.
+ * 
+ * The key of the directory is stored in its job, so the job is written to 
+ * the new cache when it is complete. If mtimes are trusted and the directory 
+ * is unchanged, the cached usage below it is added to `sum` instead of 
+ * traversing it, and the directory is marked as skipped so the old records
+ * below it are kept.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param file_info The stat struct of the directory.
+ * @return Returns true if the cached usage was used; else false.
+*/
+static bool use_cached_usage(Traversal* traversal, const struct stat* file_info) {
+    ThreadContext* thread_context = traversal->worker->thread_context;
+    Job* job = traversal->job;
+    Job* parent = job->parent_job;
+
+    while (parent != NULL && job_is_chunk(parent)) {
+        parent = parent->parent_job;
+    }
+
+    scan_cache_set_key(&job->record, file_info, 
+                        parent != NULL ? &parent->record : NULL);
+    job->has_record = true;
+
+    if (!thread_context->options.trust_mtime) {
+        return false;
+    }
+
+    const struct scan_cache_record* record = scan_cache_find(
+                                                thread_context->cache, 
+                                                &job->record);
+
+    if (record == NULL) {
+        return false;
+    }
+
+    Usage usage = {
+        .blocks = record->blocks,
+        .bytes = record->bytes,
+        .inodes = record->inodes
+    };
+    usage_add(&traversal->sum, &usage);
+    scan_cache_mark_skipped(thread_context->cache, traversal->worker->id, 
+                            &job->record, thread_context);
+
+    return true;
+}
+
+/*
+ * @brief Processes the stat struct of a directory entry.
+ * 
+ * If the entry is a directory, push a job for the directory to the workers 
+ * deque and add the usage of the directory to `sum`; else it will only add 
+ * the files usage to `sum`, unless it is a hard link that is already counted.
+ * When every directory is reported, the sub directory counts its own size 
+ * instead, so it is part of its own total. With `-x` a directory on another 
+ * device than its argument is skipped. A counted file that is not a 
+ * directory is also added to the workers histogram of its argument.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param name String of the entry's name.
+ * @param file_info The stat struct of the entry.
+*/
+static void process_file_info(Traversal* traversal, const char* name, 
+                                struct stat* file_info) {
+    ThreadContext* thread_context = traversal->worker->thread_context;
+
+    if (is_dictionary(*file_info)) {
+        bool count_self = reports_directories(thread_context);
+
+        if (thread_context->options.one_file_system && file_info->st_dev != 
+                thread_context->coordinator[traversal->job->root]->dev) {
+            return;
+        }
+
+        push_sub_directory(traversal, name, file_info, count_self);
+
+        if (count_self) {
+            return;
+        }
+    }
+
+    if (is_counted(file_info, thread_context)) {
+        usage_add_file(&traversal->sum, file_info);
+
+        if (traversal->worker->histograms != NULL && 
+                !is_dictionary(*file_info)) {
+            histogram_add(&traversal->worker->histograms[traversal->job->root], 
+                            file_info, thread_context->histogram_time);
+        }
+    }
+}
+
+/*
+ * @brief Reports that an entry of the traversed directory cannot be stat'ed.
+ * 
+ * The entry is skipped, a racing unlink does not stop the traversal.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param name String of the entry's name.
+ * @param error The errno of the failed stat.
+*/
+static void report_entry_error(Traversal* traversal, const char* name, 
+                                int error) {
+    Worker* worker = traversal->worker;
+    char* path = job_get_path(traversal->job, name, worker->thread_context);
+
+    report_error(worker->thread_context, &worker->errors, 
+                    "du: cannot access '%s': %s\n", path, strerror(error));
+    free(path);
+}
+
+/*
+ * @brief Reports that the entry's of the traversed directory cannot be read.
+ * 
+ * The entry's read before the error are still counted, the error keeps 
+ * the total from being silently short.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param error The errno of the failed read.
+*/
+static void report_read_error(Traversal* traversal, int error) {
+    Worker* worker = traversal->worker;
+    char* path = job_get_path(traversal->job, NULL, worker->thread_context);
+
+    report_error(worker->thread_context, &worker->errors, 
+                    "du: cannot read directory '%s': %s\n", path, 
+                    strerror(error));
+    free(path);
+}
+
+/*
+ * @brief Processes the entry's of the workers stat batch.
+ * 
+ * @param traversal The state of the traversed directory.
+*/
+static void process_stat_batch(Traversal* traversal) {
+    StatBatch* batch = traversal->worker->batch;
+
+    stats_add(&traversal->worker->stats->stats, batch->count);
+    stat_batch_run(batch, traversal->dir_fd);
+
+    for (int i = 0 ; i < batch->count ; i++) {
+        if (batch->errors[i] != 0) {
+            report_entry_error(traversal, stat_batch_name(batch, i), 
+                                batch->errors[i]);
+            continue;
+        }
+
+        process_file_info(traversal, stat_batch_name(batch, i), 
+                            &batch->results[i]);
+    }
+
+    stat_batch_clear(batch);
+}
+
+/*
+ * @brief Checks if a directory entry should be handed to a chunk.
+ * 
+ * Once a directory has more entry's than the split threshold, the rest of 
+ * its entry's are split into chunks. Chunks are not split again, and entry's 
+ * already known to be directory's are pushed as usual.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param type The `d_type` of the entry.
+ * @return Returns true if the entry should be added to a chunk; else false.
+*/
+static bool should_split(Traversal* traversal, unsigned char type) {
+    Options* options = &traversal->worker->thread_context->options;
+
+    if (options->split_threshold == 0 || traversal->handle == NULL || 
+            job_is_chunk(traversal->job)) {
+        return false;
+    }
+
+    traversal->entry_count++;
+
+    if (traversal->entry_count <= options->split_threshold) {
+        return false;
+    }
+
+    return options->engine == ENGINE_SYNC || type != DT_DIR;
+}
+
+/*
+ * @brief Pushes the chunk being filled to the workers deque.
+ * 
+ * @param traversal The state of the traversed directory.
+*/
+static void push_chunk(Traversal* traversal) {
+    if (traversal->chunk != NULL) {
+        push_job(traversal->chunk, traversal->worker);
+        traversal->chunk = NULL;
+    }
+}
+
+/*
+ * @brief Adds a directory entry to the chunk being filled.
+ * 
+ * When the chunk is full it is pushed and a new chunk is started.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param name String of the entry's name.
+*/
+static void add_to_chunk(Traversal* traversal, const char* name) {
+    if (traversal->chunk != NULL && job_add_name(traversal->chunk, name)) {
+        return;
+    }
+
+    push_chunk(traversal);
+
+    dir_handle_retain(traversal->handle);
+    traversal->chunk = job_create_chunk(traversal->job, traversal->handle, 
+                                        traversal->worker);
+
+    job_add_name(traversal->chunk, name);
+}
+
+/*
+ * @brief Processes a directory entry.
+ * 
+ * With the sync engine the entry is stat'ed at once, relative to the open 
+ * directory. With a batched engine, entry's with the `d_type` of a 
+ * directory are pushed to the workers deque at once, they count their own 
+ * size when they are traversed, unless their device must be known first. 
+ * All other entry's are added to the stat batch, which also covers file 
+ * systems that return `DT_UNKNOWN`. An entry matching a pattern of 
+ * `--exclude` is skipped before any of this, so an excluded directory is 
+ * never stat'ed nor pushed.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param name String of the entry's name.
+ * @param type The `d_type` of the entry.
+ * @param in_place If `name` stays valid until the stat batch is processed.
+*/
+static void process_directory_entry(Traversal* traversal, const char* name, 
+                                    unsigned char type, bool in_place) {
+    ThreadContext* thread_context = traversal->worker->thread_context;
+    StatBatch* batch = traversal->worker->batch;
+
+    if (is_dot_or_dot_dot(name)) {
+        return;
+    }
+
+    /* The entry's of a chunk are already counted when they are read. */
+    if (!job_is_chunk(traversal->job)) {
+        stats_add(&traversal->worker->stats->entries, 1);
+    }
+
+    if (thread_context->exclude != NULL && 
+            exclude_match(thread_context->exclude, name, traversal->job)) {
+        stats_add(&traversal->worker->stats->excluded, 1);
+        return;
+    }
+
+    if (should_split(traversal, type)) {
+        add_to_chunk(traversal, name);
+
+    } else if (thread_context->options.engine == ENGINE_SYNC) {
+        struct stat file_info;
+
+        stats_add(&traversal->worker->stats->stats, 1);
+
+        if (fstatat(traversal->dir_fd, name, &file_info, 
+                    AT_SYMLINK_NOFOLLOW) == -1) {
+            report_entry_error(traversal, name, errno);
+            return;
+        }
+
+        process_file_info(traversal, name, &file_info);
+
+    } else if (type == DT_DIR && !needs_device(thread_context)) {
+        push_sub_directory(traversal, name, NULL, true);
+
+    } else if (!(in_place ? stat_batch_add_in_place(batch, name) : 
+                    stat_batch_add(batch, name))) {
+        process_stat_batch(traversal);
+
+        if (in_place) {
+            stat_batch_add_in_place(batch, name);
+
+        } else {
+            stat_batch_add(batch, name);
+        }
+    }
+}
+
+/*
+ * @brief Reads all entry's in a directory with `getdents64`.
+ * 
+ * The entry's are processed in place in the workers dir buffer, so the stat 
+ * batch is processed before the buffer is filled again.
+ * 
+ * @param traversal The state of the traversed directory.
+*/
+static void read_directory_getdents(Traversal* traversal) {
+    DirBuffer* buffer = traversal->worker->dir_buffer;
+    WorkerStats* stats = traversal->worker->stats;
+    const char* name;
+    unsigned char type;
+    long length;
+
+    /* Every call is counted, the last one that finds the end as well. */
+    while ((length = dir_buffer_fill(buffer, traversal->dir_fd)) > 0) {
+        stats_add(&stats->reads, 1);
+        stats_add(&stats->getdents_bytes, length);
+
+        while (dir_buffer_next(buffer, &name, &type)) {
+            process_directory_entry(traversal, name, type, true);
+        }
+
+        process_stat_batch(traversal);
+    }
+
+    stats_add(&stats->reads, 1);
+
+    if (length < 0) {
+        report_read_error(traversal, errno);
+    }
+}
+
+/*
+ * @brief Reads all entry's in a directory with `readdir`.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param directory The DIR object of the directory.
+*/
+static void read_directory_readdir(Traversal* traversal, DIR* directory) {
+    struct dirent* file;
+
+    /* `readdir` only sets errno on an error, not at the end. */
+    while((errno = 0, file = readdir(directory)) != NULL) {
+        process_directory_entry(traversal, file->d_name, file->d_type, false);
+    }
+
+    if (errno != 0) {
+        report_read_error(traversal, errno);
+    }
+
+    process_stat_batch(traversal);
+}
+
+/*
+ * @brief Processes all entry's in a directory.
+ * 
+ * Adds each entry's files size into the sum of the traversal. The entry's 
+ * handed to chunks are added by the workers processing the chunks.
+ * 
+ * @param traversal The state of the traversed directory.
+ * @param directory The DIR object of the directory.
+*/
+static void process_directory_entries(Traversal* traversal, DIR* directory) {
+    if (traversal->worker->dir_buffer != NULL) {
+        read_directory_getdents(traversal);
+
+    } else {
+        read_directory_readdir(traversal, directory);
+    }
+
+    push_chunk(traversal);
+}
+
+/*
+ * @brief Stats all entry's of a chunk.
+ * 
+ * Adds each entry's files size into the workers sum for the coordinator.
+ * 
+ * @param job A pointer to the chunk, it is deallocated when it is processed.
+ * @param worker A pointer to the worker processing the chunk.
+*/
+static void traverse_chunk(Job* job, Worker* worker) {
+    const char* name = job->names;
+
+    Traversal traversal = {
+        .job = job,
+        .worker = worker,
+        .handle = job->parent,
+        .dir_fd = dirfd(job->parent->directory),
+        .sum = {0},
+        .entry_count = 0,
+        .chunk = NULL
+    };
+
+    for (int i = 0 ; i < job->name_count ; i++) {
+        process_directory_entry(&traversal, name, DT_UNKNOWN, true);
+        name += strlen(name) + 1;
+    }
+
+    process_stat_batch(&traversal);
+
+    finish_traversal(&traversal);
+}
+
+/*
+ * @brief Creates the exclude of the thread context from the patterns of 
+ * the options.
+ * 
+ * @param thread_context A pointer to the thread context struct.
+ * @return Returns true if every file of `--exclude-from` was read; else 
+ * false.
+*/
+static bool create_exclude(ThreadContext* thread_context) {
+    Options* options = &thread_context->options;
+
+    thread_context->exclude = exclude_create(thread_context);
+
+    for (int i = 0 ; i < options->exclude_num ; i++) {
+        exclude_add(thread_context->exclude, options->excludes[i], 
+                    thread_context);
+    }
+
+    for (int i = 0 ; i < options->exclude_file_num ; i++) {
+        if (!exclude_add_file(thread_context->exclude, 
+                                options->exclude_files[i], thread_context)) {
+            report_message(thread_context, "mdu: cannot read '%s': %s\n", 
+                            options->exclude_files[i], strerror(errno));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * @brief Returns the flags of the scan cache for the options of a scan.
+ *
+ * @param thread_context A pointer to the thread context, its exclude is
+ * created.
+ * @return Returns the flags.
+*/
+static uint32_t cache_flags(const ThreadContext* thread_context) {
+    const Options* options = &thread_context->options;
+    uint32_t flags = 0;
+
+    if (options->dedup_links) {
+        flags |= SCAN_CACHE_FLAG_DEDUP;
+    }
+
+    if (options->one_file_system) {
+        flags |= SCAN_CACHE_FLAG_ONE_FILE_SYSTEM;
+    }
+
+    if (thread_context->exclude != NULL) {
+        uint64_t key = thread_context->exclude->key;
+
+        flags |= SCAN_CACHE_FLAG_EXCLUDE;
+        flags |= (uint32_t) (key ^ key >> 32) << SCAN_CACHE_EXCLUDE_SHIFT;
+    }
+
+    return flags;
+}
+
+/*
+ * @brief Runs the jobs of a worker until all work is done.
+ * 
+ * @param worker A pointer to the worker.
+*/
+static void run_jobs(Worker* worker) {
+    Job* job;
+
+    while((job = get_job_with_work(worker)) != NULL) {
+        Device* device = job->device;
+        uint64_t start = device != NULL ? stats_now() : 0;
+        uint64_t entries = atomic_load_explicit(&worker->stats->entries, 
+                                                memory_order_relaxed);
+
+        worker->current = job;
+        worker->current_device = device;
+        traverse_directory(job, worker);
+        worker->current = NULL;
+
+        /* The latency per entry, so large directory's do not look slow. */
+        if (device != NULL) {
+            entries = atomic_load_explicit(&worker->stats->entries, 
+                                            memory_order_relaxed) - entries;
+            worker->handoff = device_release(device, 
+                                    (stats_now() - start) / (entries + 1));
+        }
+
+        finish_job(worker->thread_context);
+    }
+}
+
+/*
+ * @brief Runs the jobs of an embedded worker with a recovery point set.
+ * 
+ * A failed allocation jumps back here. The scan is aborted, the job being 
+ * run is finished without completing it, since its state is lost, and its 
+ * slot of the device is released. The job may already be deallocated, so 
+ * it is not read. The worker then goes on releasing the remaining jobs so 
+ * the scan can end.
+ * 
+ * @param worker A pointer to the worker.
+*/
+static void run_recoverable_jobs(Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    jmp_buf recovery;
+
+    if (setjmp(recovery) != 0) {
+        atomic_store(&thread_context->out_of_memory, true);
+        atomic_store(&thread_context->aborted, true);
+
+        if (worker->current != NULL) {
+            worker->current = NULL;
+            worker->handoff = device_release(worker->current_device, 0);
+            finish_job(thread_context);
+        }
+    }
+
+    safe_set_recovery(&recovery);
+    run_jobs(worker);
+    safe_set_recovery(NULL);
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+bool is_dictionary(struct stat file_info) {
+    return (file_info.st_mode & S_IFMT) == S_IFDIR;
+}
+
+
+bool is_counted(const struct stat* file_info, ThreadContext* thread_context) {
+    if (thread_context->inodes == NULL || is_dictionary(*file_info) || 
+            file_info->st_nlink <= 1) {
+        return true;
+    }
+
+    return inode_set_insert(thread_context->inodes, file_info->st_dev, 
+                            file_info->st_ino, thread_context);
+}
+
+
+bool process_argument(const char* arg, struct stat* file_info, 
+                        ThreadContext* thread_context) {
+    if (lstat(arg, file_info) == -1) {
+        report_error(thread_context, &thread_context->errors, 
+                        "du: cannot access '%s': %s\n", arg, strerror(errno));
+        return false;
+    }
+
+    if (is_dictionary(*file_info)) {
+        thread_context->dir_num++;
+        int dir_num = thread_context->dir_num;
+
+        expand_and_create_coordinator(thread_context, arg);
+        thread_context->coordinator[dir_num - 1]->dev = file_info->st_dev;
+
+        Usage usage = {0};
+        usage_add_file(&usage, file_info);
+
+        update_total_sum(&usage, thread_context->coordinator[dir_num - 1]);
+    }
+
+    return true;
+}
+
+
+bool scan_prepare(ThreadContext* thread_context) {
+    Options* options = &thread_context->options;
+
+    if (options->dedup_links) {
+        thread_context->inodes = inode_set_create(thread_context);
+    }
+
+    if (options->breakdown) {
+        thread_context->breakdown = breakdown_create(options->top, 
+                                                        thread_context);
+        thread_context->track_subtrees = true;
+    }
+
+    if (options->excludes != NULL || options->exclude_files != NULL) {
+        return create_exclude(thread_context);
+    }
+
+    return true;
+}
+
+
+bool scan_start(ThreadContext* thread_context, int worker_num) {
+    Options* options = &thread_context->options;
+
+    create_workers(thread_context, worker_num);
+
+    if (options->dev_jobs != NULL) {
+        thread_context->devices = device_table_create(options->dev_jobs, 
+                                                        thread_context);
+
+        if (thread_context->devices == NULL) {
+            report_message(thread_context, 
+                            "mdu: invalid device budgets '%s'\n", 
+                            options->dev_jobs);
+            return false;
+        }
+    }
+
+    if (options->cache_path != NULL) {
+        thread_context->cache = scan_cache_open(options->cache_path, 
+                                                cache_flags(thread_context), 
+                                                worker_num, thread_context);
+        thread_context->track_subtrees = true;
+    }
+
+    if (options->output == OUTPUT_BINARY) {
+        thread_context->binary = binary_writer_create(options->output_path, 
+                                        options->report, worker_num, 
+                                        thread_context);
+
+        if (thread_context->binary == NULL) {
+            report_message(thread_context, "mdu: cannot create '%s': %s\n", 
+                            options->output_path, strerror(errno));
+            return false;
+        }
+    }
+
+    if (options->prefetch > 0) {
+        thread_context->prefetcher = prefetcher_start(thread_context, 
+                                                        options->prefetch);
+    }
+
+    return true;
+}
+
+
+void scan_finish(ThreadContext* thread_context) {
+    prefetcher_stop(thread_context->prefetcher);
+    thread_context->prefetcher = NULL;
+    reduce_total_sums(thread_context);
+}
+
+
+void push_root_jobs(ThreadContext* thread_context) {
+    for (int i = 0 ; i < thread_context->dir_num ; i++) {
+        Coordinator* coordinator = thread_context->coordinator[i];
+        Worker* worker = thread_context->workers[i % thread_context->worker_num];
+        Job* job = job_create(clone_path(coordinator->path, worker), NULL, NULL, 
+                                i, worker);
+
+        if (thread_context->devices != NULL) {
+            job->device = device_table_get(thread_context->devices, 
+                                            coordinator->dev, thread_context);
+        }
+
+        /* Until the workers are done, the total is the root itself. */
+        if (reports_directories(thread_context)) {
+            job_add_usage(job, &coordinator->total);
+            job->self = coordinator->total;
+        }
+
+        deque_push(worker->deque, job, thread_context);
+        atomic_fetch_add(&thread_context->pending_jobs, 1);
+        atomic_fetch_add(&thread_context->queued_jobs, 1);
+    }
+}
+
+
+void* thread_handler(void* arg) {
+    Worker* worker = (Worker*) arg;
+    ThreadContext* thread_context = worker->thread_context;
+
+    if (thread_context->topology != NULL && 
+            topology_bind(thread_context->topology, worker, 
+                            !thread_context->options.affinity) && 
+            thread_context->options.numa) {
+        worker_localize(worker);
+    }
+
+    if (thread_context->embedded) {
+        run_recoverable_jobs(worker);
+        return NULL;
+    }
+
+    run_jobs(worker);
+
+    int *exit_status = safe_malloc(sizeof(int), worker->thread_context);
+
+    if (worker->errors.count > 0) {
+        *exit_status = EXIT_FAILURE;
+        return exit_status;
+    }
+
+    *exit_status = EXIT_SUCCESS;
+    return exit_status;
+}
+
+
+Job* get_job_with_work(Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    Job* job = worker->handoff;
+
+    if (job != NULL) {
+        worker->handoff = NULL;
+        return job;
+    }
+
+    while (atomic_load(&thread_context->pending_jobs) > 0) {
+        if (park_worker(worker)) {
+            return NULL;
+        }
+
+        job = take_job(worker);
+
+        if (job == NULL) {
+            wait_for_work(worker);
+            continue;
+        }
+
+        /* A deferred job is run by the worker releasing the next slot. */
+        if (device_admit(job->device) || !device_defer(job->device, job)) {
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+
+void traverse_directory(Job* job, Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+
+    if (atomic_load_explicit(&thread_context->aborted, memory_order_relaxed)) {
+        job_release(job, worker);
+        return;
+    }
+
+    if (job_is_chunk(job)) {
+        traverse_chunk(job, worker);
+        return;
+    }
+
+    uint64_t start = is_timed(thread_context) ? stats_now() : 0;
+
+    stats_add(&worker->stats->directories, 1);
+    stats_add(&worker->stats->opens, 1);
+
+    if (job->prefetch_ticket != 0) {
+        stats_add(prefetcher_is_done(thread_context->prefetcher, 
+                                        job->prefetch_ticket) ? 
+                    &worker->stats->prefetch_hits : 
+                    &worker->stats->prefetch_misses, 1);
+    }
+
+    DIR* directory = job_open_directory(job, worker);
+
+    Traversal traversal = {
+        .job = job,
+        .worker = worker,
+        .handle = NULL,
+        .dir_fd = -1,
+        .sum = {0},
+        .entry_count = 0,
+        .chunk = NULL
+    };
+
+    struct stat file_info;
+    bool use_cache = thread_context->cache != NULL && directory != NULL;
+
+    if (job->count_self || use_cache) {
+        stats_add(&worker->stats->stats, 1);
+    }
+
+    if ((job->count_self || use_cache) && 
+            !job_stat_directory(job, directory, &file_info, worker)) {
+        use_cache = false;
+
+    } else if (job->count_self) {
+        usage_add_file(&job->self, &file_info);
+        usage_add_file(&traversal.sum, &file_info);
+    }
+
+    if (use_cache && use_cached_usage(&traversal, &file_info)) {
+        closedir(directory);
+        directory = NULL;
+    }
+    
+    if (directory != NULL) {
+        traversal.handle = dir_handle_create(directory, thread_context);
+        traversal.dir_fd = dirfd(directory);
+
+        process_directory_entries(&traversal, directory);
+
+        if (traversal.handle != NULL) {
+            dir_handle_release(traversal.handle, thread_context);
+
+        } else {
+            closedir(directory);
+        }
+    }
+
+    finish_traversal(&traversal);
+
+    if (is_timed(thread_context)) {
+        stats_add_latency(worker->stats, stats_now() - start);
+    }
+}
@@ -0,0 +1,202 @@
+/**
+ * @defgroup module_scan Scan
+ *
+ * @file scan.h
+ * @brief This module implements the traversal engine of a scan.
+ *
+ * A scan is set up in three steps. The arguments are processed by 
+ * `process_argument()`, which creates a coordinator for each directory. 
+ * `scan_prepare()` and `scan_start()` then create the state the options 
+ * ask for and the workers, and `push_root_jobs()` pushes the job of each 
+ * directory. Each worker is run by 
+ * `thread_handler()` from a thread of its own, the program starts the 
+ * threads itself and the library takes them from its pool. When all 
+ * workers are done, `scan_finish()` adds their usage to the coordinators.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <errno.h>
+
+#include "deque.h"
+#include "job.h"
+#include "options.h"
+#include "stat_batch.h"
+#include "dir_buffer.h"
+#include "inode_set.h"
+#include "arena.h"
+#include "breakdown.h"
+#include "scan_cache.h"
+#include "binary_output.h"
+#include "error_buffer.h"
+#include "stats.h"
+#include "device.h"
+#include "controller.h"
+#include "topology.h"
+#include "exclude.h"
+#include "histogram.h"
+#include "prefetch.h"
+#include "safe_functions.h"
+#include "thread_context.h"
+
+/**
+ * @brief Checks if a file is a directory.
+ * 
+ * @param file_info A stat strcut containing the information on a file.
+ * @return Returns true if the file is a directory; else false.
+*/
+bool is_dictionary(struct stat file_info);
+
+/**
+ * @brief Checks if the usage of a file should be counted.
+ * 
+ * When the links are deduplicated, a file with more than one hard link is 
+ * only counted the first time its inode is seen. Directories are always 
+ * counted, since their link count is the number of sub directories.
+ * 
+ * @param file_info The stat struct of the file.
+ * @param thread_context A pointer to the thread context struct.
+ * @return Returns true if the file should be counted; else false.
+*/
+bool is_counted(const struct stat* file_info, ThreadContext* thread_context);
+
+/**
+ * @brief Processes an argument of a scan.
+ * 
+ * If the argument is a directory, it will create a new coordinator for the 
+ * directory and update the total size of the directory. The job of the 
+ * directory is pushed by `push_root_jobs()`. If the argument cannot be 
+ * stat'ed, the error is reported.
+ * 
+ * @param arg The argument to process, it is not copied.
+ * @param file_info Set to the stat struct of the argument.
+ * @param thread_context A pointer to the thread context struct containing the 
+ * coordinators.
+ * @return Returns true if the argument was stat'ed; else false.
+*/
+bool process_argument(const char* arg, struct stat* file_info, 
+                        ThreadContext* thread_context);
+
+/**
+ * @brief Creates the state of a scan that is needed before its arguments 
+ * are traversed.
+ * 
+ * These are the inode set of `--dedup`, the breakdown and the exclude.
+ * 
+ * @param thread_context A pointer to the thread context struct with the 
+ * options of the scan.
+ * @return Returns true on success; else false if a file of 
+ * `--exclude-from` cannot be read.
+*/
+bool scan_prepare(ThreadContext* thread_context);
+
+/**
+ * @brief Creates the workers of a scan.
+ * 
+ * The device table, the scan cache, the binary writer and the prefetcher 
+ * are also created if the options ask for them. The root jobs are then 
+ * pushed by `push_root_jobs()`.
+ * 
+ * @param thread_context A pointer to the thread context struct, all 
+ * arguments must be processed.
+ * @param worker_num The number of workers.
+ * @return Returns true on success; else false if `--dev-jobs` is invalid 
+ * or the binary output cannot be created, a message is then printed to 
+ * stderr.
+ * 
+ * @note The workers must not be started before the root jobs are pushed.
+*/
+bool scan_start(ThreadContext* thread_context, int worker_num);
+
+/**
+ * @brief Stops the prefetcher of a scan and adds the usage of its workers 
+ * to the coordinators.
+ * 
+ * @param thread_context A pointer to the thread context struct.
+ * 
+ * @note Must only be called once, after all workers are done.
+*/
+void scan_finish(ThreadContext* thread_context);
+
+/**
+ * @brief Pushes a job for the root directory of every coordinator.
+ * 
+ * The roots are spread over the deques of the workers, from then on they 
+ * are scheduled as any other job. The job carries the index of its 
+ * coordinator, so the cost of scheduling does not depend on the number of 
+ * arguments.
+ * 
+ * @param thread_context A pointer to the thread context struct containing the 
+ * coordinators.
+ * 
+ * @note Must be called after the workers are created and before they start.
+*/
+void push_root_jobs(ThreadContext* thread_context);
+
+/**
+ * @brief Handles the logic for what work each thread will preform.
+ * 
+ * The worker of a pool returns as soon as it is above the thread limit, 
+ * the other workers return when all work is done. A failed allocation of 
+ * an embedded worker aborts the scan and sets `out_of_memory`, the job it 
+ * was running is given up and the worker goes on releasing the rest.
+ * 
+ * @param arg The worker struct of the thread.
+ * @return Returns the threads exit status, or NULL for an embedded worker.
+*/
+void* thread_handler(void* arg);
+
+/**
+ * @brief Traverses and processes all entry's in a directory.
+ * 
+ * Adds each entry's files size into the workers sum for the coordinator. Sub 
+ * directory's are pushed as new jobs to the deque of the worker, they hold 
+ * a reference to the open directory so they can be opened relative to it.
+ * The entry's of huge directory's are split into chunks that are pushed as 
+ * jobs of their own. If the job is a chunk, its entry's are stat'ed. Once 
+ * a scan is aborted, the remaining jobs are released without being read.
+ * 
+ * @param job A pointer to the job of the directory, it is deallocated when 
+ * the directory is traversed.
+ * @param worker A pointer to the worker traversing the directory.
+*/
+void traverse_directory(Job* job, Worker* worker);
+
+/**
+ * @brief Finds a job for a worker.
+ * 
+ * A job deferred to the worker by a device is run before any other, and a 
+ * worker above the thread limit is parked until it is needed. 
+ * The worker first takes the newest job from its private stack, then from 
+ * its own deque, the oldest one with the breadth-first order. If its deque is 
+ * empty it tries to steal from the other workers. If there is still no 
+ * work, it sleeps until work is pushed. A job for a device at its limit is 
+ * deferred to the device instead of returned. When no jobs are pending 
+ * `NULL` is returned, as it is when the worker of a pool leaves the scan.
+ * 
+ * @param worker A pointer to the worker looking for work.
+ * @return Returns a job; else if no jobs are pending NULL is returned.
+*/
+Job* get_job_with_work(Worker* worker);
+
+#endif /* SCAN_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,424 @@
+/*
+ * @brief This module implements the datatype ScanCache.
+ *
+ * A directory that is reached twice, for example when both a directory and
+ * one of its sub directory's are given as arguments, is only written once.
+ * The records of the old cache that were not written again are kept, since 
+ * the directory's below a directory that was not traversed are not 
+ * reached at all.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "scan_cache.h"
+#include "safe_functions.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Compares the keys of two records.
+ *
+ * @param a Pointer to the first record.
+ * @param b Pointer to the second record.
+ * @return Returns a negative number, zero or a positive number if `a` is 
+ * ordered before, equal to or after `b`.
+*/
+static int compare_records(const void* a, const void* b) {
+    const struct scan_cache_record* record_a = a;
+    const struct scan_cache_record* record_b = b;
+
+    if (record_a->dev != record_b->dev) {
+        return record_a->dev < record_b->dev ? -1 : 1;
+    }
+
+    if (record_a->ino != record_b->ino) {
+        return record_a->ino < record_b->ino ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*
+ * @brief Maps the cache file into memory if it is a valid cache.
+ *
+ * @param cache A pointer to the cache.
+*/
+static void map_cache_file(ScanCache* cache) {
+    struct stat file_info;
+    struct scan_cache_header header;
+    int fd = open(cache->path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        return;
+    }
+
+    if (fstat(fd, &file_info) == -1 || 
+            (size_t) file_info.st_size < sizeof(header) || 
+            pread(fd, &header, sizeof(header), 0) != sizeof(header) || 
+            memcmp(header.magic, SCAN_CACHE_MAGIC, sizeof(header.magic)) != 0 || 
+            header.version != SCAN_CACHE_VERSION || header.flags != cache->flags || 
+            (file_info.st_size - sizeof(header)) / sizeof(struct scan_cache_record) 
+                < header.count) {
+        close(fd);
+        return;
+    }
+
+    void* map = mmap(NULL, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        return;
+    }
+
+    cache->map = map;
+    cache->map_size = file_info.st_size;
+    cache->records = (const struct scan_cache_record*) 
+                        ((const char*) map + sizeof(header));
+    cache->count = header.count;
+}
+
+/*
+ * @brief Appends a record to a buffer.
+ *
+ * @param records Pointer to the buffer.
+ * @param record Pointer to the record.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+static void append_record(struct scan_cache_buffer* records,
+                            const struct scan_cache_record* record,
+                            void* in_use_data) {
+    if (records->count == records->capacity) {
+        records->capacity = records->capacity > 0 ? records->capacity * 2 : 256;
+        records->records = safe_realloc(records->records, 
+                    records->capacity * sizeof(struct scan_cache_record), 
+                    in_use_data);
+    }
+
+    records->records[records->count++] = *record;
+}
+
+/*
+ * @brief Copies the records of all buffers into one sorted array, without
+ * duplicates.
+ *
+ * @param buffers The buffers.
+ * @param buffer_num The number of buffers.
+ * @param records The array, with room for every record of the buffers.
+ * @return Returns the number of records.
+*/
+static size_t collect_buffers(const struct scan_cache_buffer* buffers,
+                                int buffer_num,
+                                struct scan_cache_record* records) {
+    size_t count = 0;
+    size_t used = 0;
+
+    for (int i = 0 ; i < buffer_num ; i++) {
+        if (buffers[i].count > 0) {
+            memcpy(&records[count], buffers[i].records, 
+                    buffers[i].count * sizeof(struct scan_cache_record));
+            count += buffers[i].count;
+        }
+    }
+
+    qsort(records, count, sizeof(struct scan_cache_record), compare_records);
+
+    for (size_t i = 0 ; i < count ; i++) {
+        if (used == 0 || compare_records(&records[used - 1], &records[i]) != 0) {
+            records[used++] = records[i];
+        }
+    }
+
+    return used;
+}
+
+/*
+ * @brief Finds the record with the key of another record.
+ *
+ * @param records The sorted records.
+ * @param count The number of records.
+ * @param dev The device of the key.
+ * @param ino The inode number of the key.
+ * @return Returns the index of the record; else -1.
+*/
+static long find_record(const struct scan_cache_record* records, size_t count,
+                        uint64_t dev, uint64_t ino) {
+    struct scan_cache_record key = {.dev = dev, .ino = ino};
+    const struct scan_cache_record* record = NULL;
+
+    if (count > 0) {
+        record = bsearch(&key, records, count, sizeof(key), compare_records);
+    }
+
+    return record != NULL ? record - records : -1;
+}
+
+/*
+ * @brief Appends the old records below the skipped directory's to the new
+ * records.
+ *
+ * An old record is kept if the chain of its parents through the old
+ * records reaches a skipped directory. A chain that reaches a directory
+ * traversed in this scan is dropped, the directory would have been found
+ * again if it still existed. The chains are followed once, every old
+ * record on a chain gets the result of its end.
+ *
+ * @param cache A pointer to the cache.
+ * @param records The sorted new records, with room for the old records 
+ * after them.
+ * @param count The number of new records.
+ * @param skipped The sorted keys of the skipped directory's.
+ * @param skipped_count The number of skipped directory's.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the number of records.
+*/
+static size_t keep_old_records(const ScanCache* cache,
+                                struct scan_cache_record* records, size_t count,
+                                const struct scan_cache_record* skipped,
+                                size_t skipped_count, void* in_use_data) {
+    enum {UNKNOWN, VISITING, KEEP, DROP};
+    unsigned char* states = safe_calloc(cache->count, 1, in_use_data);
+    size_t* chain = safe_malloc((cache->count + 1) * sizeof(size_t), 
+                                in_use_data);
+    size_t used = count;
+
+    for (size_t i = 0 ; i < cache->count ; i++) {
+        size_t length = 0;
+        unsigned char state = UNKNOWN;
+        long k = i;
+
+        while (state == UNKNOWN) {
+            const struct scan_cache_record* record = &cache->records[k];
+
+            if (states[k] != UNKNOWN) {
+                state = states[k] == VISITING ? DROP : states[k];
+                break;
+            }
+
+            if (find_record(records, count, record->dev, record->ino) != -1) {
+                state = DROP;
+                break;
+            }
+
+            states[k] = VISITING;
+            chain[length++] = k;
+
+            if (find_record(skipped, skipped_count, record->parent_dev, 
+                            record->parent_ino) != -1) {
+                state = KEEP;
+
+            } else if ((k = find_record(cache->records, cache->count, 
+                                        record->parent_dev, 
+                                        record->parent_ino)) == -1) {
+                state = DROP;
+            }
+        }
+
+        for (size_t j = 0 ; j < length ; j++) {
+            states[chain[j]] = state;
+        }
+    }
+
+    for (size_t i = 0 ; i < cache->count ; i++) {
+        if (states[i] == KEEP) {
+            records[used++] = cache->records[i];
+        }
+    }
+
+    free(chain);
+    free(states);
+
+    qsort(records, used, sizeof(struct scan_cache_record), compare_records);
+
+    return used;
+}
+
+/*
+ * @brief Writes all of a buffer to a file.
+ *
+ * @param fd The file descriptor of the file.
+ * @param data Pointer to the data.
+ * @param size The number of bytes to write.
+ * @return Returns true on success; else false and `errno` is set.
+*/
+static bool write_all(int fd, const void* data, size_t size) {
+    const char* bytes = data;
+
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        bytes += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+ScanCache* scan_cache_open(const char* path, uint32_t flags, int buffer_num,
+                            void* in_use_data) {
+    ScanCache* cache = safe_malloc(sizeof(ScanCache), in_use_data);
+    size_t length = strlen(path) + 1;
+
+    cache->path = safe_malloc(length, in_use_data);
+    memcpy(cache->path, path, length);
+    cache->flags = flags;
+
+    cache->map = NULL;
+    cache->map_size = 0;
+    cache->records = NULL;
+    cache->count = 0;
+
+    cache->buffers = safe_calloc(buffer_num, sizeof(struct scan_cache_buffer), 
+                                    in_use_data);
+    cache->skipped = safe_calloc(buffer_num, sizeof(struct scan_cache_buffer), 
+                                    in_use_data);
+    cache->buffer_num = buffer_num;
+
+    map_cache_file(cache);
+
+    return cache;
+}
+
+
+void scan_cache_destroy(ScanCache* cache) {
+    if (cache == NULL) {
+        return;
+    }
+
+    if (cache->map != NULL) {
+        munmap(cache->map, cache->map_size);
+    }
+
+    for (int i = 0 ; i < cache->buffer_num ; i++) {
+        free(cache->buffers[i].records);
+        free(cache->skipped[i].records);
+    }
+
+    free(cache->buffers);
+    free(cache->skipped);
+    free(cache->path);
+    free(cache);
+}
+
+
+void scan_cache_set_key(struct scan_cache_record* record,
+                        const struct stat* file_info,
+                        const struct scan_cache_record* parent) {
+    record->dev = file_info->st_dev;
+    record->ino = file_info->st_ino;
+    record->parent_dev = parent != NULL ? parent->dev : 0;
+    record->parent_ino = parent != NULL ? parent->ino : 0;
+    record->mtime_sec = file_info->st_mtim.tv_sec;
+    record->mtime_nsec = file_info->st_mtim.tv_nsec;
+    record->ctime_sec = file_info->st_ctim.tv_sec;
+    record->ctime_nsec = file_info->st_ctim.tv_nsec;
+}
+
+
+const struct scan_cache_record* scan_cache_find(const ScanCache* cache,
+                                    const struct scan_cache_record* key) {
+    const struct scan_cache_record* record = NULL;
+
+    if (cache->count > 0) {
+        record = bsearch(key, cache->records, cache->count, 
+                            sizeof(struct scan_cache_record), compare_records);
+    }
+
+    if (record == NULL || record->mtime_sec != key->mtime_sec || 
+            record->mtime_nsec != key->mtime_nsec || 
+            record->ctime_sec != key->ctime_sec || 
+            record->ctime_nsec != key->ctime_nsec) {
+        return NULL;
+    }
+
+    return record;
+}
+
+
+void scan_cache_append(ScanCache* cache, int buffer,
+                        const struct scan_cache_record* record,
+                        void* in_use_data) {
+    append_record(&cache->buffers[buffer], record, in_use_data);
+}
+
+
+void scan_cache_mark_skipped(ScanCache* cache, int buffer,
+                                const struct scan_cache_record* record,
+                                void* in_use_data) {
+    append_record(&cache->skipped[buffer], record, in_use_data);
+}
+
+
+bool scan_cache_save(ScanCache* cache, void* in_use_data) {
+    size_t count = 0;
+    size_t skipped_count = 0;
+
+    for (int i = 0 ; i < cache->buffer_num ; i++) {
+        count += cache->buffers[i].count;
+        skipped_count += cache->skipped[i].count;
+    }
+
+    struct scan_cache_record* records = safe_malloc(
+                    (count + cache->count + 1) * sizeof(struct scan_cache_record), 
+                    in_use_data);
+    struct scan_cache_record* skipped = safe_malloc(
+                    (skipped_count + 1) * sizeof(struct scan_cache_record), 
+                    in_use_data);
+    size_t used = collect_buffers(cache->buffers, cache->buffer_num, records);
+
+    skipped_count = collect_buffers(cache->skipped, cache->buffer_num, skipped);
+    used = keep_old_records(cache, records, used, skipped, skipped_count, 
+                            in_use_data);
+    free(skipped);
+
+    struct scan_cache_header header = {
+        .version = SCAN_CACHE_VERSION,
+        .flags = cache->flags,
+        .count = used
+    };
+    memcpy(header.magic, SCAN_CACHE_MAGIC, sizeof(header.magic));
+
+    size_t length = strlen(cache->path);
+    char* tmp_path = safe_malloc(length + sizeof(".tmp"), in_use_data);
+    snprintf(tmp_path, length + sizeof(".tmp"), "%s.tmp", cache->path);
+
+    bool saved = false;
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd != -1) {
+        saved = write_all(fd, &header, sizeof(header)) && 
+                write_all(fd, records, used * sizeof(struct scan_cache_record));
+        saved = close(fd) == 0 && saved;
+        saved = saved && rename(tmp_path, cache->path) == 0;
+    }
+
+    int error = errno;
+
+    if (!saved && fd != -1) {
+        unlink(tmp_path);
+    }
+
+    free(tmp_path);
+    free(records);
+    errno = error;
+
+    return saved;
+}
@@ -0,0 +1,199 @@
+/**
+ * @defgroup module_scan_cache ScanCache
+ *
+ * @file scan_cache.h
+ * @brief This module implements the datatype ScanCache.
+ *
+ * The scan cache is a file holding one record for each directory of an
+ * earlier scan: its device, inode number, mtime, ctime, the device and
+ * inode number of its parent and the usage of everything below it. The records are sorted by device and inode, so the
+ * file is mapped into memory as it is and searched with a binary search.
+ *
+ * During a scan each worker appends the records of its completed
+ * directory's to a buffer of its own. When the scan is done, the buffers
+ * are merged, sorted and written to a new file that replaces the old one.
+ * The old records are only carried over if they are below a directory
+ * skipped by `--trust-mtime`, the records of deleted or renamed
+ * directory's are dropped.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef SCAN_CACHE_H
+#define SCAN_CACHE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define SCAN_CACHE_MAGIC "MDUCACHE"
+#define SCAN_CACHE_VERSION 3
+#define SCAN_CACHE_FLAG_DEDUP 1
+#define SCAN_CACHE_FLAG_ONE_FILE_SYSTEM 2
+#define SCAN_CACHE_FLAG_EXCLUDE 4
+#define SCAN_CACHE_EXCLUDE_SHIFT 8
+
+/**
+ * @brief A record of a directory in the cache.
+ *
+ * `blocks`, `bytes` and `inodes` are the usage of the entry's below the
+ * directory, the directory itself is not included. `parent_dev` and
+ * `parent_ino` are zero for an argument.
+*/
+struct scan_cache_record {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t parent_dev;
+    uint64_t parent_ino;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    int64_t ctime_sec;
+    int64_t ctime_nsec;
+    uint64_t blocks;
+    uint64_t bytes;
+    uint64_t inodes;
+};
+
+/**
+ * @brief The header of the cache file, followed by `count` records.
+ *
+ * `flags` holds the options that change how the usage is counted, a cache
+ * written with other flags is not used. With `SCAN_CACHE_FLAG_EXCLUDE`
+ * the bits from `SCAN_CACHE_EXCLUDE_SHIFT` hold a hash of the exclude
+ * patterns.
+*/
+struct scan_cache_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t count;
+};
+
+/**
+ * @brief The records appended by one worker.
+ *
+ * The same buffer type holds the keys of the skipped directory's.
+*/
+struct scan_cache_buffer {
+    struct scan_cache_record* records;
+    size_t count;
+    size_t capacity;
+};
+
+/**
+ * @brief The type for the scan cache.
+*/
+typedef struct {
+    char* path;
+    uint32_t flags;
+
+    void* map;
+    size_t map_size;
+    const struct scan_cache_record* records;
+    size_t count;
+
+    struct scan_cache_buffer* buffers;
+    struct scan_cache_buffer* skipped;
+    int buffer_num;
+} ScanCache;
+
+/**
+ * @brief Opens the cache file at `path`.
+ *
+ * If the file does not exist or was written with other `flags`, the cache
+ * starts out empty.
+ *
+ * @param path String of the path of the cache file.
+ * @param flags The options that change how the usage is counted.
+ * @param buffer_num The number of workers that append records.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the opened cache.
+ *
+ * @note It is the caller's responsible to deallocate the cache after use
+ * by calling the function `scan_cache_destroy()`.
+ * @see scan_cache_destroy()
+*/
+ScanCache* scan_cache_open(const char* path, uint32_t flags, int buffer_num,
+                            void* in_use_data);
+
+/**
+ * @brief Destroy the cache, the cache file is left as it is.
+ *
+ * @param cache A pointer to the cache, may be NULL.
+*/
+void scan_cache_destroy(ScanCache* cache);
+
+/**
+ * @brief Fills in the key of a record from the stat struct of a directory.
+ *
+ * @param record Pointer to the record.
+ * @param file_info The stat struct of the directory.
+ * @param parent The record of the parent directory, or NULL for an
+ * argument.
+*/
+void scan_cache_set_key(struct scan_cache_record* record,
+                        const struct stat* file_info,
+                        const struct scan_cache_record* parent);
+
+/**
+ * @brief Finds the record of an unchanged directory.
+ *
+ * @param cache A pointer to the cache.
+ * @param key A record with the key of the directory.
+ * @return Returns the record if the directory is in the cache with the same
+ * mtime and ctime; else NULL.
+*/
+const struct scan_cache_record* scan_cache_find(const ScanCache* cache,
+                                    const struct scan_cache_record* key);
+
+/**
+ * @brief Appends a record to the buffer of a worker.
+ *
+ * @param cache A pointer to the cache.
+ * @param buffer The index of the worker's buffer.
+ * @param record Pointer to the record.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+void scan_cache_append(ScanCache* cache, int buffer,
+                        const struct scan_cache_record* record,
+                        void* in_use_data);
+
+/**
+ * @brief Marks a directory as skipped, so the old records below it are
+ * kept.
+ *
+ * @param cache A pointer to the cache.
+ * @param buffer The index of the worker's buffer.
+ * @param record Pointer to the record of the directory.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+*/
+void scan_cache_mark_skipped(ScanCache* cache, int buffer,
+                                const struct scan_cache_record* record,
+                                void* in_use_data);
+
+/**
+ * @brief Writes the appended records to the cache file.
+ *
+ * The records are written to a temporary file that is renamed over the
+ * cache file, so a failed write never leaves a broken cache behind.
+ *
+ * @param cache A pointer to the cache.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns true on success; else false and `errno` is set.
+*/
+bool scan_cache_save(ScanCache* cache, void* in_use_data);
+
+#endif /* SCAN_CACHE_H */
+
+/**
+ * }
+*/
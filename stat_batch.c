@@ -0,0 +1,91 @@
+/*
+ * @brief This module implements the datatype StatBatch.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+
+#include "stat_batch.h"
+#include "safe_functions.h"
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+StatBatch* stat_batch_create(bool use_uring, void* in_use_data) {
+    StatBatch* batch = safe_malloc(sizeof(StatBatch), in_use_data);
+
+    batch->ring = use_uring ? uring_create(STAT_BATCH_SIZE) : NULL;
+    stat_batch_clear(batch);
+
+    return batch;
+}
+
+
+void stat_batch_destroy(StatBatch* batch) {
+    uring_destroy(batch->ring);
+    free(batch);
+}
+
+
+bool stat_batch_add(StatBatch* batch, const char* name) {
+    int length = strlen(name) + 1;
+
+    if (batch->count == STAT_BATCH_SIZE || 
+            batch->used + length > STAT_BATCH_NAMES_SIZE) {
+        return false;
+    }
+
+    memcpy(&batch->storage[batch->used], name, length);
+    batch->names[batch->count] = &batch->storage[batch->used];
+    batch->used += length;
+    batch->count++;
+
+    return true;
+}
+
+
+bool stat_batch_add_in_place(StatBatch* batch, const char* name) {
+    if (batch->count == STAT_BATCH_SIZE) {
+        return false;
+    }
+
+    batch->names[batch->count] = name;
+    batch->count++;
+
+    return true;
+}
+
+
+const char* stat_batch_name(StatBatch* batch, int i) {
+    return batch->names[i];
+}
+
+
+void stat_batch_run(StatBatch* batch, int dir_fd) {
+    if (batch->ring != NULL) {
+        if (uring_statx_batch(batch->ring, dir_fd, batch->names, batch->count, 
+                batch->results, batch->errors)) {
+            return;
+        }
+
+        uring_destroy(batch->ring);
+        batch->ring = NULL;
+    }
+
+    for (int i = 0 ; i < batch->count ; i++) {
+        batch->errors[i] = 0;
+
+        if (fstatat(dir_fd, stat_batch_name(batch, i), &batch->results[i], 
+                AT_SYMLINK_NOFOLLOW) == -1) {
+            batch->errors[i] = errno;
+        }
+    }
+}
+
+
+void stat_batch_clear(StatBatch* batch) {
+    batch->used = 0;
+    batch->count = 0;
+}
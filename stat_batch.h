@@ -0,0 +1,123 @@
+/**
+ * @defgroup module_stat_batch StatBatch
+ *
+ * @file stat_batch.h
+ * @brief This module implements the datatype StatBatch.
+ *
+ * A stat batch collects the names of the entry's of a directory that still
+ * need to be stat'ed, so they can be stat'ed together once the batch is
+ * full. The names are either copied into a fixed buffer owned by the batch
+ * or referenced in place, adding a name never allocates memory.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef STAT_BATCH_H
+#define STAT_BATCH_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "uring.h"
+
+#define STAT_BATCH_SIZE 64
+#define STAT_BATCH_NAMES_SIZE (STAT_BATCH_SIZE * 64)
+
+/**
+ * @struct StatBatch
+ *
+ * @brief Type for a batch of entry's to stat.
+ *
+ * `results[i]` holds the stat struct of the i:th name once the batch is
+ * run, `errors[i]` is zero on success; else the errno of the failed stat.
+ * If the batch has a ring, the names are stat'ed through io_uring.
+*/
+typedef struct {
+    Uring* ring;
+
+    char storage[STAT_BATCH_NAMES_SIZE];
+    const char* names[STAT_BATCH_SIZE];
+    int used;
+    int count;
+
+    struct stat results[STAT_BATCH_SIZE];
+    int errors[STAT_BATCH_SIZE];
+} StatBatch;
+
+/**
+ * @brief Creates an empty stat batch.
+ *
+ * @param use_uring If the batch should be stat'ed through io_uring.
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return A pointer to the newly created batch.
+ *
+ * @note The returned batch must be freed using the `stat_batch_destroy`
+ *       function when it is no longer needed to prevent memory leaks.
+ * @see stat_batch_destroy()
+*/
+StatBatch* stat_batch_create(bool use_uring, void* in_use_data);
+
+/**
+ * @brief Deallocates the batch.
+ *
+ * @param batch Pointer to the batch.
+*/
+void stat_batch_destroy(StatBatch* batch);
+
+/**
+ * @brief Adds a name to the batch.
+ *
+ * @param batch Pointer to the batch.
+ * @param name String of the entry's name.
+ * @return Returns true if the name was added; else false if the batch is full.
+*/
+bool stat_batch_add(StatBatch* batch, const char* name);
+
+/**
+ * @brief Adds a name to the batch without copying it.
+ *
+ * @param batch Pointer to the batch.
+ * @param name String of the entry's name, it must be valid until the batch
+ * is cleared.
+ * @return Returns true if the name was added; else false if the batch is full.
+*/
+bool stat_batch_add_in_place(StatBatch* batch, const char* name);
+
+/**
+ * @brief Returns the i:th name of the batch.
+ *
+ * @param batch Pointer to the batch.
+ * @param i Index of the name.
+ * @return Returns the name.
+*/
+const char* stat_batch_name(StatBatch* batch, int i);
+
+/**
+ * @brief Stats all names in the batch relative to the directory `dir_fd`.
+ *
+ * Symbolic links are not followed. If the ring of the batch fails, it is
+ * destroyed and the names are stat'ed one by one.
+ *
+ * @param batch Pointer to the batch.
+ * @param dir_fd File descriptor of the directory containing the entry's.
+*/
+void stat_batch_run(StatBatch* batch, int dir_fd);
+
+/**
+ * @brief Removes all names from the batch.
+ *
+ * @param batch Pointer to the batch.
+*/
+void stat_batch_clear(StatBatch* batch);
+
+#endif /* STAT_BATCH_H */
+
+/**
+ * }
+*/
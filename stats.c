@@ -0,0 +1,172 @@
+/*
+ * @brief This module implements the counters of the workers.
+ *
+ * The latency histogram has a bucket for each power of two, so a percentile
+ * is known within a factor of two.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "stats.h"
+#include "safe_functions.h"
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Returns `count` per second, or 0 if no time has passed.
+*/
+static double per_second(uint64_t count, double seconds) {
+    return seconds > 0 ? count / seconds : 0;
+}
+
+/*
+ * @brief Returns the share of the prefetched directories that were ready 
+ * when their job was taken, in percent, or 0 if none were taken.
+*/
+static double prefetch_hit_rate(const StatsTotals* totals) {
+    uint64_t taken = totals->prefetch_hits + totals->prefetch_misses;
+
+    return taken > 0 ? 100.0 * totals->prefetch_hits / taken : 0;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+WorkerStats* worker_stats_create(void* in_use_data) {
+    WorkerStats* stats = safe_aligned_alloc(alignof(WorkerStats), 
+                                            sizeof(WorkerStats), in_use_data);
+    memset(stats, 0, sizeof(WorkerStats));
+
+    return stats;
+}
+
+
+uint64_t stats_now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+
+void stats_add_latency(WorkerStats* stats, uint64_t ns) {
+    int bucket = ns > 0 ? 63 - __builtin_clzll(ns) : 0;
+
+    stats_add(&stats->latency[bucket], 1);
+}
+
+
+void stats_totals_add(StatsTotals* totals, WorkerStats* stats) {
+    totals->directories += atomic_load_explicit(&stats->directories, 
+                                                memory_order_relaxed);
+    totals->entries += atomic_load_explicit(&stats->entries, 
+                                            memory_order_relaxed);
+    totals->opens += atomic_load_explicit(&stats->opens, memory_order_relaxed);
+    totals->stats += atomic_load_explicit(&stats->stats, memory_order_relaxed);
+    totals->reads += atomic_load_explicit(&stats->reads, memory_order_relaxed);
+    totals->getdents_bytes += atomic_load_explicit(&stats->getdents_bytes, 
+                                                    memory_order_relaxed);
+    totals->excluded += atomic_load_explicit(&stats->excluded, 
+                                                memory_order_relaxed);
+    totals->prefetches += atomic_load_explicit(&stats->prefetches, 
+                                                memory_order_relaxed);
+    totals->prefetch_hits += atomic_load_explicit(&stats->prefetch_hits, 
+                                                    memory_order_relaxed);
+    totals->prefetch_misses += atomic_load_explicit(&stats->prefetch_misses, 
+                                                    memory_order_relaxed);
+    totals->steals += atomic_load_explicit(&stats->steals, 
+                                            memory_order_relaxed);
+    totals->idle_ns += atomic_load_explicit(&stats->idle_ns, 
+                                            memory_order_relaxed);
+    totals->blocks += atomic_load_explicit(&stats->blocks, 
+                                            memory_order_relaxed);
+
+    uint64_t depth = atomic_load_explicit(&stats->max_queue_depth, 
+                                            memory_order_relaxed);
+
+    if (depth > totals->max_queue_depth) {
+        totals->max_queue_depth = depth;
+    }
+
+    for (int i = 0 ; i < STATS_LATENCY_BUCKETS ; i++) {
+        totals->latency[i] += atomic_load_explicit(&stats->latency[i], 
+                                                    memory_order_relaxed);
+    }
+}
+
+
+uint64_t stats_latency_percentile(const StatsTotals* totals, int percent) {
+    uint64_t count = 0;
+
+    for (int i = 0 ; i < STATS_LATENCY_BUCKETS ; i++) {
+        count += totals->latency[i];
+    }
+
+    uint64_t rank = (count * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int i = 0 ; i < STATS_LATENCY_BUCKETS && count > 0 ; i++) {
+        seen += totals->latency[i];
+
+        if (seen >= rank && seen > 0) {
+            return i < 63 ? (uint64_t) 2 << i : UINT64_MAX;
+        }
+    }
+
+    return 0;
+}
+
+
+void stats_print(const StatsTotals* totals, double seconds, FILE* stream) {
+    fprintf(stream, "mdu: stats: %" PRIu64 " directories, %" PRIu64 
+            " entries in %.3f s (%.0f entries/s)\n", totals->directories, 
+            totals->entries, seconds, per_second(totals->entries, seconds));
+    fprintf(stream, "mdu: stats: %" PRIu64 " opens, %" PRIu64 " stats, %" 
+            PRIu64 " reads, %" PRIu64 " getdents bytes, %" PRIu64 
+            " excluded\n", totals->opens, totals->stats, totals->reads, 
+            totals->getdents_bytes, totals->excluded);
+    fprintf(stream, "mdu: stats: %" PRIu64 " steals, %.3f s idle, max queue "
+            "depth %" PRIu64 "\n", totals->steals, totals->idle_ns / 1e9, 
+            totals->max_queue_depth);
+    fprintf(stream, "mdu: stats: directory latency p50 < %.1f us, "
+            "p99 < %.1f us\n",
+            stats_latency_percentile(totals, 50) / 1e3, 
+            stats_latency_percentile(totals, 99) / 1e3);
+
+    if (totals->prefetches > 0) {
+        fprintf(stream, "mdu: stats: %" PRIu64 " prefetches, %" PRIu64 
+                " hits, %" PRIu64 " misses (%.1f %% hit rate)\n", 
+                totals->prefetches, totals->prefetch_hits, 
+                totals->prefetch_misses, prefetch_hit_rate(totals));
+    }
+}
+
+
+void stats_print_json(const StatsTotals* totals, double seconds, bool final,
+                        FILE* stream) {
+    fprintf(stream, "{\"final\": %s, \"seconds\": %.6f, \"directories\": %" 
+            PRIu64 ", \"entries\": %" PRIu64 ", \"entries_per_sec\": %.0f, "
+            "\"opens\": %" PRIu64 ", \"stats\": %" 
+            PRIu64 ", \"reads\": %" PRIu64 ", \"getdents_bytes\": %" PRIu64 
+            ", \"excluded\": %" PRIu64 ", \"steals\": %" PRIu64 
+            ", \"idle_seconds\": %.6f, "
+            "\"max_queue_depth\": %" PRIu64 ", \"latency_p50_us\": %.1f, "
+            "\"latency_p99_us\": %.1f, \"prefetches\": %" PRIu64 
+            ", \"prefetch_hits\": %" PRIu64 ", \"prefetch_misses\": %" PRIu64 
+            ", \"prefetch_hit_rate\": %.1f}\n", final ? "true" : "false", 
+            seconds, totals->directories, totals->entries, 
+            per_second(totals->entries, seconds), totals->opens, 
+            totals->stats, totals->reads, totals->getdents_bytes, 
+            totals->excluded, totals->steals, totals->idle_ns / 1e9, 
+            totals->max_queue_depth, 
+            stats_latency_percentile(totals, 50) / 1e3, 
+            stats_latency_percentile(totals, 99) / 1e3, totals->prefetches, 
+            totals->prefetch_hits, totals->prefetch_misses, 
+            prefetch_hit_rate(totals));
+    fflush(stream);
+}
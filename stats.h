@@ -0,0 +1,174 @@
+/**
+ * @defgroup module_stats Stats
+ *
+ * @file stats.h
+ * @brief This module implements the counters of the workers.
+ *
+ * Each worker owns a WorkerStats on a cache line of its own. Only the owner
+ * writes to it, with relaxed loads and stores, so a counter costs no more
+ * than an ordinary increment. Other threads may read the counters at any
+ * time with relaxed loads, the sums are then approximate. The timers use
+ * `clock_gettime` and are only read when the stats are reported.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#define STATS_LATENCY_BUCKETS 64
+
+/**
+ * @brief The counters of one worker.
+ *
+ * `opens`, `stats` and `reads` count the calls to open a directory, to stat
+ * an entry and to read the entry's of a directory. `reads` only counts the 
+ * `getdents64` calls of the getdents reader, the system calls behind 
+ * `readdir` are hidden by libc, so it stays zero with the readdir reader. 
+ * `excluded` counts the entry's skipped by a pattern of `--exclude`. 
+ * `prefetches` counts the directory's handed to the prefetcher, 
+ * `prefetch_hits` and `prefetch_misses` those that were and were not yet 
+ * prefetched when their job was taken. 
+ * `blocks` is the number of blocks the worker has counted so far. `idle_ns` is the time
+ * spent blocked on the condition variable for work, `max_queue_depth` the
+ * largest number of jobs seen in the deque and stack of the worker. Bucket
+ * `i` of `latency` counts the directory's that took between 2^i and 
+ * 2^(i + 1) nanoseconds to traverse.
+*/
+typedef struct {
+    alignas(64) _Atomic uint64_t directories;
+    _Atomic uint64_t entries;
+    _Atomic uint64_t opens;
+    _Atomic uint64_t stats;
+    _Atomic uint64_t reads;
+    _Atomic uint64_t getdents_bytes;
+    _Atomic uint64_t excluded;
+    _Atomic uint64_t prefetches;
+    _Atomic uint64_t prefetch_hits;
+    _Atomic uint64_t prefetch_misses;
+    _Atomic uint64_t steals;
+    _Atomic uint64_t idle_ns;
+    _Atomic uint64_t max_queue_depth;
+    _Atomic uint64_t blocks;
+    _Atomic uint64_t latency[STATS_LATENCY_BUCKETS];
+} WorkerStats;
+
+/**
+ * @brief The sum of the counters of all workers.
+*/
+typedef struct {
+    uint64_t directories;
+    uint64_t entries;
+    uint64_t opens;
+    uint64_t stats;
+    uint64_t reads;
+    uint64_t getdents_bytes;
+    uint64_t excluded;
+    uint64_t prefetches;
+    uint64_t prefetch_hits;
+    uint64_t prefetch_misses;
+    uint64_t steals;
+    uint64_t idle_ns;
+    uint64_t max_queue_depth;
+    uint64_t blocks;
+    uint64_t latency[STATS_LATENCY_BUCKETS];
+} StatsTotals;
+
+/**
+ * @brief Adds `value` to a counter of the calling worker.
+ *
+ * @param counter Pointer to the counter, owned by the calling worker.
+ * @param value The value to add.
+*/
+static inline void stats_add(_Atomic uint64_t* counter, uint64_t value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, 
+                            memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+/**
+ * @brief Raises a counter of the calling worker to `value`.
+ *
+ * @param counter Pointer to the counter, owned by the calling worker.
+ * @param value The new value, if it is larger.
+*/
+static inline void stats_max(_Atomic uint64_t* counter, uint64_t value) {
+    if (value > atomic_load_explicit(counter, memory_order_relaxed)) {
+        atomic_store_explicit(counter, value, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Creates the zeroed counters of a worker.
+ *
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the counters.
+*/
+WorkerStats* worker_stats_create(void* in_use_data);
+
+/**
+ * @brief Returns the time of the monotonic clock in nanoseconds.
+*/
+uint64_t stats_now(void);
+
+/**
+ * @brief Adds the traversal time of a directory to the latency histogram.
+ *
+ * @param stats Pointer to the counters of the calling worker.
+ * @param ns The traversal time in nanoseconds.
+*/
+void stats_add_latency(WorkerStats* stats, uint64_t ns);
+
+/**
+ * @brief Adds the counters of a worker to `totals`.
+ *
+ * @param totals Pointer to the totals.
+ * @param stats Pointer to the counters of the worker.
+*/
+void stats_totals_add(StatsTotals* totals, WorkerStats* stats);
+
+/**
+ * @brief Returns the `percent` percentile of the directory latency.
+ *
+ * @param totals Pointer to the totals.
+ * @param percent The percentile, between 0 and 100.
+ * @return Returns the upper bound of the bucket of the percentile in 
+ * nanoseconds; else 0 if no directory is counted.
+*/
+uint64_t stats_latency_percentile(const StatsTotals* totals, int percent);
+
+/**
+ * @brief Prints the totals as a summary.
+ *
+ * @param totals Pointer to the totals.
+ * @param seconds The time since the traversal started.
+ * @param stream The stream to print to.
+*/
+void stats_print(const StatsTotals* totals, double seconds, FILE* stream);
+
+/**
+ * @brief Prints the totals as one JSON object on a line of its own.
+ *
+ * @param totals Pointer to the totals.
+ * @param seconds The time since the traversal started.
+ * @param final If the traversal is done.
+ * @param stream The stream to print to.
+*/
+void stats_print_json(const StatsTotals* totals, double seconds, bool final,
+                        FILE* stream);
+
+#endif /* STATS_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,61 @@
+#!/bin/sh
+#
+# Checks that a pattern of several levels excludes the same directory's
+# when the directory holding them is split into chunks. The total of each
+# scan is compared with du on a copy of the tree with the excluded
+# directory's removed.
+#
+# Usage: tests/exclude_chunks.sh [path of mdu]
+#
+# @author Daniel Hylander
+# @date 2026-10-14
+
+MDU=${1:-./mdu}
+ROOT=$(mktemp -d)
+FAILED=0
+
+trap 'rm -rf "$ROOT"' EXIT
+
+mkdir -p "$ROOT/tree/top/s5/inner"
+
+for i in $(seq 1 20) ; do
+    echo "file $i" > "$ROOT/tree/top/s5/f$i"
+    mkdir -p "$ROOT/tree/top/s5/d$i/inner"
+    head -c 4096 /dev/zero > "$ROOT/tree/top/s5/d$i/inner/data"
+done
+
+# Runs mdu with a pattern and compares it with du on the tree without the
+# directory's matching the shell glob.
+check() {
+    pattern=$1
+    removed=$2
+
+    rm -rf "$ROOT/copy"
+    cp -a "$ROOT/tree" "$ROOT/copy"
+    (cd "$ROOT/copy" && rm -rf $removed)
+    expected=$(du -s -l -B512 "$ROOT/copy" | cut -f1)
+
+    for jobs in 1 4 ; do
+        output=$("$MDU" -j "$jobs" --split-threshold=5 --exclude="$pattern" \
+                    "$ROOT/tree")
+        status=$?
+        total=$(echo "$output" | cut -f1)
+
+        if [ "$status" -ne 0 ] || [ "$total" != "$expected" ] ; then
+            echo "FAIL: --exclude='$pattern' -j $jobs: status $status," \
+                    "total '$total', expected $expected"
+            FAILED=1
+        fi
+    done
+}
+
+check 'top/s5/inner' 'top/s5/inner'
+check 's5/*/inner' 'top/s5/d*/inner'
+check '*/*/inner' 'top/s5/inner top/s5/d*/inner'
+check 'd7/inner' 'top/s5/d7/inner'
+
+if [ "$FAILED" -eq 0 ] ; then
+    echo "OK"
+fi
+
+exit "$FAILED"
@@ -0,0 +1,52 @@
+#!/bin/sh
+#
+# Checks that `--stats` counts every entry of a split directory once. The
+# entry's are compared with find on a directory split into chunks, with
+# each engine and reader.
+#
+# Usage: tests/stats_split.sh [path of mdu]
+#
+# @author Daniel Hylander
+# @date 2026-10-14
+
+MDU=${1:-./mdu}
+ROOT=$(mktemp -d)
+FAILED=0
+
+trap 'rm -rf "$ROOT"' EXIT
+
+mkdir -p "$ROOT/tree/split"
+
+for i in $(seq 1 500) ; do
+    : > "$ROOT/tree/split/f$i"
+done
+
+for i in $(seq 1 20) ; do
+    mkdir "$ROOT/tree/split/d$i"
+    : > "$ROOT/tree/split/d$i/g"
+done
+
+expected=$(find "$ROOT/tree" -mindepth 1 | wc -l)
+
+for engine in sync batch ; do
+    for reader in readdir getdents ; do
+        for jobs in 1 4 ; do
+            entries=$("$MDU" -j "$jobs" --engine="$engine" --reader="$reader" \
+                        --split-threshold=50 --stats=json "$ROOT/tree" \
+                        2>&1 > /dev/null | grep -o '"entries": [0-9]*' | \
+                        cut -d' ' -f2)
+
+            if [ "$entries" != "$expected" ] ; then
+                echo "FAIL: --engine=$engine --reader=$reader -j $jobs:" \
+                        "entries '$entries', expected $expected"
+                FAILED=1
+            fi
+        done
+    done
+done
+
+if [ "$FAILED" -eq 0 ] ; then
+    echo "OK"
+fi
+
+exit "$FAILED"
@@ -12,26 +12,30 @@
  * @{
  */
 
+#include <limits.h>
+
 #include "thread_context.h"
+#include "job.h"
 
 /*-----------------------INTERNAL FUCTIONS-----------------------*/
 
 /*
- * @brief Creates a counter.
+ * @brief Returns how many directory's may be held open for their children.
  *
- * @return A pointer to the newly created object.
- * 
- * @note The returned object must be freed using the `destroy_counter` function
- *       when it is no longer needed to prevent memory leaks.
- * @see destroy_counter()
+ * Half of the file descriptor limit is used, the rest is left for the 
+ * directory's being read and for the standard streams.
+ *
+ * @return Returns the maximum number of shared directory handles.
 */
-static Counter* create_counter(void) {
-    Counter* counter = safe_malloc(sizeof(Counter), NULL);
+static int get_max_open_handles(void) {
+    struct rlimit limit;
 
-    pthread_mutex_init(&counter->mutex, NULL);
-    counter->counter = 0;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == -1 || 
+            limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur > INT_MAX) {
+        return 512;
+    }
 
-    return counter;
+    return limit.rlim_cur / 2;
 }
 
 /*
@@ -46,53 +50,115 @@ static Counter* create_counter(void) {
 static Coordinator* create_coordinator(ThreadContext* thread_context) {
     Coordinator* coordinator = safe_malloc(sizeof(Coordinator), thread_context);
 
-    pthread_mutex_init(&coordinator->mutex_sum, NULL);
-    pthread_mutex_init(&coordinator->mutex_queue, NULL);
-
-    coordinator->active_threads = create_counter();
-    coordinator->dir_queue = queue_create(thread_context);
-    coordinator->tot_sum = 0;
+    coordinator->index = thread_context->dir_num - 1;
+    coordinator->path = NULL;
+    coordinator->dev = 0;
+    memset(&coordinator->total, 0, sizeof(Usage));
 
     return coordinator;
 }
 
 /*
- * @brief Deallocates the counter.
+ * @brief Deallocates the coordinator.
  *
- * @param Pointer to the counter.
+ * @param Pointer to the coordinator.
 */
-static void destroy_counter(Counter* counter) {
-    pthread_mutex_destroy(&counter->mutex);
-    free(counter);
+static void destroy_coordinator(Coordinator* coordinator) {
+    free(coordinator->path);
+    free(coordinator);
 }
 
+
 /*
- * @brief Deallocates the coordinator.
+ * @brief Hands the message of an error to the error callback.
  *
- * @param Pointer to the coordinator.
+ * The message is not allocated with the safe functions, running out of 
+ * memory while reporting an error only truncates the message.
+ *
+ * @param thread_context A pointer to the thread_context.
+ * @param format The printf format of the message.
+ * @param args The arguments of the format.
 */
-static void destroy_coordinator(Coordinator* coordinator) {
-    pthread_mutex_destroy(&coordinator->mutex_sum);
-    pthread_mutex_destroy(&coordinator->mutex_queue);
-    destroy_counter(coordinator->active_threads);
+static void call_error_callback(ThreadContext* thread_context, 
+                                const char* format, va_list args) {
+    va_list copy;
+    char buffer[512];
+    char* message = buffer;
+
+    va_copy(copy, args);
+    int length = vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+
+    if (length < 0) {
+        return;
+    }
 
-    queue_destroy(coordinator->dir_queue);
+    if ((size_t) length >= sizeof(buffer) && 
+            (message = malloc(length + 1)) != NULL) {
+        vsnprintf(message, length + 1, format, args);
 
-    free(coordinator);
-}
+    } else if (message == NULL) {
+        message = buffer;
+        length = sizeof(buffer) - 1;
+    }
 
+    if (length > 0 && message[length - 1] == '\n') {
+        message[length - 1] = '\0';
+    }
+
+    thread_context->error_callback(message, thread_context->callback_data);
+
+    if (message != buffer) {
+        free(message);
+    }
+}
 
 /*-----------------------EXTERNAL FUCTIONS-----------------------*/
 
 
 ThreadContext* create_thread_context(void) {
-    ThreadContext* thread_context = safe_malloc(sizeof(ThreadContext), NULL);
+    ThreadContext* thread_context = safe_aligned_alloc(CACHE_LINE_SIZE, 
+                                                        sizeof(ThreadContext), 
+                                                        NULL);
 
+    memset(&thread_context->options, 0, sizeof(Options));
     thread_context->coordinator = safe_calloc(2, sizeof(Coordinator*), NULL);
     thread_context->size = 2;
     thread_context->dir_num = 0;
 
-    pthread_mutex_init(&thread_context->mutex_error, NULL);
+    thread_context->workers = NULL;
+    thread_context->worker_num = 0;
+
+    atomic_init(&thread_context->pending_jobs, 0);
+    atomic_init(&thread_context->queued_jobs, 0);
+    atomic_init(&thread_context->idle_threads, 0);
+    atomic_init(&thread_context->thread_limit, 0);
+    atomic_init(&thread_context->parked_threads, 0);
+
+    atomic_init(&thread_context->open_handles, 0);
+    thread_context->max_open_handles = get_max_open_handles();
+
+    thread_context->inodes = NULL;
+    thread_context->breakdown = NULL;
+    thread_context->cache = NULL;
+    thread_context->binary = NULL;
+    thread_context->track_subtrees = false;
+
+    error_buffer_init(&thread_context->errors);
+    thread_context->devices = NULL;
+    thread_context->topology = NULL;
+    thread_context->exclude = NULL;
+    thread_context->histograms = NULL;
+    thread_context->histogram_time = 0;
+    thread_context->prefetcher = NULL;
+
+    thread_context->embedded = false;
+    atomic_init(&thread_context->aborted, false);
+    atomic_init(&thread_context->out_of_memory, false);
+    thread_context->directory_callback = NULL;
+    thread_context->error_callback = NULL;
+    thread_context->callback_data = NULL;
+
     pthread_mutex_init(&thread_context->mutex_work, NULL);
     pthread_cond_init(&thread_context->cond_work, NULL);
 
@@ -100,65 +166,322 @@ ThreadContext* create_thread_context(void) {
 }
 
 
-void expand_and_create_coordinator(ThreadContext* thread_context) {
-    Coordinator** coordinator = thread_context->coordinator;
-    int size = thread_context->size;
+void expand_and_create_coordinator(ThreadContext* thread_context, 
+                                    const char* path) {
     int dir_num = thread_context->dir_num;
 
-    if (size <= dir_num) {
-        coordinator = safe_realloc(coordinator, sizeof(Coordinator*) * (size + 2), 
-                        thread_context);
-        thread_context->size *= 2;
+    if (thread_context->size < dir_num) {
+        int size = thread_context->size * 2;
+
+        thread_context->coordinator = safe_realloc(thread_context->coordinator, 
+                                        sizeof(Coordinator*) * size, 
+                                        thread_context);
+        memset(&thread_context->coordinator[thread_context->size], 0, 
+                sizeof(Coordinator*) * (size - thread_context->size));
+        thread_context->size = size;
+    }
+
+    Coordinator* coordinator = create_coordinator(thread_context);
+    size_t length = strlen(path);
+
+    while (length > 1 && path[length - 1] == '/' && path[length - 2] == '/') {
+        length--;
     }
-    coordinator[dir_num - 1] = create_coordinator(thread_context);
 
-    thread_context->coordinator = coordinator;
+    coordinator->path = safe_malloc(length + 1, thread_context);
+    memcpy(coordinator->path, path, length);
+    coordinator->path[length] = '\0';
+    thread_context->coordinator[dir_num - 1] = coordinator;
+}
+
+
+void create_workers(ThreadContext* thread_context, int worker_num) {
+    thread_context->workers = safe_calloc(worker_num, sizeof(Worker*), 
+                                            thread_context);
+    thread_context->worker_num = worker_num;
+    atomic_store(&thread_context->thread_limit, worker_num);
+
+    if (thread_context->options.histogram != HISTOGRAM_NONE) {
+        thread_context->histograms = safe_calloc(thread_context->dir_num, 
+                                                    sizeof(Histogram), 
+                                                    thread_context);
+        thread_context->histogram_time = time(NULL);
+    }
+
+    for (int i = 0 ; i < worker_num ; i++) {
+        Worker* worker = safe_malloc(sizeof(Worker), thread_context);
+
+        worker->id = i;
+        worker->seed = i + 1;
+        worker->deque = deque_create(thread_context);
+        worker->batch = stat_batch_create(
+                            thread_context->options.engine == ENGINE_URING, 
+                            thread_context);
+        worker->dir_buffer = NULL;
+        worker->sums = safe_aligned_alloc(CACHE_LINE_SIZE, 
+                            thread_context->dir_num * sizeof(Accumulator), 
+                            thread_context);
+        memset(worker->sums, 0, thread_context->dir_num * sizeof(Accumulator));
+        worker->histograms = NULL;
+        worker->arena = arena_create(thread_context);
+        worker->free_jobs = NULL;
+        worker->free_job_count = 0;
+        worker->stack = NULL;
+        worker->stack_bottom = 0;
+        worker->stack_top = 0;
+        worker->stack_capacity = 0;
+        error_buffer_init(&worker->errors);
+        worker->stats = worker_stats_create(thread_context);
+        worker->handoff = NULL;
+        worker->current = NULL;
+        worker->current_device = NULL;
+        atomic_init(&worker->parked, 0);
+        worker->cpu = -1;
+        worker->node = 0;
+        worker->thread_context = thread_context;
+
+        if (thread_context->options.reader == READER_GETDENTS) {
+            worker->dir_buffer = dir_buffer_create(
+                            thread_context->options.getdents_buffer_size, 
+                            thread_context);
+        }
+
+        if (thread_context->histograms != NULL) {
+            worker->histograms = safe_aligned_alloc(CACHE_LINE_SIZE, 
+                                thread_context->dir_num * sizeof(Histogram), 
+                                thread_context);
+            memset(worker->histograms, 0, 
+                    thread_context->dir_num * sizeof(Histogram));
+        }
+
+        thread_context->workers[i] = worker;
+    }
+
+    if (thread_context->options.engine == ENGINE_URING && 
+            thread_context->workers[0]->batch->ring == NULL) {
+        if (!thread_context->embedded) {
+            fprintf(stderr, "mdu: io_uring is not available, using the batch engine\n");
+        }
+
+        thread_context->options.engine = ENGINE_BATCH;
+    }
 }
 
 
-void increment_counter(Counter* counter) {
-    pthread_mutex_lock(&counter->mutex);
-    counter->counter++;
-    pthread_mutex_unlock(&counter->mutex);
+void usage_add_file(Usage* usage, const struct stat* file_info) {
+    usage->blocks += file_info->st_blocks;
+    usage->bytes += file_info->st_size;
+    usage->inodes++;
 }
 
 
-void decrement_counter(Counter* counter) {
-    pthread_mutex_lock(&counter->mutex);
-    if (counter->counter > 0) {
-        counter->counter--;
+uint64_t usage_reported_value(const Usage* usage, const Options* options) {
+    switch (options->report) {
+        case REPORT_APPARENT_SIZE:
+            return (usage->bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        case REPORT_INODES:
+            return usage->inodes;
+        default:
+            return usage->blocks;
     }
-    pthread_mutex_unlock(&counter->mutex);
 }
 
 
-int get_counter_value(Counter* counter) {
-    pthread_mutex_lock(&counter->mutex);
-    int value = counter->counter;
-    pthread_mutex_unlock(&counter->mutex);
-    
-    return value;
+void usage_add(Usage* usage, const Usage* value) {
+    usage->blocks += value->blocks;
+    usage->bytes += value->bytes;
+    usage->inodes += value->inodes;
+}
+
+
+void update_total_sum(const Usage* value, Coordinator* coordinator) {
+    usage_add(&coordinator->total, value);
+}
+
+
+void update_worker_sum(const Usage* value, Worker* worker, int root) {
+    usage_add(&worker->sums[root].usage, value);
+    stats_add(&worker->stats->blocks, value->blocks);
 }
 
 
-void update_total_sum(int value, Coordinator* coordinator) {
-    pthread_mutex_lock(&coordinator->mutex_sum);
-    coordinator->tot_sum += value;
-    pthread_mutex_unlock(&coordinator->mutex_sum);
+void reduce_total_sums(ThreadContext* thread_context) {
+    for (int i = 0 ; i < thread_context->dir_num ; i++) {
+        Coordinator* coordinator = thread_context->coordinator[i];
+
+        for (int j = 0 ; j < thread_context->worker_num ; j++) {
+            usage_add(&coordinator->total, 
+                        &thread_context->workers[j]->sums[i].usage);
+        }
+    }
+}
+
+
+void reduce_histograms(ThreadContext* thread_context) {
+    for (int i = 0 ; i < thread_context->dir_num ; i++) {
+        for (int j = 0 ; j < thread_context->worker_num ; j++) {
+            histogram_merge(&thread_context->histograms[i], 
+                            &thread_context->workers[j]->histograms[i]);
+        }
+    }
+}
+
+
+bool reports_directories(const ThreadContext* thread_context) {
+    return thread_context->breakdown != NULL || 
+            thread_context->directory_callback != NULL;
+}
+
+
+void report_error(ThreadContext* thread_context, ErrorBuffer* errors, 
+                    const char* format, ...) {
+    va_list args;
+
+    va_start(args, format);
+
+    if (!thread_context->embedded) {
+        error_buffer_add(errors, format, args);
+
+    } else {
+        errors->count++;
+
+        if (thread_context->error_callback != NULL) {
+            call_error_callback(thread_context, format, args);
+        }
+    }
+
+    va_end(args);
+
+    if (thread_context->options.errors == ERRORS_ABORT) {
+        atomic_store(&thread_context->aborted, true);
+    }
+}
+
+
+void report_message(ThreadContext* thread_context, const char* format, ...) {
+    va_list args;
+
+    va_start(args, format);
+
+    if (!thread_context->embedded) {
+        vfprintf(stderr, format, args);
+
+    } else if (thread_context->error_callback != NULL) {
+        call_error_callback(thread_context, format, args);
+    }
+
+    va_end(args);
+}
+
+
+void worker_localize(Worker* worker) {
+    ThreadContext* thread_context = worker->thread_context;
+    bool use_uring = worker->batch->ring != NULL;
+    Accumulator* sums = safe_aligned_alloc(CACHE_LINE_SIZE, 
+                            thread_context->dir_num * sizeof(Accumulator), 
+                            thread_context);
+
+    memcpy(sums, worker->sums, thread_context->dir_num * sizeof(Accumulator));
+    free(worker->sums);
+    worker->sums = sums;
+
+    if (worker->histograms != NULL) {
+        Histogram* histograms = safe_aligned_alloc(CACHE_LINE_SIZE, 
+                                thread_context->dir_num * sizeof(Histogram), 
+                                thread_context);
+
+        memcpy(histograms, worker->histograms, 
+                thread_context->dir_num * sizeof(Histogram));
+        free(worker->histograms);
+        worker->histograms = histograms;
+    }
+
+    /* Paths already allocated from the old arena stay valid. */
+    arena_destroy(worker->arena);
+    worker->arena = arena_create(thread_context);
+
+    stat_batch_destroy(worker->batch);
+    worker->batch = stat_batch_create(use_uring, thread_context);
+
+    if (worker->dir_buffer != NULL) {
+        dir_buffer_destroy(worker->dir_buffer);
+        worker->dir_buffer = dir_buffer_create(
+                            thread_context->options.getdents_buffer_size, 
+                            thread_context);
+    }
+}
+
+
+void flush_errors(ThreadContext* thread_context) {
+    error_buffer_flush(&thread_context->errors);
+
+    for (int i = 0 ; i < thread_context->worker_num ; i++) {
+        error_buffer_flush(&thread_context->workers[i]->errors);
+    }
+}
+
+
+long error_count(ThreadContext* thread_context) {
+    long count = thread_context->errors.count;
+
+    for (int i = 0 ; i < thread_context->worker_num ; i++) {
+        count += thread_context->workers[i]->errors.count;
+    }
+
+    return count;
+}
+
+
+void collect_stats(ThreadContext* thread_context, StatsTotals* totals) {
+    memset(totals, 0, sizeof(StatsTotals));
+
+    for (int i = 0 ; i < thread_context->worker_num ; i++) {
+        stats_totals_add(totals, thread_context->workers[i]->stats);
+    }
 }
 
 
 void thread_context_destroy(ThreadContext* thread_context) {
     int dir_num = thread_context->dir_num;
 
-    pthread_mutex_destroy(&thread_context->mutex_error);
     pthread_mutex_destroy(&thread_context->mutex_work);
     pthread_cond_destroy(&thread_context->cond_work);
+    error_buffer_destroy(&thread_context->errors);
 
     for (int i = 0 ; i < dir_num ; i++) {
         destroy_coordinator(thread_context->coordinator[i]);
     }
 
+    for (int i = 0 ; i < thread_context->worker_num ; i++) {
+        /* The creation of the workers may have been cut short. */
+        if (thread_context->workers[i] == NULL) {
+            continue;
+        }
+
+        deque_destroy(thread_context->workers[i]->deque);
+        stat_batch_destroy(thread_context->workers[i]->batch);
+        dir_buffer_destroy(thread_context->workers[i]->dir_buffer);
+        free(thread_context->workers[i]->sums);
+        free(thread_context->workers[i]->histograms);
+        arena_destroy(thread_context->workers[i]->arena);
+        free(thread_context->workers[i]->stack);
+        job_pool_destroy(thread_context->workers[i]);
+        error_buffer_destroy(&thread_context->workers[i]->errors);
+        free(thread_context->workers[i]->stats);
+        free(thread_context->workers[i]);
+    }
+
+    inode_set_destroy(thread_context->inodes);
+    breakdown_destroy(thread_context->breakdown);
+    scan_cache_destroy(thread_context->cache);
+    binary_writer_destroy(thread_context->binary);
+    device_table_destroy(thread_context->devices);
+    topology_destroy(thread_context->topology);
+    exclude_destroy(thread_context->exclude);
+    free(thread_context->histograms);
+    free(thread_context->options.excludes);
+    free(thread_context->options.exclude_files);
+    free(thread_context->workers);
     free(thread_context->coordinator);
     free(thread_context);
 }
@@ -20,53 +20,232 @@
 #define THREAD_CONTEXT_H
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
 
-#include "queue.h"
+#include "deque.h"
+#include "options.h"
+#include "stat_batch.h"
+#include "dir_buffer.h"
+#include "inode_set.h"
+#include "arena.h"
+#include "breakdown.h"
+#include "scan_cache.h"
+#include "binary_output.h"
+#include "error_buffer.h"
+#include "stats.h"
+#include "device.h"
+#include "topology.h"
+#include "exclude.h"
+#include "histogram.h"
+
+#define CACHE_LINE_SIZE 64
+#define BLOCK_SIZE 512
 #include "safe_functions.h"
 
 /**
- * @struct Counter
+ * @struct Usage
+ * 
+ * @brief Type for the disk usage of a set of files.
  * 
- * @brief Type for a counter with a mutex lock.
+ * Contains the number of 512 byte blocks, the apparent size in bytes and 
+ * the number of inodes.
 */
 typedef struct {
-    pthread_mutex_t mutex;
-    int counter;
-} Counter;
+    uint64_t blocks;
+    uint64_t bytes;
+    uint64_t inodes;
+} Usage;
 
 /**
  * @struct Coordinator
  * 
- * @brief Type for a thread coordinator.
+ * @brief Type for the result slot of a directory tree.
  * 
- * Contains the information for traversing a directory tree given as an 
- * argument. Each sub directory is stored in the queue and a counter for 
- * each thread currently traversing sub-directory's. The total size of the 
- * directory's is also stored.
+ * Contains the path of a directory tree given as an argument, the device 
+ * it is on and the total usage of the tree. The jobs of all trees share the deques of the workers, 
+ * a job only carries the `index` of its coordinator. The usage counted by 
+ * the workers is added to the total when the traversal is done.
 */
 typedef struct {
-    pthread_mutex_t mutex_sum;
+    int index;
+    char* path;
+    dev_t dev;
+    Usage total;
+} Coordinator;
 
-    Counter* active_threads;
+/**
+ * @struct Accumulator
+ * 
+ * @brief Type for the usage counted by a worker for one directory tree.
+ * 
+ * Each accumulator fills a cache line of its own, so workers never write to 
+ * the same cache line.
+*/
+typedef struct {
+    alignas(CACHE_LINE_SIZE) Usage usage;
+} Accumulator;
 
-    int tot_sum;
+/**
+ * @brief Receives the total of a directory once its sub tree is done.
+ * 
+ * @param path String of the directory's path.
+ * @param usage The usage of the directory and everything below it.
+ * @param depth The number of levels below its argument.
+ * @param data The callback data of the thread context.
+*/
+typedef void (*DirectoryCallback)(const char* path, const Usage* usage, 
+                                    int depth, void* data);
 
-    Queue* dir_queue;
-    pthread_mutex_t mutex_queue;
-} Coordinator;
+/**
+ * @brief Receives the message of an error, without a trailing newline.
+ * 
+ * @param message String of the message.
+ * @param data The callback data of the thread context.
+*/
+typedef void (*ErrorCallback)(const char* message, void* data);
+
+/**
+ * @struct Worker
+ * 
+ * @brief Type for a worker thread.
+ * 
+ * Each worker owns a deque of directory jobs. Sub-directory's found by the 
+ * worker are pushed to its own deque, other workers steal from it when 
+ * their own deque's run dry. The stat batch is used by the batched engines 
+ * and the dir buffer by the getdents reader. `sums` holds one accumulator 
+ * for each coordinator. The paths of the worker's jobs are allocated from 
+ * `arena`, and `free_jobs` is a pool of `free_job_count` unused jobs. 
+ * 
+ * With the depth-first order, the jobs between `stack_bottom` and 
+ * `stack_top` of `stack` are private to the worker. They are moved to the 
+ * deque, oldest first, when other workers are idle. `errors` holds the 
+ * error messages of the worker, see `report_error()`, and `stats` its 
+ * counters. `handoff` is a job deferred by a device that the worker runs 
+ * next, since it inherited the slot of the worker's last job. `current` is 
+ * the job the worker runs and `current_device` its device, an embedded 
+ * worker whose allocation fails finishes the job without completing it and 
+ * releases its slot. `parked` is 
+ * the futex word the worker sleeps on while it is parked, see 
+ * `controller_park()`. `cpu` and `node` are the cpu and the NUMA node the 
+ * worker is placed on, see `Topology`. `histograms` holds a histogram for 
+ * each coordinator, it is NULL unless the histograms are counted.
+*/
+typedef struct worker {
+    int id;
+    unsigned int seed;
+
+    Deque* deque;
+    StatBatch* batch;
+    DirBuffer* dir_buffer;
+    Accumulator* sums;
+    Histogram* histograms;
+    Arena* arena;
+
+    struct job** stack;
+    long stack_bottom;
+    long stack_top;
+    long stack_capacity;
+
+    struct job* free_jobs;
+    int free_job_count;
+
+    ErrorBuffer errors;
+    WorkerStats* stats;
+    struct job* handoff;
+    struct job* current;
+    Device* current_device;
+    atomic_int parked;
+
+    int cpu;
+    int node;
+
+    struct thread_context* thread_context;
+} Worker;
 
 /**
  * @struct ThreadContext
  * 
  * @brief Type for the thread context.
  * 
- * Contains an array of coordinators, and a mutex lock and condition.
+ * Contains the options, an array of coordinators, the workers and the 
+ * counters used to detect when all work is done. `pending_jobs` counts the jobs that are 
+ * created but not yet finished, the traversal is done when it reaches zero. 
+ * `queued_jobs` counts the jobs that are waiting to be picked up. Idle 
+ * workers sleep on `cond_work`, they are only woken when work is pushed 
+ * while `idle_threads` is non-zero or when the traversal is done. Only the 
+ * workers below `thread_limit` look for work, the `parked_threads` above 
+ * it sleep until the limit is raised. 
+ * `open_handles` counts the directory's held open for their children, it is 
+ * kept below `max_open_handles` so the file descriptor limit is not reached.
+ * `inodes` holds the hard linked files already counted, it is NULL unless 
+ * the links are deduplicated. `breakdown` receives the totals of the 
+ * directory's, it is NULL unless every directory is reported. `cache` is 
+ * the scan cache or NULL, `binary` is the writer of the binary output or 
+ * NULL. If `track_subtrees` is set, each job collects the 
+ * usage of its sub tree, which both of them need. `errors` holds the error 
+ * messages of the main thread from before the workers are created. 
+ * `devices` limits the workers on each device, it is NULL if there are no 
+ * limits. `topology` places the workers on the cpus, it is NULL unless 
+ * they are pinned. `exclude` holds the patterns of the entry's to skip, it 
+ * is NULL if there are none. `histograms` receives the merged histogram of 
+ * each coordinator, the ages are counted from `histogram_time`. It is NULL 
+ * unless the histograms are counted. `prefetcher` opens the pushed 
+ * directory's ahead of the workers, it is NULL unless they are prefetched. 
+ * 
+ * `embedded` is set when the scan is run by the library. Its errors are 
+ * then counted and handed to `error_callback`, if any, instead of being 
+ * buffered, and a worker above `thread_limit` returns instead of parking. If 
+ * `directory_callback` is set, it receives the total of every directory 
+ * as the breakdown does. Both callbacks are called by the workers with 
+ * `callback_data`, from several threads at once. `aborted` is set by the 
+ * first error under `ERRORS_ABORT`, and by a failed allocation of an 
+ * embedded worker, which also sets `out_of_memory`. 
+ * The counters written by the workers are kept on cache 
+ * lines of their own, apart from the fields that are only read.
 */
-typedef struct {
+typedef struct thread_context {
+    Options options;
+
     Coordinator** coordinator;
 
-    pthread_mutex_t mutex_error;
-    pthread_mutex_t mutex_work;
+    Worker** workers;
+    int worker_num;
+
+    alignas(CACHE_LINE_SIZE) atomic_long pending_jobs;
+    atomic_long queued_jobs;
+    atomic_int idle_threads;
+    atomic_int thread_limit;
+    atomic_int parked_threads;
+
+    alignas(CACHE_LINE_SIZE) atomic_int open_handles;
+    int max_open_handles;
+
+    InodeSet* inodes;
+    Breakdown* breakdown;
+    ScanCache* cache;
+    BinaryWriter* binary;
+    bool track_subtrees;
+
+    ErrorBuffer errors;
+    DeviceTable* devices;
+    Topology* topology;
+    Exclude* exclude;
+    Histogram* histograms;
+    time_t histogram_time;
+    struct prefetcher* prefetcher;
+
+    bool embedded;
+    atomic_bool aborted;
+    atomic_bool out_of_memory;
+    DirectoryCallback directory_callback;
+    ErrorCallback error_callback;
+    void* callback_data;
+
+    alignas(CACHE_LINE_SIZE) pthread_mutex_t mutex_work;
     pthread_cond_t cond_work;
 
     int dir_num;
@@ -88,45 +267,176 @@ ThreadContext* create_thread_context(void);
 /**
  * @brief Creates a new coordinator object in an array of coordinators.
  * 
+ * The array is doubled when it is full. `dir_num` must already count the 
+ * new coordinator.
+ * 
  * @param thread_context A pointer to the thread_context storing 
  * the coordinators.
- * @param dir_num Number of coordinators in the array.
+ * @param path The path of the directory tree. It is copied with its 
+ * trailing slashes cut down to one, as `du` prints it.
  *
  * @note The returned object must be freed using the `thread_context_destroy` function
  *       when it is no longer needed to prevent memory leaks.
  * @see thread_context_destroy()
 */
-void expand_and_create_coordinator(ThreadContext* thread_context);
+void expand_and_create_coordinator(ThreadContext* thread_context, 
+                                    const char* path);
 
 /**
- * @brief Increments the counter plus one.
+ * @brief Creates the workers of the thread context.
  * 
- * @param counter Pointer to the counter.
+ * @param thread_context A pointer to the thread_context storing 
+ * the workers.
+ * @param worker_num Number of workers to create.
+ *
+ * @note Must be called after all coordinators are created.
+ * @note The workers are freed by the `thread_context_destroy` function.
+ * @see thread_context_destroy()
 */
-void increment_counter(Counter* counter);
+void create_workers(ThreadContext* thread_context, int worker_num);
 
 /**
- * @brief Decrements the counter minus one.
+ * @brief Reallocates the memory only a worker uses from the calling thread.
+ * 
+ * The memory is placed on the node of the thread that first touches it, 
+ * so a worker pinned to a node calls this before it takes any job. The 
+ * deque and the counters are kept, since other threads may read them.
  * 
- * @param counter Pointer to the counter.
+ * @param worker A pointer to the worker run by the calling thread.
 */
-void decrement_counter(Counter* counter);
+void worker_localize(Worker* worker);
 
 /**
- * @brief Returns the value of the counter.
+ * @brief Adds the usage of a file, given by its stat struct, to `usage`.
  * 
- * @param counter Pointer to the counter.
- * @return Returns the value of the counter.
+ * @param usage Pointer to the usage.
+ * @param file_info The stat struct of the file.
 */
-int get_counter_value(Counter* counter);
+void usage_add_file(Usage* usage, const struct stat* file_info);
 
 /**
- * @brief Updates the total sum stored in the coordinator.
+ * @brief Returns the value of `usage` that the user asked to be reported.
  * 
- * @param value The value to add to the total sum.
+ * @param usage Pointer to the usage.
+ * @param options Pointer to the options.
+ * @return Returns the number of blocks, the apparent size in blocks or the 
+ * number of inodes.
+*/
+uint64_t usage_reported_value(const Usage* usage, const Options* options);
+
+/**
+ * @brief Adds the usage `value` to `usage`.
+ * 
+ * @param usage Pointer to the usage.
+ * @param value Pointer to the usage to add.
+*/
+void usage_add(Usage* usage, const Usage* value);
+
+/**
+ * @brief Updates the total usage stored in the coordinator.
+ * 
+ * @param value The usage to add to the total usage.
  * @param coordinator Pointer to the coordinator.
+ * 
+ * @note Not thread safe, the workers use `update_worker_sum()`.
+*/
+void update_total_sum(const Usage* value, Coordinator* coordinator);
+
+/**
+ * @brief Updates the usage counted by a worker for the tree of a coordinator.
+ * 
+ * @param value The usage to add.
+ * @param worker Pointer to the worker.
+ * @param root The index of the coordinator.
+*/
+void update_worker_sum(const Usage* value, Worker* worker, int root);
+
+/**
+ * @brief Adds the usage of all workers to the total usage of the coordinators.
+ * 
+ * @param thread_context A pointer to the thread_context.
+ * 
+ * @note Must only be called once, after all workers are done.
+*/
+void reduce_total_sums(ThreadContext* thread_context);
+
+/**
+ * @brief Adds the histograms of the workers to the histograms of the 
+ * coordinators.
+ * 
+ * @param thread_context A pointer to the thread context.
+ * 
+ * @note Must only be called once, after all workers are done.
+*/
+void reduce_histograms(ThreadContext* thread_context);
+
+/**
+ * @brief Checks if the total of every directory is reported.
+ * 
+ * @param thread_context A pointer to the thread_context.
+ * @return Returns true if there is a breakdown or a directory callback; 
+ * else false.
+*/
+bool reports_directories(const ThreadContext* thread_context);
+
+/**
+ * @brief Reports an error of a thread.
+ * 
+ * The message is added to the error buffer of the thread, no lock is taken. 
+ * An embedded scan hands the message to its error callback instead. With 
+ * the policy `ERRORS_ABORT`, the scan is marked as aborted, the workers 
+ * then release the remaining jobs without reading them.
+ * 
+ * @param thread_context A pointer to the thread_context.
+ * @param errors The error buffer of the reporting thread.
+ * @param format The printf format of the message.
+*/
+void report_error(ThreadContext* thread_context, ErrorBuffer* errors, 
+                    const char* format, ...) 
+                    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Reports a message that is not an error of a file.
+ * 
+ * The message is printed to stderr at once, an embedded scan hands it to 
+ * its error callback instead. It is not counted as an error, the caller 
+ * fails the scan itself.
+ * 
+ * @param thread_context A pointer to the thread_context.
+ * @param format The printf format of the message.
+*/
+void report_message(ThreadContext* thread_context, const char* format, ...) 
+                    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Writes the error messages of all threads to stderr.
+ * 
+ * @param thread_context A pointer to the thread_context.
+ * 
+ * @note Must only be called when no worker is running.
+*/
+void flush_errors(ThreadContext* thread_context);
+
+/**
+ * @brief Returns the number of errors reported by all threads.
+ * 
+ * @param thread_context A pointer to the thread_context.
+ * @return Returns the number of errors.
+ * 
+ * @note Must only be called when no worker is running.
+*/
+long error_count(ThreadContext* thread_context);
+
+/**
+ * @brief Sums the counters of all workers.
+ * 
+ * May be called while the workers are running, the sums are then 
+ * approximate.
+ * 
+ * @param thread_context A pointer to the thread_context.
+ * @param totals Set to the sums.
 */
-void update_total_sum(int value, Coordinator* coordinator);
+void collect_stats(ThreadContext* thread_context, StatsTotals* totals);
 
 /**
  * @brief Deallocates the ThreadContext object.
@@ -0,0 +1,182 @@
+/*
+ * @brief This module implements the datatype Topology.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "topology.h"
+#include "thread_context.h"
+#include "safe_functions.h"
+
+#define TOPOLOGY_MAX_NODES 1024
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Reads the cpus of a node from its `cpulist`, such as `0-3,8-11`.
+ *
+ * @param node The number of the node.
+ * @param cpus The set the cpus are added to.
+ * @return Returns true if the node exists; else false.
+*/
+static bool read_node_cpus(int node, cpu_set_t* cpus) {
+    char path[64];
+    int first, last;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", 
+                node);
+    FILE* file = fopen(path, "r");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    CPU_ZERO(cpus);
+
+    while (fscanf(file, "%d", &first) == 1) {
+        last = first;
+
+        if (fscanf(file, "-%d", &last) != 1) {
+            last = first;
+        }
+
+        for (int cpu = first ; cpu <= last && cpu < CPU_SETSIZE ; cpu++) {
+            CPU_SET(cpu, cpus);
+        }
+
+        if (fgetc(file) != ',') {
+            break;
+        }
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+/*
+ * @brief Adds the allowed cpus of a node to the topology.
+ *
+ * @param topology Pointer to the topology.
+ * @param node The number of the node.
+ * @param node_cpus The cpus of the node.
+ * @param allowed The cpus the program may run on, the added cpus are 
+ * removed from it.
+*/
+static void add_node(Topology* topology, int node, const cpu_set_t* node_cpus, 
+                        cpu_set_t* allowed) {
+    int start = topology->cpu_num;
+
+    for (int cpu = 0 ; cpu < CPU_SETSIZE ; cpu++) {
+        if (CPU_ISSET(cpu, node_cpus) && CPU_ISSET(cpu, allowed)) {
+            topology->cpus[topology->cpu_num] = cpu;
+            topology->nodes[topology->cpu_num] = node;
+            topology->cpu_num++;
+            CPU_CLR(cpu, allowed);
+        }
+    }
+
+    if (topology->cpu_num > start) {
+        topology->node_start[topology->node_num++] = start;
+    }
+}
+
+/*
+ * @brief Returns the number of cpus of the `index`th node of the topology.
+ *
+ * @param topology Pointer to the topology.
+ * @param index The index of the node.
+ * @return Returns the number of cpus.
+*/
+static int node_size(const Topology* topology, int index) {
+    int end = index + 1 < topology->node_num ? 
+                topology->node_start[index + 1] : topology->cpu_num;
+
+    return end - topology->node_start[index];
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Topology* topology_create(void* in_use_data) {
+    cpu_set_t allowed, node_cpus;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+        return NULL;
+    }
+
+    int count = CPU_COUNT(&allowed);
+    Topology* topology = safe_malloc(sizeof(Topology), in_use_data);
+
+    topology->cpus = safe_malloc(count * sizeof(int), in_use_data);
+    topology->nodes = safe_malloc(count * sizeof(int), in_use_data);
+    topology->node_start = safe_malloc(count * sizeof(int), in_use_data);
+    topology->cpu_num = 0;
+    topology->node_num = 0;
+
+    for (int node = 0 ; node < TOPOLOGY_MAX_NODES && 
+            topology->cpu_num < count ; node++) {
+        if (read_node_cpus(node, &node_cpus)) {
+            add_node(topology, node, &node_cpus, &allowed);
+        }
+    }
+
+    /* The cpus of no known node, or every cpu without NUMA, form node 0. */
+    if (topology->cpu_num < count) {
+        add_node(topology, 0, &allowed, &allowed);
+    }
+
+    return topology;
+}
+
+
+void topology_destroy(Topology* topology) {
+    if (topology == NULL) {
+        return;
+    }
+
+    free(topology->cpus);
+    free(topology->nodes);
+    free(topology->node_start);
+    free(topology);
+}
+
+
+void topology_assign(const Topology* topology, struct worker* worker, 
+                        bool spread) {
+    int index = worker->id % topology->cpu_num;
+
+    if (spread) {
+        int node = worker->id % topology->node_num;
+        int offset = worker->id / topology->node_num % node_size(topology, node);
+
+        index = topology->node_start[node] + offset;
+    }
+
+    worker->cpu = topology->cpus[index];
+    worker->node = topology->nodes[index];
+}
+
+
+bool topology_bind(const Topology* topology, const struct worker* worker, 
+                    bool whole_node) {
+    cpu_set_t cpus;
+
+    CPU_ZERO(&cpus);
+
+    for (int i = 0 ; i < topology->cpu_num ; i++) {
+        if (topology->cpus[i] == worker->cpu || 
+                (whole_node && topology->nodes[i] == worker->node)) {
+            CPU_SET(topology->cpus[i], &cpus);
+        }
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
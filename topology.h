@@ -0,0 +1,90 @@
+/**
+ * @defgroup module_topology Topology
+ *
+ * @file topology.h
+ * @brief This module implements the datatype Topology.
+ *
+ * A topology lists the cpus the program may run on, grouped by the NUMA 
+ * node they belong to, and places the workers on them. The nodes are read 
+ * from `/sys/devices/system/node`, a system without it is one node.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+struct worker;
+
+/**
+ * @brief The type for the topology.
+ *
+ * `cpus` holds the `cpu_num` allowed cpus sorted by node, `nodes` the node 
+ * of each of them. The cpus of node `i` start at `node_start[i]`, there 
+ * are `node_num` nodes with at least one allowed cpu.
+*/
+typedef struct {
+    int* cpus;
+    int* nodes;
+    int cpu_num;
+
+    int* node_start;
+    int node_num;
+} Topology;
+
+/**
+ * @brief Reads the topology of the system.
+ *
+ * @param in_use_data A pointer to data that should be destroyed if
+ * memory allocation fails.
+ * @return Returns the topology; else NULL if the allowed cpus cannot be 
+ * read.
+ *
+ * @note It is the caller's responsible to deallocate the topology after 
+ * use by calling the function `topology_destroy()`.
+*/
+Topology* topology_create(void* in_use_data);
+
+/**
+ * @brief Destroy the topology.
+ *
+ * @param topology A pointer to the topology, may be NULL.
+*/
+void topology_destroy(Topology* topology);
+
+/**
+ * @brief Assigns a cpu and a node to a worker.
+ *
+ * If `spread` is set, the workers are spread over the nodes in turn; else 
+ * each node is filled before the next one is used.
+ *
+ * @param topology A pointer to the topology.
+ * @param worker A pointer to the worker.
+ * @param spread If the workers should be spread over the nodes.
+*/
+void topology_assign(const Topology* topology, struct worker* worker, 
+                        bool spread);
+
+/**
+ * @brief Pins the calling thread to the cpu of a worker, or to every cpu 
+ * of its node.
+ *
+ * @param topology A pointer to the topology.
+ * @param worker A pointer to the worker run by the calling thread.
+ * @param whole_node If the thread may run on any cpu of the node.
+ * @return Returns true if the thread is pinned; else false.
+*/
+bool topology_bind(const Topology* topology, const struct worker* worker, 
+                    bool whole_node);
+
+#endif /* TOPOLOGY_H */
+
+/**
+ * }
+*/
@@ -0,0 +1,315 @@
+/*
+ * @brief This module implements a minimal io_uring used to batch stat and 
+ * open calls.
+ *
+ * The submission and completion rings are shared with the kernel. The tail
+ * of the submission ring and the head of the completion ring are written by
+ * this module, the other indices are written by the kernel.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <linux/io_uring.h>
+
+#include "uring.h"
+
+struct uring {
+    int fd;
+    unsigned entries;
+
+    void* sq_ptr;
+    size_t sq_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+
+    void* cq_ptr;
+    size_t cq_size;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+
+    struct statx* statx_buffers;
+};
+
+/*-----------------------INTERNAL FUCTIONS-----------------------*/
+
+/*
+ * @brief Maps the rings shared with the kernel.
+ *
+ * @param ring A pointer to the ring.
+ * @param params The parameters returned by `io_uring_setup`.
+ * @return Returns true on success; else false.
+*/
+static bool map_rings(Uring* ring, struct io_uring_params* params) {
+    ring->sq_size = params->sq_off.array + params->sq_entries * sizeof(unsigned);
+    ring->cq_size = params->cq_off.cqes + 
+                    params->cq_entries * sizeof(struct io_uring_cqe);
+
+    if (params->features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_size > ring->sq_size) {
+            ring->sq_size = ring->cq_size;
+        }
+        ring->cq_size = ring->sq_size;
+    }
+
+    ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE, 
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        return false;
+    }
+
+    if (params->features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ptr = ring->sq_ptr;
+
+    } else {
+        ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE, 
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) {
+            munmap(ring->sq_ptr, ring->sq_size);
+            return false;
+        }
+    }
+
+    ring->sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, 
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_ptr != ring->sq_ptr) {
+            munmap(ring->cq_ptr, ring->cq_size);
+        }
+        munmap(ring->sq_ptr, ring->sq_size);
+        return false;
+    }
+
+    char* sq = ring->sq_ptr;
+    ring->sq_head = (unsigned*) (sq + params->sq_off.head);
+    ring->sq_tail = (unsigned*) (sq + params->sq_off.tail);
+    ring->sq_mask = (unsigned*) (sq + params->sq_off.ring_mask);
+    ring->sq_array = (unsigned*) (sq + params->sq_off.array);
+
+    char* cq = ring->cq_ptr;
+    ring->cq_head = (unsigned*) (cq + params->cq_off.head);
+    ring->cq_tail = (unsigned*) (cq + params->cq_off.tail);
+    ring->cq_mask = (unsigned*) (cq + params->cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*) (cq + params->cq_off.cqes);
+
+    return true;
+}
+
+/*
+ * @brief Copies the fields used by the program from a statx struct.
+ *
+ * @param in The statx struct.
+ * @param out The stat struct.
+*/
+static void statx_to_stat(const struct statx* in, struct stat* out) {
+    memset(out, 0, sizeof(struct stat));
+
+    out->st_mode = in->stx_mode;
+    out->st_nlink = in->stx_nlink;
+    out->st_ino = in->stx_ino;
+    out->st_dev = makedev(in->stx_dev_major, in->stx_dev_minor);
+    out->st_size = in->stx_size;
+    out->st_blocks = in->stx_blocks;
+    out->st_mtim.tv_sec = in->stx_mtime.tv_sec;
+    out->st_mtim.tv_nsec = in->stx_mtime.tv_nsec;
+    out->st_ctim.tv_sec = in->stx_ctime.tv_sec;
+    out->st_ctim.tv_nsec = in->stx_ctime.tv_nsec;
+}
+
+/*
+ * @brief Queues a statx request in the submission ring.
+ *
+ * @param ring A pointer to the ring.
+ * @param dir_fd File descriptor of the directory containing the file.
+ * @param name The name of the file.
+ * @param index The index of the request, returned with its completion.
+*/
+static void queue_statx(Uring* ring, int dir_fd, const char* name, int index) {
+    unsigned tail = *ring->sq_tail;
+    unsigned slot = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[slot];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_STATX;
+    sqe->fd = dir_fd;
+    sqe->addr = (unsigned long) name;
+    sqe->len = STATX_BASIC_STATS;
+    sqe->off = (unsigned long) &ring->statx_buffers[index];
+    sqe->statx_flags = AT_SYMLINK_NOFOLLOW | AT_STATX_SYNC_AS_STAT;
+    sqe->user_data = index;
+
+    ring->sq_array[slot] = slot;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * @brief Queues an openat request in the submission ring.
+ *
+ * @param ring A pointer to the ring.
+ * @param dir_fd File descriptor of the directory containing the file.
+ * @param name The name of the file.
+ * @param flags The flags of `openat`.
+ * @param index The index of the request, returned with its completion.
+*/
+static void queue_openat(Uring* ring, int dir_fd, const char* name, int flags,
+                            int index) {
+    unsigned tail = *ring->sq_tail;
+    unsigned slot = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[slot];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = dir_fd;
+    sqe->addr = (unsigned long) name;
+    sqe->open_flags = flags;
+    sqe->user_data = index;
+
+    ring->sq_array[slot] = slot;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * @brief Submits the queued requests and waits for all of their completions.
+ *
+ * @param ring A pointer to the ring.
+ * @param count The number of queued requests.
+ * @param results The result of each request, by its index.
+ * @return Returns true on success; else false if the ring failed.
+*/
+static bool run_batch(Uring* ring, int count, int* results) {
+    int submitted = 0;
+    int completed = 0;
+
+    while (completed < count) {
+        int ret = syscall(__NR_io_uring_enter, ring->fd, count - submitted, 
+                            1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        submitted += ret;
+
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+        while (head != tail) {
+            struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+
+            results[cqe->user_data] = cqe->res;
+            head++;
+            completed++;
+        }
+
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    return true;
+}
+
+/*-----------------------EXTERNAL FUCTIONS-----------------------*/
+
+Uring* uring_create(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    Uring* ring = calloc(1, sizeof(Uring));
+    if (ring == NULL) {
+        close(fd);
+        return NULL;
+    }
+
+    ring->fd = fd;
+    ring->entries = params.sq_entries;
+    ring->statx_buffers = calloc(ring->entries, sizeof(struct statx));
+
+    if (ring->statx_buffers == NULL || !map_rings(ring, &params)) {
+        free(ring->statx_buffers);
+        free(ring);
+        close(fd);
+        return NULL;
+    }
+
+    return ring;
+}
+
+
+void uring_destroy(Uring* ring) {
+    if (ring == NULL) {
+        return;
+    }
+
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ptr != ring->sq_ptr) {
+        munmap(ring->cq_ptr, ring->cq_size);
+    }
+    munmap(ring->sq_ptr, ring->sq_size);
+
+    close(ring->fd);
+    free(ring->statx_buffers);
+    free(ring);
+}
+
+
+bool uring_statx_batch(Uring* ring, int dir_fd, const char** names, int count,
+                        struct stat* results, int* errors) {
+    if (count > (int) ring->entries) {
+        return false;
+    }
+
+    for (int i = 0 ; i < count ; i++) {
+        queue_statx(ring, dir_fd, names[i], i);
+    }
+
+    if (!run_batch(ring, count, errors)) {
+        return false;
+    }
+
+    for (int i = 0 ; i < count ; i++) {
+        if (errors[i] < 0) {
+            errors[i] = -errors[i];
+
+        } else {
+            errors[i] = 0;
+            statx_to_stat(&ring->statx_buffers[i], &results[i]);
+        }
+    }
+
+    return true;
+}
+
+
+bool uring_openat_batch(Uring* ring, const int* dir_fds, const char** names, 
+                        int count, int flags, int* results) {
+    if (count > (int) ring->entries) {
+        return false;
+    }
+
+    for (int i = 0 ; i < count ; i++) {
+        queue_openat(ring, dir_fds[i], names[i], flags, i);
+    }
+
+    return run_batch(ring, count, results);
+}
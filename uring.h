@@ -0,0 +1,91 @@
+/**
+ * @defgroup module_uring Uring
+ *
+ * @file uring.h
+ * @brief This module implements a minimal io_uring used to batch stat and 
+ * open calls.
+ *
+ * The ring is set up with the raw io_uring system calls, so no library is
+ * needed. A ring is owned by one thread and must not be shared.
+ *
+ * @author Daniel Hylander
+ * @date 2026-10-14
+ *
+ * @{
+ */
+
+#ifndef URING_H
+#define URING_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+/**
+ * @brief The type for the ring, the fields are private to the module.
+*/
+typedef struct uring Uring;
+
+/**
+ * @brief Creates a ring that can hold `entries` requests at once.
+ *
+ * @param entries The number of requests, a power of two.
+ * @return Returns the newly created ring; else NULL if io_uring is not
+ * supported by the kernel.
+ *
+ * @note It is the caller's responsible to deallocate the ring after use
+ * by calling the function `uring_destroy()`.
+ * @see uring_destroy()
+*/
+Uring* uring_create(unsigned entries);
+
+/**
+ * @brief Destroy the ring.
+ *
+ * @param ring A pointer to the ring, may be NULL.
+*/
+void uring_destroy(Uring* ring);
+
+/**
+ * @brief Stats the files `names` relative to the directory `dir_fd`.
+ *
+ * All stats are submitted as `IORING_OP_STATX` requests at once and the
+ * function waits for all completions. Symbolic links are not followed.
+ *
+ * @param ring A pointer to the ring.
+ * @param dir_fd File descriptor of the directory containing the files.
+ * @param names The names of the files.
+ * @param count The number of names, at most the size of the ring.
+ * @param results The stat structs of the files.
+ * @param errors Set to zero on success; else the errno of the failed stat.
+ * @return Returns true on success; else false if the ring failed, the
+ * results are then undefined.
+*/
+bool uring_statx_batch(Uring* ring, int dir_fd, const char** names, int count,
+                        struct stat* results, int* errors);
+
+/**
+ * @brief Opens the files `names`, each relative to its directory in 
+ * `dir_fds`.
+ *
+ * All opens are submitted as `IORING_OP_OPENAT` requests at once and the
+ * function waits for all completions.
+ *
+ * @param ring A pointer to the ring.
+ * @param dir_fds File descriptors of the directory's containing the files.
+ * @param names The names of the files.
+ * @param count The number of names, at most the size of the ring.
+ * @param flags The flags of `openat`.
+ * @param results The file descriptor of each file; else the negative errno 
+ * of the failed open.
+ * @return Returns true on success; else false if the ring failed, the
+ * results are then undefined.
+*/
+bool uring_openat_batch(Uring* ring, const int* dir_fds, const char** names, 
+                        int count, int flags, int* results);
+
+#endif /* URING_H */
+
+/**
+ * }
+*/